@@ -0,0 +1,108 @@
+#
+# $Id$
+#
+# Copyright 2026 Quantcast Corporation. All rights reserved.
+#
+# This file is part of Kosmos File System (KFS).
+#
+# Licensed under the Apache License, Version 2.0
+# (the "License"); you may not use this file except in compliance with
+# the License. You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+# implied. See the License for the specific language governing
+# permissions and limitations under the License.
+
+"""
+Python QFS read throughput benchmark.
+
+Creates a test file, unless it already exists, then reads it with the
+specified number of threads. Each thread opens the file and issues positional
+reads of the specified size at random block aligned offsets, similarly to a
+training data loader. The test is run twice: with read() that returns a new
+string, and with readinto() into pre-allocated bytearray.
+
+To run this script,
+  - Prepare qfs.so as described in the file 'wiki/Developer-Documentation.md'
+  - Ensure that the QFS metaserver and chunkserver are running.
+  - Ensure that the PYTHONPATH and LD_LIBRARY_PATH are set accordingly.
+  eg: python ./qfs_read_bench.py localhost 20000 /bench/file 8 1048576 10
+"""
+
+import random
+import sys
+import threading
+import time
+
+import qfs
+
+def CreateFile(client, path, size, blockSize):
+    if client.isfile(path) and client.stat(path)[6] >= size:
+        return
+    f = client.create(path)
+    buf = bytearray(blockSize)
+    for i in xrange(blockSize):
+        buf[i] = i & 0xFF
+    written = 0
+    while written < size:
+        n = min(blockSize, size - written)
+        f.write(memoryview(buf)[:n])
+        written += n
+    f.close()
+
+def Reader(client, path, fileSize, blockSize, deadline, useReadInto, result):
+    f = client.open(path, 'r')
+    blocks = max(1, fileSize / blockSize)
+    buf = bytearray(blockSize)
+    total = 0
+    while time.time() < deadline:
+        off = random.randrange(blocks) * blockSize
+        if useReadInto:
+            total += f.readinto(buf, off)
+        else:
+            f.seek(off)
+            total += len(f.read(blockSize))
+    f.close()
+    result.append(total)
+
+def Run(client, path, fileSize, threadCount, blockSize, seconds, useReadInto):
+    result = []
+    deadline = time.time() + seconds
+    threads = [threading.Thread(target=Reader,
+        args=(client, path, fileSize, blockSize, deadline, useReadInto, result))
+        for i in xrange(threadCount)]
+    start = time.time()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    elapsed = time.time() - start
+    total = sum(result)
+    print "%-8s threads: %d block: %d bytes: %d MB/sec: %.1f" % (
+        useReadInto and "readinto" or "read", threadCount, blockSize, total,
+        elapsed > 0 and total / elapsed / (1 << 20) or 0.)
+
+def main():
+    if len(sys.argv) < 4:
+        sys.exit('Usage: %s host port path [threads] [block size] [seconds]'
+            ' [file size]' % sys.argv[0])
+    host = sys.argv[1]
+    port = int(sys.argv[2])
+    path = sys.argv[3]
+    threadCount = len(sys.argv) > 4 and int(sys.argv[4]) or 8
+    blockSize = len(sys.argv) > 5 and int(sys.argv[5]) or (1 << 20)
+    seconds = len(sys.argv) > 6 and int(sys.argv[6]) or 10
+    fileSize = len(sys.argv) > 7 and int(sys.argv[7]) or (256 << 20)
+
+    client = qfs.client((host, port))
+    CreateFile(client, path, fileSize, blockSize)
+    fileSize = client.stat(path)[6]
+    Run(client, path, fileSize, threadCount, blockSize, seconds, False)
+    Run(client, path, fileSize, threadCount, blockSize, seconds, True)
+
+if __name__ == '__main__':
+    main()
@@ -69,6 +69,7 @@ static PyObject *qfs_rmdir(PyObject *pself, PyObject *args);
 static PyObject *qfs_rmdirs(PyObject *pself, PyObject *args);
 static PyObject *qfs_readdir(PyObject *pself, PyObject *args);
 static PyObject *qfs_readdirplus(PyObject *pself, PyObject *args);
+static PyObject *qfs_readdirplus_iter(PyObject *pself, PyObject *args);
 static PyObject *qfs_create(PyObject *pself, PyObject *args);
 static PyObject *qfs_stat(PyObject *pself, PyObject *args);
 static PyObject *qfs_fullstat(PyObject *pself, PyObject *args);
@@ -81,6 +82,15 @@ static PyObject *qfs_open(PyObject *pself, PyObject *args);
 static PyObject *qfs_cd(PyObject *pself, PyObject *args);
 static PyObject *qfs_log_level(PyObject *pself, PyObject *args);
 
+/*
+ * The client calls below can block on network io, and the client instance
+ * lock can be held by other threads for the duration of meta and chunk server
+ * round trips. Release the interpreter lock around all client calls in order
+ * to let multi threaded python applications run concurrently with io. The
+ * client is thread safe; python objects must not be accessed with the
+ * interpreter lock released, therefore all arguments are converted in
+ * advance.
+ */
 inline static void SetPyIoError(int64_t err)
 {
     const string s = ErrorCodeToStr((int)err);
@@ -102,6 +112,7 @@ static PyMethodDef Client_methods[] = {
     { "rmdirs",           qfs_rmdirs,         METH_VARARGS, "Remove directory tree."},
     { "readdir",          qfs_readdir,        METH_VARARGS, "Read directory." },
     { "readdirplus",      qfs_readdirplus,    METH_VARARGS, "Read directory with attributes." },
+    { "readdirplus_iter", qfs_readdirplus_iter, METH_VARARGS, "Iterate over directory entries with attributes." },
     { "stat",             qfs_stat,           METH_VARARGS, "Stat file." },
     { "fullstat",         qfs_fullstat,       METH_VARARGS, "Stat file for QFS attributes." },
     { "getNumChunks",     qfs_getNumChunks,   METH_VARARGS, "Get # of chunks in a file." },
@@ -132,6 +143,8 @@ PyDoc_STRVAR(Client_doc,
 "\trmdirs(path) -- remove a directory tree\n"
 "\treaddir(path) -- return a tuple of directory contents\n"
 "\treaddirplus(path) -- directory entries plus attributes\n"
+"\treaddirplus_iter(path) -- iterator over directory entries plus attributes;\n"
+"\t\tthe directory is read in full, only tuple creation is deferred\n"
 "\tisdir(path) -- return TRUE if path is a directory\n"
 "\tisfile(path) -- return TRUE if path is a file\n"
 "\tstat(path)   --  file attributes, compatible with os.stat\n"
@@ -226,8 +239,13 @@ File_dealloc(PyObject *pself)
 {
     qfs_File *self = (qfs_File *)pself;
     qfs_Client *cl = (qfs_Client *)self->pclient;
-    if (self->fd != -1)
-        cl->client->Close(self->fd);
+    if (self->fd != -1) {
+        KfsClient *client = cl->client;
+        int fd = self->fd;
+        Py_BEGIN_ALLOW_THREADS
+        client->Close(fd);
+        Py_END_ALLOW_THREADS
+    }
     Py_DECREF(self->name);
     Py_DECREF(self->mode);
     Py_DECREF(self->pclient);
@@ -241,7 +259,7 @@ modeflag(const char *modestr)
     int mode = -1;
 
     if (strcmp(modestr, "r") == 0)
-        mode = O_RDWR;
+        mode = O_RDONLY;
     else if (strcmp(modestr, "w") == 0)
         mode = O_WRONLY;
     else if (strcmp(modestr, "r+") == 0 || strcmp(modestr, "w+") == 0)
@@ -265,8 +283,12 @@ set_file_members(
         return -1;
 
     // open the file if necessary
-    if (fd < 0)
-        fd = client->client->Open(path, mode);
+    if (fd < 0) {
+        KfsClient *kfsClient = client->client;
+        Py_BEGIN_ALLOW_THREADS
+        fd = kfsClient->Open(path, mode);
+        Py_END_ALLOW_THREADS
+    }
 
     if (fd < 0) {
         SetPyIoError(fd);
@@ -342,9 +364,16 @@ qfs_reopen(PyObject *pself, PyObject *args)
     if (mode == -1)
         return NULL;
 
-    int fd = cl->client->Open(PyString_AsString(self->name), mode);
-    if (fd == -1)
+    const char *name = PyString_AsString(self->name);
+    KfsClient *client = cl->client;
+    int fd;
+    Py_BEGIN_ALLOW_THREADS
+    fd = client->Open(name, mode);
+    Py_END_ALLOW_THREADS
+    if (fd < 0) {
+        SetPyIoError(fd);
         return NULL;
+    }
 
     self->fd = fd;
     self->mode = PyString_FromString(modestr);
@@ -357,8 +386,12 @@ qfs_close(PyObject *pself, PyObject *args)
     qfs_File *self = (qfs_File *)pself;
     qfs_Client *cl = (qfs_Client *)self->pclient;
     if (self->fd != -1) {
-        cl->client->Close(self->fd);
+        KfsClient *client = cl->client;
+        int fd = self->fd;
         self->fd = -1;
+        Py_BEGIN_ALLOW_THREADS
+        client->Close(fd);
+        Py_END_ALLOW_THREADS
     }
     Py_RETURN_NONE;
 }
@@ -383,7 +416,12 @@ qfs_read(PyObject *pself, PyObject *args)
         return NULL;
 
     char *buf = PyString_AsString(v);
-    ssize_t nr = cl->client->Read(self->fd, buf, rsize);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    ssize_t nr;
+    Py_BEGIN_ALLOW_THREADS
+    nr = client->Read(fd, buf, rsize);
+    Py_END_ALLOW_THREADS
     if (nr < 0) {
         Py_DECREF(v);
         SetPyIoError(nr);
@@ -394,31 +432,80 @@ qfs_read(PyObject *pself, PyObject *args)
     return v;
 }
 
+/*
+ * Read into a caller supplied writable buffer, such as bytearray, memoryview,
+ * or numpy array, without intermediate copy. With offset specified performs
+ * positional read, that does not change the current file position. Returns
+ * the number of bytes read.
+ */
+static PyObject *
+qfs_readinto(PyObject *pself, PyObject *args)
+{
+    qfs_File *self = (qfs_File *)pself;
+    qfs_Client *cl = (qfs_Client *)self->pclient;
+    Py_buffer pbuf;
+    PY_LONG_LONG off = -1;
+
+    if (!PyArg_ParseTuple(args, "w*|L", &pbuf, &off))
+        return NULL;
+
+    if (self->fd == -1) {
+        PyBuffer_Release(&pbuf);
+        SetPyIoError(-EBADF);
+        return NULL;
+    }
+
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    char *buf = (char *)pbuf.buf;
+    size_t len = (size_t)pbuf.len;
+    ssize_t nr;
+    Py_BEGIN_ALLOW_THREADS
+    nr = off < 0 ? client->Read(fd, buf, len) :
+        client->PRead(fd, (chunkOff_t)off, buf, len);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&pbuf);
+    if (nr < 0) {
+        SetPyIoError(nr);
+        return NULL;
+    }
+    return Py_BuildValue("n", (Py_ssize_t)nr);
+}
+
 static PyObject *
 qfs_write(PyObject *pself, PyObject *args)
 {
     qfs_File *self = (qfs_File *)pself;
     qfs_Client *cl = (qfs_Client *)self->pclient;
-    int wsize = -1;
-    char *buf = NULL;
+    Py_buffer pbuf;
 
-    if (!PyArg_ParseTuple(args, "s#", &buf, &wsize))
+    // Accept string and any object that supports buffer protocol.
+    if (!PyArg_ParseTuple(args, "s*", &pbuf))
         return NULL;
 
     if (self->fd == -1) {
-        SetPyIoError(EBADF);
+        PyBuffer_Release(&pbuf);
+        SetPyIoError(-EBADF);
         return NULL;
     }
 
-    ssize_t nw = cl->client->Write(self->fd, buf, (ssize_t)wsize);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    const char *buf = (const char *)pbuf.buf;
+    Py_ssize_t wsize = pbuf.len;
+    ssize_t nw;
+    Py_BEGIN_ALLOW_THREADS
+    nw = client->Write(fd, buf, (size_t)wsize);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&pbuf);
     if (nw < 0) {
         SetPyIoError(nw);
         return NULL;
     }
     if (nw != wsize) {
         PyObject *msg = PyString_FromFormat(
-            "requested write of %d bytes but %ld were written",
-            wsize, (long)nw);
+            "requested write of %ld bytes but %ld were written",
+            (long)wsize, (long)nw);
         return msg;
     }
     Py_RETURN_NONE;
@@ -441,7 +528,12 @@ qfs_chunkLocations(PyObject *pself, PyObject *args)
 
     vector<vector <string> > results;
 
-    int s = cl->client->GetDataLocation(self->fd, off, len, results);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    int s;
+    Py_BEGIN_ALLOW_THREADS
+    s = client->GetDataLocation(fd, off, len, results);
+    Py_END_ALLOW_THREADS
     if (s < 0) {
         SetPyIoError(s);
         return NULL;
@@ -476,7 +568,12 @@ qfs_dataVerify(PyObject *pself, PyObject *args)
         return NULL;
     }
 
-    bool res = cl->client->VerifyDataChecksums(self->fd);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    bool res;
+    Py_BEGIN_ALLOW_THREADS
+    res = client->VerifyDataChecksums(fd);
+    Py_END_ALLOW_THREADS
     return Py_BuildValue("b", res);
 }
 
@@ -495,7 +592,12 @@ qfs_truncate(PyObject *pself, PyObject *args)
         return NULL;
     }
 
-    int s = cl->client->Truncate(self->fd, off);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    int s;
+    Py_BEGIN_ALLOW_THREADS
+    s = client->Truncate(fd, off);
+    Py_END_ALLOW_THREADS
     if (s < 0) {
         SetPyIoError(s);
         return NULL;
@@ -509,7 +611,12 @@ qfs_sync(PyObject *pself, PyObject *args)
 {
     qfs_File *self = (qfs_File *)pself;
     qfs_Client *cl = (qfs_Client *)self->pclient;
-    int s = cl->client->Sync(self->fd);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    int s;
+    Py_BEGIN_ALLOW_THREADS
+    s = client->Sync(fd);
+    Py_END_ALLOW_THREADS
     if (s < 0) {
         SetPyIoError(s);
         return NULL;
@@ -533,7 +640,12 @@ qfs_seek(PyObject *pself, PyObject *args)
         return NULL;
     }
 
-    off_t s = cl->client->Seek(self->fd, off, whence);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    off_t s;
+    Py_BEGIN_ALLOW_THREADS
+    s = client->Seek(fd, off, whence);
+    Py_END_ALLOW_THREADS
     if (s < 0) {
         SetPyIoError(s);
         return NULL;
@@ -552,7 +664,12 @@ qfs_tell(PyObject *pself, PyObject *args)
         return NULL;
     }
 
-    off_t pos = (off_t)cl->client->Tell(self->fd);
+    KfsClient *client = cl->client;
+    int fd = self->fd;
+    off_t pos;
+    Py_BEGIN_ALLOW_THREADS
+    pos = (off_t)client->Tell(fd);
+    Py_END_ALLOW_THREADS
     if (pos < 0) {
         SetPyIoError(pos);
         return NULL;
@@ -564,6 +681,7 @@ static PyMethodDef File_methods[] = {
     { "open",             qfs_reopen,         METH_VARARGS, "Open a closed file." },
     { "close",            qfs_close,          METH_NOARGS,  "Close file." },
     { "read",             qfs_read,           METH_VARARGS, "Read from file." },
+    { "readinto",         qfs_readinto,       METH_VARARGS, "Read from file into buffer." },
     { "write",            qfs_write,          METH_VARARGS, "Write to file." },
     { "truncate",         qfs_truncate,       METH_VARARGS, "Truncate a file." },
     { "chunk_locations",  qfs_chunkLocations, METH_VARARGS, "Get location(s) of a chunk." },
@@ -591,7 +709,10 @@ PyDoc_STRVAR(File_doc,
 "\topen([mode]) -- reopen closed file\n"
 "\tclose()     -- close file\n"
 "\tread(len)   -- read len bytes, return as string\n"
-"\twrite(str)  -- write string to file\n"
+"\treadinto(buf[, off]) -- read into writable buffer, such as bytearray,\n"
+"\t               memoryview, or numpy array, at the current position or\n"
+"\t               at the specified offset, return number of bytes read\n"
+"\twrite(buf)  -- write string or buffer to file\n"
 "\ttruncate(off) -- truncate file at specified offset\n"
 "\tseek(off)   -- seek to specified offset\n"
 "\ttell()      -- return current offest\n"
@@ -651,7 +772,10 @@ Client_dealloc(PyObject *pself)
     qfs_Client *self = (qfs_Client *)pself;
     Py_XDECREF(self->qfshost);
     Py_XDECREF(self->cwd);
-    delete self->client;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    delete client;
+    Py_END_ALLOW_THREADS
     self->ob_type->tp_free(pself);
 }
 
@@ -688,7 +812,10 @@ Client_init(PyObject *pself, PyObject *args, PyObject *kwds)
         return -1;
     }
 
-    KfsClient* client = KFS::Connect(qfsHost, qfsPort);
+    KfsClient* client;
+    Py_BEGIN_ALLOW_THREADS
+    client = KFS::Connect(qfsHost, qfsPort);
+    Py_END_ALLOW_THREADS
     if (!client) {
         PyErr_SetString(PyExc_IOError, "Unable to start client.");
         return -1;
@@ -784,7 +911,11 @@ qfs_cd(PyObject *pself, PyObject *args)
 
     string path = build_path(self->cwd, patharg);
     KfsFileAttr attr;
-    int status = self->client->Stat(path.c_str(), attr);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Stat(path.c_str(), attr);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -824,7 +955,11 @@ qfs_isdir(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    bool res = self->client->IsDirectory(path.c_str());
+    bool res;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    res = client->IsDirectory(path.c_str());
+    Py_END_ALLOW_THREADS
     return Py_BuildValue("b", res);
 }
 
@@ -838,7 +973,11 @@ qfs_isfile(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    bool res = self->client->IsFile(path.c_str());
+    bool res;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    res = client->IsFile(path.c_str());
+    Py_END_ALLOW_THREADS
     return Py_BuildValue("b", res);
 }
 
@@ -852,7 +991,11 @@ qfs_mkdir(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int status  = self->client->Mkdir(path.c_str());
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Mkdir(path.c_str());
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -870,7 +1013,11 @@ qfs_mkdirs(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int status  = self->client->Mkdirs(path.c_str());
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Mkdirs(path.c_str());
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -888,7 +1035,11 @@ qfs_rmdir(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int status = self->client->Rmdir(path.c_str());
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Rmdir(path.c_str());
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -906,7 +1057,11 @@ qfs_rmdirs(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int status = self->client->Rmdirs(path.c_str());
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Rmdirs(path.c_str());
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -932,7 +1087,11 @@ qfs_readdir(PyObject *pself, PyObject *args)
 
     string path = build_path(self->cwd, patharg);
     vector <string> result;
-    int status = self->client->Readdir(path.c_str(), result);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Readdir(path.c_str(), result);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -984,7 +1143,11 @@ qfs_readdirplus(PyObject *pself, PyObject *args)
     string path = build_path(self->cwd, patharg);
 
     vector <KfsFileAttr> result;
-    int status = self->client->ReaddirPlus(path.c_str(), result);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->ReaddirPlus(path.c_str(), result);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -998,6 +1161,108 @@ qfs_readdirplus(PyObject *pself, PyObject *args)
     return outer;
 }
 
+/*
+ * Directory entries iterator returned by readdirplus_iter. The client has no
+ * incremental directory read interface, therefore the whole directory listing
+ * is fetched and kept in memory before the iterator is returned. Only the
+ * conversion of the entries into python tuples is done one at a time, as the
+ * iteration progresses, instead of building the tuple of all entries at once.
+ */
+struct qfs_DirIter {
+    PyObject_HEAD
+    vector<KfsFileAttr> *entries; // Directory entries
+    size_t pos;                   // Next entry index
+};
+
+static void
+DirIter_dealloc(PyObject *pself)
+{
+    qfs_DirIter *self = (qfs_DirIter *)pself;
+    delete self->entries;
+    self->ob_type->tp_free(pself);
+}
+
+static PyObject *
+DirIter_next(PyObject *pself)
+{
+    qfs_DirIter *self = (qfs_DirIter *)pself;
+    if (self->entries == NULL || self->entries->size() <= self->pos) {
+        delete self->entries;
+        self->entries = NULL;
+        return NULL; // StopIteration
+    }
+    return package_fattr((*self->entries)[self->pos++]);
+}
+
+static PyTypeObject qfs_DirIterType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                     // ob_size
+    "qfs.diriterator",     // tp_name
+    sizeof (qfs_DirIter),  // tp_basicsize
+    0,                     // tp_itemsize
+    DirIter_dealloc,       // tp_dealloc
+    0,                     // tp_print
+    0,                     // tp_getattr
+    0,                     // tp_setattr
+    0,                     // tp_compare
+    0,                     // tp_repr
+    0,                     // tp_as_number
+    0,                     // tp_as_sequence
+    0,                     // tp_as_mapping
+    0,                     // tp_hash
+    0,                     // tp_call
+    0,                     // tp_str
+    0,                     // tp_getattro
+    0,                     // tp_setattro
+    0,                     // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,    // tp_flags
+    "QFS directory entries iterator.", // tp_doc
+    0,                     // tp_traverse
+    0,                     // tp_clear
+    0,                     // tp_richcompare
+    0,                     // tp_weaklistoffest
+    PyObject_SelfIter,     // tp_iter
+    DirIter_next,          // tp_iternext
+};
+
+/*!
+ * \brief iterate over directory entries with attributes
+ *
+ * Returns an iterator that yields tuples in the same format as readdirplus.
+ * The directory is read in full before returning; see qfs_DirIter.
+ */
+static PyObject *
+qfs_readdirplus_iter(PyObject *pself, PyObject *args)
+{
+    qfs_Client *self = (qfs_Client *)pself;
+    char *patharg;
+
+    if (!PyArg_ParseTuple(args, "s", &patharg))
+        return NULL;
+
+    string path = build_path(self->cwd, patharg);
+
+    vector <KfsFileAttr> *result = new vector <KfsFileAttr>();
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->ReaddirPlus(path.c_str(), *result);
+    Py_END_ALLOW_THREADS
+    if (status < 0) {
+        delete result;
+        SetPyIoError(status);
+        return NULL;
+    }
+    qfs_DirIter *it = PyObject_New(qfs_DirIter, &qfs_DirIterType);
+    if (it == NULL) {
+        delete result;
+        return NULL;
+    }
+    it->entries = result;
+    it->pos = 0;
+    return (PyObject *)it;
+}
+
 static PyObject *
 qfs_stat(PyObject *pself, PyObject *args)
 {
@@ -1009,7 +1274,11 @@ qfs_stat(PyObject *pself, PyObject *args)
 
     string path = build_path(self->cwd, patharg);
     KfsFileAttr attr;
-    int status = self->client->Stat(path.c_str(), attr, true);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Stat(path.c_str(), attr, true);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -1045,7 +1314,11 @@ qfs_fullstat(PyObject *pself, PyObject *args)
 
     string path = build_path(self->cwd, patharg);
     KfsFileAttr attr;
-    int status = self->client->Stat(path.c_str(), attr, true);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Stat(path.c_str(), attr, true);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -1085,7 +1358,11 @@ qfs_getNumChunks(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int chunkCount = self->client->GetNumChunks(path.c_str());
+    int chunkCount;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    chunkCount = client->GetNumChunks(path.c_str());
+    Py_END_ALLOW_THREADS
     if (chunkCount < 0) {
         SetPyIoError(chunkCount);
         return NULL;
@@ -1102,7 +1379,11 @@ qfs_getChunkSize(PyObject *pself, PyObject *args)
     if (!PyArg_ParseTuple(args, "s", &patharg))
         return NULL;
     string path = build_path(self->cwd, patharg);
-    int chunksz = self->client->GetChunkSize(path.c_str());
+    int chunksz;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    chunksz = client->GetChunkSize(path.c_str());
+    Py_END_ALLOW_THREADS
     return Py_BuildValue("i", chunksz);
 }
 
@@ -1117,7 +1398,11 @@ qfs_create(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int fd = self->client->Create(path.c_str(), numReplicas);
+    int fd;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    fd = client->Create(path.c_str(), numReplicas);
+    Py_END_ALLOW_THREADS
     if (fd < 0) {
         SetPyIoError(fd);
         return NULL;
@@ -1140,7 +1425,11 @@ qfs_remove(PyObject *pself, PyObject *args)
         return NULL;
 
     string path = build_path(self->cwd, patharg);
-    int status = self->client->Remove(path.c_str());
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Remove(path.c_str());
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -1160,7 +1449,11 @@ qfs_rename(PyObject *pself, PyObject *args)
 
     string spath = build_path(self->cwd, srcpath);
     string dpath = build_path(self->cwd, dstpath);
-    int status = self->client->Rename(spath.c_str(), dpath.c_str(), overwrite);
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->Rename(spath.c_str(), dpath.c_str(), overwrite);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -1180,8 +1473,12 @@ qfs_coalesceblocks(PyObject *pself, PyObject *args)
     string spath = build_path(self->cwd, srcpath);
     string dpath = build_path(self->cwd, dstpath);
         chunkOff_t dstStartOffset;
-    int status = self->client->CoalesceBlocks(
+    int status;
+    KfsClient *client = self->client;
+    Py_BEGIN_ALLOW_THREADS
+    status = client->CoalesceBlocks(
             spath.c_str(), dpath.c_str(), &dstStartOffset);
+    Py_END_ALLOW_THREADS
     if (status < 0) {
         SetPyIoError(status);
         return NULL;
@@ -1223,7 +1520,8 @@ PyMODINIT_FUNC
 initqfs()
 {
     if (PyType_Ready(&qfs_ClientType) < 0 ||
-        PyType_Ready(&qfs_FileType) < 0)
+        PyType_Ready(&qfs_FileType) < 0 ||
+        PyType_Ready(&qfs_DirIterType) < 0)
         return;
 
     PyObject *m = Py_InitModule3("qfs", NULL, module_doc);
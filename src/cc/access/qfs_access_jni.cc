@@ -236,6 +236,15 @@ extern "C" {
     jint Java_com_quantcast_qfs_access_KfsInputChannel_read(
         JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobject buf, jint begin, jint end);
 
+    jint Java_com_quantcast_qfs_access_KfsInputChannel_pread(
+        JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobject buf, jint begin, jint end,
+        jlong pos);
+
+    jint Java_com_quantcast_qfs_access_KfsInputChannel_readVectored(
+        JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobjectArray bufs,
+        jintArray begins, jintArray ends, jlongArray positions,
+        jintArray results, jlongArray latencies);
+
     jint Java_com_quantcast_qfs_access_KfsInputChannel_close(
         JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd);
 
@@ -1593,6 +1602,115 @@ jint Java_com_quantcast_qfs_access_KfsInputChannel_read(
     return (jint)sz;
 }
 
+jint Java_com_quantcast_qfs_access_KfsInputChannel_pread(
+    JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobject buf, jint begin, jint end,
+    jlong pos)
+{
+    if (! jptr) {
+        return -EFAULT;
+    }
+    KfsClient* const clnt = (KfsClient*)jptr;
+
+    if (! buf) {
+        return 0;
+    }
+    void * addr = jenv->GetDirectBufferAddress(buf);
+    jlong cap = jenv->GetDirectBufferCapacity(buf);
+
+    if (! addr || cap < 0) {
+        return 0;
+    }
+    if (begin < 0 || end > cap || begin > end || pos < 0) {
+        return -EINVAL;
+    }
+    addr = (void *)(uintptr_t(addr) + begin);
+
+    // Read directly into the caller's buffer, the file position and the read
+    // ahead buffer are not used. The read is synchronous, the calling JVM
+    // thread is blocked until the read completes. The asynchronous reads
+    // are used only by readVectored, and are not exposed to Java.
+    ssize_t sz = clnt->PRead((int) jfd, (chunkOff_t) pos, (char *) addr,
+        (size_t) (end - begin));
+    return (jint)sz;
+}
+
+jint Java_com_quantcast_qfs_access_KfsInputChannel_readVectored(
+    JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobjectArray bufs,
+    jintArray begins, jintArray ends, jlongArray positions,
+    jintArray results, jlongArray latencies)
+{
+    if (! jptr) {
+        return -EFAULT;
+    }
+    KfsClient* const clnt = (KfsClient*)jptr;
+
+    if (! bufs || ! begins || ! ends || ! positions || ! results) {
+        return -EINVAL;
+    }
+    const jsize cnt = jenv->GetArrayLength(bufs);
+    if (jenv->GetArrayLength(begins) != cnt ||
+            jenv->GetArrayLength(ends) != cnt ||
+            jenv->GetArrayLength(positions) != cnt ||
+            jenv->GetArrayLength(results) != cnt ||
+            (latencies && jenv->GetArrayLength(latencies) != cnt)) {
+        return -EINVAL;
+    }
+    if (cnt <= 0) {
+        return 0;
+    }
+    vector<jint>  jbegins(cnt);
+    vector<jint>  jends(cnt);
+    vector<jlong> jpositions(cnt);
+    jenv->GetIntArrayRegion(begins, 0, cnt, &jbegins[0]);
+    jenv->GetIntArrayRegion(ends, 0, cnt, &jends[0]);
+    jenv->GetLongArrayRegion(positions, 0, cnt, &jpositions[0]);
+
+    // Read all ranges at once with the vectored read, directly into the
+    // caller's direct buffers. The direct buffer addresses remain valid while
+    // the buffer objects are reachable, i.e. at least until this call
+    // returns. The vectored read coalesces nearby ranges, the coalesced
+    // ranges are reported as completed at the same time.
+    vector<jint>                 jresults(cnt, 0);
+    vector<KfsClient::ReadRange> ranges(cnt);
+    for (jsize i = 0; i < cnt; i++) {
+        jobject const buf  = jenv->GetObjectArrayElement(bufs, i);
+        char*         addr = buf ?
+            (char*)jenv->GetDirectBufferAddress(buf) : 0;
+        const jlong   cap  = buf ? jenv->GetDirectBufferCapacity(buf) : -1;
+        if (buf) {
+            jenv->DeleteLocalRef(buf);
+        }
+        const jint begin = jbegins[i];
+        const jint end   = jends[i];
+        KfsClient::ReadRange& range = ranges[i];
+        range.offset = (chunkOff_t)jpositions[i];
+        range.size   = 0;
+        range.buf    = 0;
+        range.status = 0;
+        range.completionUsec = 0;
+        if (! addr || cap < 0 || begin < 0 || end > cap || begin > end) {
+            jresults[i] = -EINVAL;
+            continue;
+        }
+        range.size = (size_t)(end - begin);
+        range.buf  = addr + begin;
+    }
+    clnt->PReadV((int)jfd, &ranges[0], (int)cnt);
+    vector<jlong> jlatencies(cnt, 0);
+    for (jsize i = 0; i < cnt; i++) {
+        if (0 <= jresults[i]) {
+            jresults[i]   = (jint)ranges[i].status;
+            jlatencies[i] = (jlong)ranges[i].completionUsec;
+        }
+    }
+
+    jenv->SetIntArrayRegion(results, 0, cnt, &jresults[0]);
+    if (latencies) {
+        jenv->SetLongArrayRegion(latencies, 0, cnt, &jlatencies[0]);
+    }
+    return 0;
+}
+
 jint Java_com_quantcast_qfs_access_KfsOutputChannel_write(
     JNIEnv *jenv, jclass jcls, jlong jptr, jint jfd, jobject buf, jint begin, jint end)
 {
@@ -305,6 +305,11 @@ public:
     void CloseChunk(CloseOp* op, int64_t writeId, bool& forwardFlag);
     bool CanDoLowOnBuffersFlush() const
         { return mCanDoLowOnBuffersFlushFlag; }
+    DiskQueue* GetDiskQueuePtr() const
+    {
+        return (mChunkFileHandle ?
+            mChunkFileHandle->GetDiskQueuePtr() : 0);
+    }
     void LowOnBuffersFlush()
     {
         QCStMutexLocker lock(mMutex);
@@ -401,6 +406,9 @@ private:
     time_t                  mLastActivityTime;
     time_t                  mLastAppendActivityTime;
     time_t                  mLastFlushTime;
+    // Interval flush time aligned with the other appenders using the same
+    // disk queue, or 0 if not yet determined.
+    time_t                  mFlushTime;
     // when records are streamed in from clients, they are
     // buffered by this object and then committed to disk.  This
     // field tracks the next offset in the file at which a record
@@ -484,6 +492,14 @@ private:
         { FlushSelf(true); }
     void FlushAll()
         { FlushSelf(false); }
+    time_t GetFlushTime(int flushInterval)
+    {
+        if (mFlushTime <= 0) {
+            mFlushTime = gAtomicRecordAppendManager.GetGroupFlushTime(
+                GetDiskQueuePtr(), mLastFlushTime + flushInterval);
+        }
+        return mFlushTime;
+    }
     int GetNextReplicationTimeout() const;
     void OpDone(WriteOp* op);
     void OpDone(RecordAppendOp* op);
@@ -740,6 +756,7 @@ AtomicRecordAppender::AtomicRecordAppender(
       mLastActivityTime(Now()),
       mLastAppendActivityTime(mLastActivityTime),
       mLastFlushTime(Now()),
+      mFlushTime(0),
       mNextOffset(chunkSize),
       mNextCommitOffset(chunkSize),
       mCommitOffsetAckSent(mNextCommitOffset),
@@ -1684,8 +1701,11 @@ AtomicRecordAppender::RunPendingSubmitQueue()
         } else {
             const int pendingBytes = mBuffer.BytesConsumable();
             if (0 < pendingBytes) {
-                mTimer.ScheduleTimeoutNoLaterThanIn(
-                    gAtomicRecordAppendManager.GetFlushIntervalSec());
+                const int flushInterval =
+                    gAtomicRecordAppendManager.GetFlushIntervalSec();
+                mTimer.ScheduleTimeoutNoLaterThanIn(flushInterval < 0 ?
+                    flushInterval :
+                    (int)max(time_t(0), GetFlushTime(flushInterval) - Now()));
             }
             SetCanDoLowOnBuffersFlushFlag(
                 (int)CHECKSUM_BLOCKSIZE <= pendingBytes);
@@ -2322,12 +2342,20 @@ AtomicRecordAppender::Timeout()
         ((IsMaster() || mState != kStateOpen) ? 1 : kSlaveTimeoutRatio);
     const time_t now           = Now();
     if (mBuffer.BytesConsumable() >=
-                gAtomicRecordAppendManager.GetFlushLimit(*this) ||
-            (flushInterval >= 0 && mLastFlushTime + flushInterval <= now)) {
+                gAtomicRecordAppendManager.GetFlushLimit(*this)) {
+        FlushFullBlocks();
+    } else if (flushInterval >= 0 && ! mBuffer.IsEmpty()) {
+        const time_t flushTime = GetFlushTime(flushInterval);
+        if (flushTime <= now) {
+            if (now < mLastFlushTime + flushInterval) {
+                Cntrs().mGroupFlushCount++;
+            }
+            FlushFullBlocks();
+        } else {
+            nextTimeout = Timer::MinTimeout(nextTimeout, int(flushTime - now));
+        }
+    } else if (flushInterval >= 0 && mLastFlushTime + flushInterval <= now) {
         FlushFullBlocks();
-    } else if (! mBuffer.IsEmpty() && flushInterval >= 0) {
-        nextTimeout = Timer::MinTimeout(nextTimeout,
-            int(mLastFlushTime + flushInterval - now));
     }
     if (IsMaster() && mState == kStateOpen) {
         const int ackTm =
@@ -2774,6 +2802,7 @@ AtomicRecordAppender::FlushSelf(bool flushFullChecksumBlocks)
             *this, mBuffer.BytesConsumable() - prevNumBytes);
     }
     mLastFlushTime = Now();
+    mFlushTime     = 0;
     SetCanDoLowOnBuffersFlushFlag(false);
     if (mStaggerRMWInFlightFlag) {
         mRestartFlushFlag    = ! mBuffer.IsEmpty();
@@ -3107,6 +3136,9 @@ AtomicRecordAppendManager::AtomicRecordAppendManager()
       mMinMetaUptimeSec(8 * 60),
       mFlushLimit(1 << 20),
       mMaxAppenderBytes(0),
+      mGroupFlushWindowSec(10),
+      mFlushMaxLimit(4 << 20),
+      mFlushQueueDepth(4),
       mTotalBuffersBytes(0),
       mTotalPendingBytes(0),
       mActiveAppendersCount(0),
@@ -3126,7 +3158,8 @@ AtomicRecordAppendManager::AtomicRecordAppendManager()
       mCurUpdateFlush(0),
       mCurUpdateLowBufFlush(0),
       mInstanceNum(0),
-      mCounters()
+      mCounters(),
+      mDiskQueueGroups()
 {
     PendingFlushList::Init(mPendingFlushList);
     mCounters.Clear();
@@ -3172,6 +3205,12 @@ AtomicRecordAppendManager::SetParameters(const Properties& props)
         "chunkServer.recAppender.dropLockMinSize",    mAppendDropLockMinSize));
     mCloseMinChunkSize  = max((chunkOff_t)CHECKSUM_BLOCKSIZE, props.getValue(
         "chunkServer.recAppender.closeMinChunkSize",  mCloseMinChunkSize));
+    mGroupFlushWindowSec    = props.getValue(
+        "chunkServer.recAppender.groupFlushWindowSec", mGroupFlushWindowSec);
+    mFlushMaxLimit          = max((int)CHECKSUM_BLOCKSIZE, props.getValue(
+        "chunkServer.recAppender.flushMaxLimit",      mFlushMaxLimit));
+    mFlushQueueDepth        = props.getValue(
+        "chunkServer.recAppender.flushQueueDepth",    mFlushQueueDepth);
     mTotalBuffersBytes       = 0;
     if (! mAppenders.IsEmpty()) {
         UpdateAppenderFlushLimit();
@@ -3180,7 +3219,7 @@ AtomicRecordAppendManager::SetParameters(const Properties& props)
 
 int
 AtomicRecordAppendManager::GetFlushLimit(
-    AtomicRecordAppender& /* appender */, int addBytes /* = 0 */)
+    AtomicRecordAppender& appender, int addBytes /* = 0 */)
 {
     if (addBytes != 0) {
         assert(0 <= mTotalPendingBytes + addBytes);
@@ -3188,7 +3227,64 @@ AtomicRecordAppendManager::GetFlushLimit(
         mCounters.mPendingByteCount += addBytes;
         UpdateAppenderFlushLimit();
     }
-    return mMaxAppenderBytes;
+    // The flush limit can only grow above the configured flush limit, within
+    // the appender's share of the buffers.
+    const int maxLimit = (int)min(int64_t(mFlushMaxLimit),
+        mTotalBuffersBytes / max(int64_t(1), mActiveAppendersCount));
+    if (mFlushQueueDepth <= 0 || maxLimit <= mMaxAppenderBytes) {
+        return mMaxAppenderBytes;
+    }
+    // Grow the flush size with the disk queue depth: while the disk is busy
+    // accumulate larger writes, in order to reduce the number of disk ios.
+    // The queue depth is sampled at most once a second, in order not to
+    // acquire the disk queue mutex on every append.
+    DiskQueue* const queue = appender.GetDiskQueuePtr();
+    if (! queue) {
+        return mMaxAppenderBytes;
+    }
+    DiskQueueGroup& group = mDiskQueueGroups[queue];
+    const time_t    now   = libkfsio::globalNetManager().Now();
+    if (group.mQueueDepthTime != now) {
+        int     freeCnt;
+        int64_t readBlockCnt;
+        int64_t writeBlockCnt;
+        int     blockSize;
+        if (! DiskIo::GetDiskQueuePendingCount(queue, freeCnt,
+                group.mQueueDepth, readBlockCnt, writeBlockCnt, blockSize)) {
+            group.mQueueDepth = 0;
+        }
+        group.mQueueDepthTime = now;
+    }
+    const int requestCnt = min(mFlushQueueDepth, max(0, group.mQueueDepth));
+    if (requestCnt <= 0) {
+        return mMaxAppenderBytes;
+    }
+    const int limit = mMaxAppenderBytes + (int)(
+        int64_t(maxLimit - mMaxAppenderBytes) * requestCnt / mFlushQueueDepth);
+    return max(mMaxAppenderBytes,
+        limit / (int)CHECKSUM_BLOCKSIZE * (int)CHECKSUM_BLOCKSIZE);
+}
+
+time_t
+AtomicRecordAppendManager::GetGroupFlushTime(
+    const DiskQueue* queue, time_t flushTime)
+{
+    // Align interval flushes of the appenders sharing the same disk queue, in
+    // order to submit their writes to the disk queue together. The flush can
+    // only be moved earlier, by at most the group flush window.
+    if (mGroupFlushWindowSec <= 0 || ! queue) {
+        return flushTime;
+    }
+    time_t& groupTime = mDiskQueueGroups[queue].mFlushTime;
+    if (groupTime <= flushTime &&
+            flushTime <= groupTime + mGroupFlushWindowSec &&
+            libkfsio::globalNetManager().Now() <= groupTime) {
+        return groupTime;
+    }
+    if (groupTime < flushTime) {
+        groupTime = flushTime;
+    }
+    return flushTime;
 }
 
 void
@@ -3413,6 +3509,29 @@ void
 AtomicRecordAppendManager::Timeout()
 {
     FlushIfLowOnBuffers();
+    PruneDiskQueueGroups();
+}
+
+void
+AtomicRecordAppendManager::PruneDiskQueueGroups()
+{
+    // Remove the groups with no scheduled flush and no recent appends, and
+    // all groups once no appenders remain.
+    if (mAppenders.IsEmpty()) {
+        mDiskQueueGroups.clear();
+        return;
+    }
+    const time_t now    = libkfsio::globalNetManager().Now();
+    const time_t window = max(1, mGroupFlushWindowSec);
+    DiskQueueGroups::iterator it = mDiskQueueGroups.begin();
+    while (it != mDiskQueueGroups.end()) {
+        const DiskQueueGroup& group = it->second;
+        if (max(group.mFlushTime, group.mQueueDepthTime) + window < now) {
+            mDiskQueueGroups.erase(it++);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void
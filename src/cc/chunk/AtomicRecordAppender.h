@@ -27,11 +27,13 @@
 #define CHUNK_ATOMICRECORDAPPENDER_H
 
 #include <string>
+#include <map>
 
 #include "DiskIo.h"
 #include "KfsOps.h"
 #include "common/kfsdecls.h"
 #include "common/LinearHash.h"
+#include "common/StdAllocator.h"
 
 class QCMutex;
 
@@ -79,6 +81,7 @@ public:
         Counter mLostChunkCount;
         Counter mPendingByteCount;
         Counter mLowOnBuffersFlushCount;
+        Counter mGroupFlushCount;
 
         void Clear()
         {
@@ -114,6 +117,7 @@ public:
             mLostChunkCount = 0;
             mPendingByteCount = 0;
             mLowOnBuffersFlushCount = 0;
+            mGroupFlushCount = 0;
         }
     };
     void SetParameters(const Properties& props);
@@ -189,6 +193,7 @@ public:
 
     void UpdateAppenderFlushLimit(const AtomicRecordAppender* appender = 0);
     int GetFlushLimit(AtomicRecordAppender& appender, int addBytes = 0);
+    time_t GetGroupFlushTime(const DiskQueue* queue, time_t flushTime);
     int GetAppendDropLockMinSize() const
         { return mAppendDropLockMinSize; }
     inline void UpdatePendingFlush(AtomicRecordAppender& appender);
@@ -209,6 +214,25 @@ private:
         >,
         StdFastAllocator<ARAMapEntry>
     > ARAMap;
+    // Last scheduled interval flush time, and the disk queue depth sampled
+    // at most once a second, per disk queue / chunk directory.
+    struct DiskQueueGroup
+    {
+        DiskQueueGroup()
+            : mFlushTime(0),
+              mQueueDepthTime(0),
+              mQueueDepth(0)
+            {}
+        time_t mFlushTime;
+        time_t mQueueDepthTime;
+        int    mQueueDepth;
+    };
+    typedef std::map<
+        const DiskQueue*,
+        DiskQueueGroup,
+        std::less<const DiskQueue*>,
+        StdFastAllocator<std::pair<const DiskQueue* const, DiskQueueGroup> >
+    > DiskQueueGroups;
 
     ARAMap                mAppenders;
     int                   mCleanUpSec;
@@ -219,6 +243,9 @@ private:
     int                   mMinMetaUptimeSec;
     int                   mFlushLimit;
     int                   mMaxAppenderBytes;
+    int                   mGroupFlushWindowSec;
+    int                   mFlushMaxLimit;
+    int                   mFlushQueueDepth;
     int64_t               mTotalBuffersBytes;
     int64_t               mTotalPendingBytes;
     int64_t               mActiveAppendersCount;
@@ -239,10 +266,12 @@ private:
     AtomicRecordAppender* mCurUpdateLowBufFlush;
     const uint64_t        mInstanceNum;
     Counters              mCounters;
+    DiskQueueGroups       mDiskQueueGroups;
 
     AtomicRecordAppendManager();
     ~AtomicRecordAppendManager();
     inline void UpdatePendingFlushIterators(AtomicRecordAppender& appender);
+    void PruneDiskQueueGroups();
     friend class ChunkServerGlobals;
 private:
     AtomicRecordAppendManager(const AtomicRecordAppendManager&);
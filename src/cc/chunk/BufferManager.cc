@@ -30,6 +30,7 @@
 #include "qcdio/qcdebug.h"
 #include "kfsio/NetManager.h"
 #include "kfsio/Globals.h"
+#include "kfsio/IOBufferMagazineAllocator.h"
 
 namespace KFS
 {
@@ -62,6 +63,8 @@ BufferManager::Client::Reset()
 BufferManager::BufferManager(
     bool inEnabledFlag /* = true */)
     : ITimeout(),
+      mBufferPoolPtr(0),
+      mBufferCachePtr(0),
       mTotalCount(0),
       mMaxClientQuota(0),
       mRemainingCount(0),
@@ -102,10 +105,11 @@ BufferManager::~BufferManager()
 
     void
 BufferManager::Init(
-    QCIoBufferPool*          inBufferPoolPtr,
-    BufferManager::ByteCount inTotalCount,
-    BufferManager::ByteCount inMaxClientQuota,
-    int                      inMinBufferCount)
+    QCIoBufferPool*                  inBufferPoolPtr,
+    BufferManager::ByteCount         inTotalCount,
+    BufferManager::ByteCount         inMaxClientQuota,
+    int                              inMinBufferCount,
+    const IOBufferMagazineAllocator* inBufferCachePtr)
 {
     QCRTASSERT(! mInitedFlag);
     mInitedFlag                = true;
@@ -117,6 +121,7 @@ BufferManager::Init(
     mPutRequestCount           = 0;
     mClientsWihtBuffersCount   = 0;
     mBufferPoolPtr             = inBufferPoolPtr;
+    mBufferCachePtr            = inBufferCachePtr;
     mTotalCount                = inTotalCount;
     mRemainingCount            = mTotalCount;
     mMinBufferCount            = inMinBufferCount;
@@ -311,12 +316,26 @@ BufferManager::CancelRequest(
     inClient.mOverQuotaWaitingFlag = false;
 }
 
+    int
+BufferManager::GetFreeBufferCount() const
+{
+    // The buffers cached by the io buffer allocator magazines are free, and
+    // available to the threads that own the magazines.
+    return (mBufferPoolPtr ?
+        mBufferPoolPtr->GetFreeBufferCountNoLock() +
+            (mBufferCachePtr ? mBufferCachePtr->GetCachedBufferCount() : 0) :
+        0);
+}
+
     bool
 BufferManager::IsLowOnBuffers() const
 {
+    // Use lockless free count read in order to avoid contending on the
+    // buffer pool mutex with the disk io threads on every request, the
+    // count is only used as a heuristic, and re-evaluated on every timeout.
     return (
         mBufferPoolPtr &&
-        mBufferPoolPtr->GetFreeBufferCount() < max(
+        GetFreeBufferCount() < max(
             ByteCount(mMinBufferCount),
             mRemainingCount / mBufferPoolPtr->GetBufferSize() + 1
         )
@@ -348,8 +367,8 @@ BufferManager::Timeout()
             theSetTimeFlag = false;
             theNowUsecs    = microseconds();
         }
-        mCounters.mRequestWaitUsecs += max(int64_t(0),
-            theNowUsecs - theClientPtr->mWaitStart);
+        mCounters.AddWaitUsecs(max(int64_t(0),
+            theNowUsecs - theClientPtr->mWaitStart));
         mCounters.mRequestGrantedCount++;
         mCounters.mRequestGrantedByteCount += theGrantedCount;
         theClientPtr->mByteCount += theGrantedCount;
@@ -33,6 +33,7 @@
 
 namespace KFS
 {
+class IOBufferMagazineAllocator;
 
 // Chunk server disk and network io buffer manager. The intent is "fair" io
 // buffer allocation between clients [connections]. The buffer pool size fixed
@@ -52,6 +53,10 @@ public:
     struct Counters
     {
         typedef int64_t Counter;
+        // Request wait time histogram: bucket i counts granted requests
+        // that waited less than 10^(i+2) microseconds, the last bucket
+        // counts the remaining ones.
+        enum { kWaitHistogramSize = 6 };
 
         Counter mRequestCount;
         Counter mRequestByteCount;
@@ -64,6 +69,7 @@ public:
         Counter mRequestWaitUsecs;
         Counter mOverQuotaRequestDeniedCount;
         Counter mOverQuotaRequestDeniedByteCount;
+        Counter mRequestWaitHistogram[kWaitHistogramSize];
 
         void Clear()
         {
@@ -78,6 +84,21 @@ public:
             mRequestWaitUsecs                = 0;
             mOverQuotaRequestDeniedCount     = 0;
             mOverQuotaRequestDeniedByteCount = 0;
+            for (int i = 0; i < kWaitHistogramSize; i++) {
+                mRequestWaitHistogram[i] = 0;
+            }
+        }
+        void AddWaitUsecs(
+            int64_t inWaitUsecs)
+        {
+            mRequestWaitUsecs += inWaitUsecs;
+            int     theIdx   = 0;
+            int64_t theLimit = 100;
+            while (theIdx < kWaitHistogramSize - 1 && theLimit <= inWaitUsecs) {
+                theIdx++;
+                theLimit *= 10;
+            }
+            mRequestWaitHistogram[theIdx]++;
         }
     };
 
@@ -136,10 +157,11 @@ public:
         bool inEnabledFlag);
     ~BufferManager();
     void Init(
-        QCIoBufferPool* inBufferPoolPtr,
-        ByteCount       inTotalCount,
-        ByteCount       inMaxClientQuota,
-        int             inMinBufferCount);
+        QCIoBufferPool*                  inBufferPoolPtr,
+        ByteCount                        inTotalCount,
+        ByteCount                        inMaxClientQuota,
+        int                              inMinBufferCount,
+        const IOBufferMagazineAllocator* inBufferCachePtr = 0);
     ByteCount GetMaxClientQuota() const
         { return mMaxClientQuota; }
     bool IsOverQuota(
@@ -187,8 +209,7 @@ public:
         { return mRemainingCount; }
     ByteCount GetUsedByteCount() const
         { return (mTotalCount - mRemainingCount); }
-    int GetFreeBufferCount() const
-        { return (mBufferPoolPtr ? mBufferPoolPtr->GetFreeBufferCount() : 0); }
+    int GetFreeBufferCount() const;
     int GetMinBufferCount() const
         { return mMinBufferCount; }
     int GetTotalBufferCount() const
@@ -248,6 +269,7 @@ private:
     Client*         mWaitQueuePtr[1];
     Client*         mOverQuotaWaitQueuePtr[1];
     QCIoBufferPool* mBufferPoolPtr;
+    const IOBufferMagazineAllocator* mBufferCachePtr;
     ByteCount       mTotalCount;
     ByteCount       mMaxClientQuota;
     ByteCount       mRemainingCount;
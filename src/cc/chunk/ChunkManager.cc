@@ -1684,6 +1684,7 @@ ChunkManager::DeleteSelf(ChunkInfoHandle& cih)
 {
     if (0 <= cih.chunkInfo.chunkVersion) {
         HelloNotifyRemove(cih);
+        mReadCache.Invalidate(cih.chunkInfo.chunkId);
     }
     cih.Delete(mChunkInfoLists);
 }
@@ -2111,6 +2112,11 @@ ChunkManager::ChunkManager()
       mNextInactiveFdCleanupTime(globalNetManager().Now() - 365 * 24 * 60 * 60),
       mInactiveFdFullScanIntervalSecs(2),
       mNextInactiveFdFullScanTime(globalNetManager().Now() - 365 * 24 * 60 * 60),
+      mFdCacheMaxIdleSecs(4 * LEASE_INTERVAL_SECS),
+      mFdCacheIdleSecs(mInactiveFdsCleanupIntervalSecs),
+      mFdCacheGrowMissRatio(0.05),
+      mFdCachePrevHitCount(0),
+      mFdCachePrevMissCount(0),
       mReadChecksumMismatchMaxRetryCount(0),
       mAbortOnChecksumMismatchFlag(false),
       mRequireChunkHeaderChecksumFlag(false),
@@ -2134,6 +2140,7 @@ ChunkManager::ChunkManager()
       mNullBlockChecksum(0),
       mCounters(),
       mDirChecker(),
+      mReadCache(),
       mCleanupChunkDirsFlag(true),
       mStaleChunksDir("lost+found"),
       mDirtyChunksDir("dirty"),
@@ -2302,6 +2309,7 @@ ChunkManager::Shutdown()
     // Force meta server connection down first.
     gMetaServerSM.Shutdown();
     mDirChecker.Stop();
+    mReadCache.Stop();
     gClientManager.Shutdown();
     // Run delete queue before removing chunk table entries.
     RunStaleChunksQueue();
@@ -2389,6 +2397,14 @@ ChunkManager::SetParameters(const Properties& prop)
     mInactiveFdFullScanIntervalSecs = max(0, (int)prop.getValue(
         "chunkServer.inactiveFdFullScanIntervalSecs",
         (double)mInactiveFdFullScanIntervalSecs));
+    mFdCacheMaxIdleSecs = max(0, (int)prop.getValue(
+        "chunkServer.fdCacheMaxIdleSecs",
+        (double)mFdCacheMaxIdleSecs));
+    mFdCacheGrowMissRatio = prop.getValue(
+        "chunkServer.fdCacheGrowMissRatio",
+        mFdCacheGrowMissRatio);
+    // Only apply the bounds, the idle time is adapted by the periodic cleanup.
+    ApplyFdCacheIdleTimeBounds();
     mMaxPendingWriteLruSecs = max(1, (int)prop.getValue(
         "chunkServer.maxPendingWriteLruSecs",
         (double)mMaxPendingWriteLruSecs));
@@ -2654,6 +2670,7 @@ ChunkManager::SetParameters(const Properties& prop)
     ClientSM::SetParameters(prop);
     SetStorageTiers(prop);
     SetBufferedIo(prop);
+    mReadCache.SetParameters(prop);
     string errMsg;
     const int err = mCryptoKeys.SetParameters(
         "chunkServer.cryptoKeys.", prop, errMsg);
@@ -3936,6 +3953,7 @@ ChunkManager::ChangeChunkVers(
         KFS_LOG_EOM;
         return -EINVAL;
     }
+    mReadCache.Invalidate(cih->chunkInfo.chunkId);
     bool    targetStable = false;
     int64_t targetVersion;
     if (chunkVersion < 0 &&
@@ -4399,10 +4417,11 @@ ChunkManager::OpenChunk(ChunkInfoHandle* cih, int openFlags)
     string errMsg;
     const string fn = MakeChunkPathname(cih);
     bool tempFailureFlag = false;
+    const int64_t startTime = microseconds();
     // Set reservation size larger than max chunk size in order to detect files
     // that weren't properly closed. + 1 here will make file one io block bigger
     // QCDiskQueue::OpenFile() makes EOF block size aligned.
-    if (! cih->dataFH->Open(
+    const bool okFlag = cih->dataFH->Open(
             fn.c_str(),
             CHUNKSIZE + KFS_CHUNK_HEADER_SIZE + 1,
             (openFlags & (O_WRONLY | O_RDWR)) == 0,
@@ -4410,7 +4429,10 @@ ChunkManager::OpenChunk(ChunkInfoHandle* cih, int openFlags)
             (openFlags & O_CREAT) != 0,
             &errMsg,
             &tempFailureFlag,
-            mBufferedIoFlag || cih->GetDirInfo().bufferedIoFlag)) {
+            mBufferedIoFlag || cih->GetDirInfo().bufferedIoFlag);
+    mCounters.mChunkOpenCount++;
+    mCounters.mChunkOpenUsecs += max(int64_t(0), microseconds() - startTime);
+    if (! okFlag) {
         mCounters.mOpenErrorCount++;
         if ((openFlags & O_CREAT) != 0 || ! tempFailureFlag) {
             // Failed to open/create a file. notify the metaserver
@@ -4640,8 +4662,26 @@ ChunkManager::ReadChunk(ReadOp* op)
         KFS_LOG_EOM;
         return -EBADVERS;
     }
-    DiskIo* const d = SetupDiskIo(cih, op);
-    if (! d) {
+    DiskIo* d = 0;
+    if (mReadCache.IsEnabled() && ! op->wop &&
+            0 <= cih->chunkInfo.chunkVersion && cih->IsStable() &&
+            ! cih->IsBeingReplicated()) {
+        bool admitFlag = false;
+        const DiskIo::FilePtr cacheFile = mReadCache.Get(
+            cih->chunkInfo.chunkId, cih->chunkInfo.chunkVersion,
+            op->numBytes, admitFlag);
+        if (cacheFile) {
+            // Keep chunk file and checksums loaded, as with chunk file read.
+            LruUpdate(*cih);
+            d = new DiskIo(cacheFile, op);
+        } else if (admitFlag) {
+            mReadCache.Admit(
+                cih->chunkInfo.chunkId, cih->chunkInfo.chunkVersion,
+                MakeChunkPathname(cih),
+                cih->chunkInfo.GetHeaderSize() + cih->chunkInfo.chunkSize);
+        }
+    }
+    if (! d && ! (d = SetupDiskIo(cih, op))) {
         return -ESERVERBUSY;
     }
 
@@ -4671,8 +4711,25 @@ ChunkManager::ReadChunk(ReadOp* op)
         numBytesIO = cih->chunkInfo.chunkSize - offset;
     }
     op->diskIOTime = microseconds();
-    const int ret = op->diskIo->Read(
+    int ret = op->diskIo->Read(
         offset + cih->chunkInfo.GetHeaderSize(), numBytesIO);
+    if (ret < 0 && mReadCache.IsCacheFile(op->diskIo.get())) {
+        // Cache device error must not be charged to the chunk: discard the
+        // cached copy, and read the chunk file.
+        KFS_LOG_STREAM_ERROR <<
+            "read cache read failure:"
+            " chunk: "  << op->chunkId <<
+            " status: " << ret <<
+        KFS_LOG_EOM;
+        mReadCache.Invalidate(cih->chunkInfo.chunkId, true);
+        if (! (d = SetupDiskIo(cih, op))) {
+            op->diskIo.reset();
+            return -ESERVERBUSY;
+        }
+        op->diskIo.reset(d);
+        ret = op->diskIo->Read(
+            offset + cih->chunkInfo.GetHeaderSize(), numBytesIO);
+    }
     if (ret < 0) {
         cih->ReadStats(ret, (int64_t)numBytesIO, 0);
         ReportIOFailure(cih, ret);
@@ -4911,7 +4968,8 @@ ChunkManager::ReadChunkDone(ReadOp* op)
     bool staleRead = false;
     if (! cih ||
             op->chunkVersion != cih->chunkInfo.chunkVersion ||
-            (staleRead = ! cih->IsFileEquals(op->diskIo))) {
+            (staleRead = ! cih->IsFileEquals(op->diskIo) &&
+                ! mReadCache.IsCacheFile(op->diskIo.get()))) {
         op->dataBuf.Clear();
         if (cih) {
             KFS_LOG_STREAM_INFO <<
@@ -5219,6 +5277,24 @@ ChunkManager::ReadChunkDone(ReadOp* op)
         AdjustDataRead(op);
         return true;
     }
+    if (mReadCache.IsCacheFile(op->diskIo.get())) {
+        // Discard cached copy, and re-read from the chunk file.
+        KFS_LOG_STREAM_ERROR <<
+            "read cache checksum mismatch:"
+            " chunk: "  << op->chunkId <<
+            " offset: " << op->offset <<
+            " bytes: "  << op->numBytesIO <<
+        KFS_LOG_EOM;
+        mReadCache.Invalidate(op->chunkId, true);
+        op->dataBuf.Clear();
+        const int res = ReadChunk(op);
+        if (res == 0) {
+            return false;
+        }
+        op->status = res;
+        op->checksum.clear();
+        return true;
+    }
     const bool retry = op->retryCnt++ < mReadChecksumMismatchMaxRetryCount;
     op->status = -EBADCKSUM;
     cih->ReadStats(op->status, readLen, op->diskIOTime);
@@ -5294,6 +5370,35 @@ ChunkManager::NotifyMetaCorruptedChunk(ChunkInfoHandle* cih, int err)
     }
 }
 
+bool
+ChunkManager::ReadChunkFailed(ReadOp* op)
+{
+    if (! mReadCache.IsCacheFile(op->diskIo.get())) {
+        if (op->status != -ETIMEDOUT) {
+            ChunkIOFailed(op->chunkId, op->chunkVersion, op->status,
+                op->diskIo.get());
+        }
+        return false;
+    }
+    // Discard cached copy, and re-read from the chunk file.
+    mReadCache.Invalidate(op->chunkId, true);
+    const int status = op->status;
+    op->status = 0;
+    op->dataBuf.Clear();
+    const int res = ReadChunk(op);
+    if (res == 0) {
+        return true;
+    }
+    KFS_LOG_STREAM_ERROR <<
+        "read cache io error:"
+        " chunk: "  << op->chunkId <<
+        " status: " << status <<
+        " chunk file read failed: " << res <<
+    KFS_LOG_EOM;
+    op->status = res;
+    return false;
+}
+
 void
 ChunkManager::ChunkIOFailed(kfsChunkId_t chunkId, int64_t chunkVersion,
     int err, const DiskIo::File* file)
@@ -5310,6 +5415,10 @@ ChunkManager::ChunkIOFailed(kfsChunkId_t chunkId, int64_t chunkVersion,
         KFS_LOG_EOM;
         return;
     }
+    if (mReadCache.IsCacheFile(file)) {
+        mReadCache.Invalidate(chunkId, true);
+        return;
+    }
     if (! cih->IsFileEquals(file)) {
         KFS_LOG_STREAM_DEBUG <<
             "ignoring stale io failure notification: " << chunkId <<
@@ -5567,7 +5676,10 @@ ChunkManager::GetChecksums(kfsChunkId_t chunkId, int64_t chunkVersion,
 DiskIo*
 ChunkManager::SetupDiskIo(ChunkInfoHandle *cih, KfsCallbackObj* op)
 {
-    if (! cih->IsFileOpen()) {
+    if (cih->IsFileOpen()) {
+        mCounters.mFdCacheHitCount++;
+    } else {
+        mCounters.mFdCacheMissCount++;
         if (OpenChunk(cih, O_RDWR) < 0) {
             return 0;
         }
@@ -6602,6 +6714,7 @@ ChunkManager::Timeout()
     }
     gLeaseClerk.Timeout();
     gAtomicRecordAppendManager.Timeout();
+    mReadCache.Timeout();
 }
 
 template<typename TT, typename WT> void
@@ -6681,8 +6794,14 @@ ChunkManager::CleanupInactiveFds(time_t now, const ChunkInfoHandle* cur)
             }
             return true;
         }
+        UpdateFdCacheIdleTime();
         expireTime = now - mInactiveFdsCleanupIntervalSecs;
     }
+    // Under fd pressure evict in lru order, otherwise keep stable chunk files
+    // open for the adaptive idle time.
+    const time_t       stableExpireTime = releaseCnt < 0 ?
+        now - max(mInactiveFdsCleanupIntervalSecs, mFdCacheIdleSecs) :
+        expireTime;
     const time_t       unstableObjBlockExpireTime =
         now - mInactiveFdsCleanupIntervalSecs;
     ChunkLru::Iterator it(mChunkInfoLists[kChunkLruList]);
@@ -6704,6 +6823,10 @@ ChunkManager::CleanupInactiveFds(time_t now, const ChunkInfoHandle* cur)
         if (expireTime <= cih->lastIOTime) {
             break;
         }
+        if (stableExpireTime <= cih->lastIOTime &&
+                0 <= cih->chunkInfo.chunkVersion && cih->IsStable()) {
+            continue;
+        }
         bool   hasLeaseFlag         = false;
         bool   writePendingFlag     = false;
         bool   objBlockMetaDownFlag = false;
@@ -6776,6 +6899,38 @@ ChunkManager::CleanupInactiveFds(time_t now, const ChunkInfoHandle* cur)
     return fdsAvailableFlag;
 }
 
+void
+ChunkManager::UpdateFdCacheIdleTime()
+{
+    const int64_t hitCnt  =
+        mCounters.mFdCacheHitCount  - mFdCachePrevHitCount;
+    const int64_t missCnt =
+        mCounters.mFdCacheMissCount - mFdCachePrevMissCount;
+    mFdCachePrevHitCount  = mCounters.mFdCacheHitCount;
+    mFdCachePrevMissCount = mCounters.mFdCacheMissCount;
+    // Shrink when over 3/4 of chunk files or fds limit are in use, grow if
+    // the miss ratio is above the threshold.
+    const uint64_t openChunkCnt = globals().ctrOpenDiskFds.GetValue();
+    if ((uint64_t)mMaxOpenChunkFiles * 3 < openChunkCnt * 4 ||
+            (uint64_t)mMaxOpenFds * 3 < (openChunkCnt * mFdsPerChunk +
+                globals().ctrOpenNetFds.GetValue()) * 4) {
+        mFdCacheIdleSecs /= 2;
+    } else if (0 < missCnt &&
+            (hitCnt + missCnt) * mFdCacheGrowMissRatio < missCnt) {
+        mFdCacheIdleSecs = max(1, mFdCacheIdleSecs) * 2;
+    }
+    ApplyFdCacheIdleTimeBounds();
+}
+
+void
+ChunkManager::ApplyFdCacheIdleTimeBounds()
+{
+    const int minIdleSecs = mInactiveFdsCleanupIntervalSecs;
+    const int maxIdleSecs = max(minIdleSecs, mFdCacheMaxIdleSecs);
+    mFdCacheIdleSecs = max(minIdleSecs, min(maxIdleSecs, mFdCacheIdleSecs));
+    mCounters.mFdCacheIdleSecs = mFdCacheIdleSecs;
+}
+
 typedef map<int64_t, int> FileSystemIdsCount;
 
 bool
@@ -7002,6 +7157,12 @@ ChunkManager::StartDiskIo()
     mMaxIORequestSize = min(CHUNKSIZE, DiskIo::GetMaxRequestSize());
     UpdateCountFsSpaceAvailable();
     GetFsSpaceAvailable();
+    string errMsg;
+    if (! mReadCache.Start(&errMsg) && ! errMsg.empty()) {
+        KFS_LOG_STREAM_ERROR <<
+            "failed to start read cache: " << errMsg <<
+        KFS_LOG_EOM;
+    }
     return true;
 }
 
@@ -33,6 +33,7 @@
 #include "KfsOps.h"
 #include "DiskIo.h"
 #include "DirChecker.h"
+#include "ChunkReadCache.h"
 
 #include "kfsio/ITimeout.h"
 #include "kfsio/CryptoKeys.h"
@@ -95,6 +96,11 @@ public:
         Counter mHelloResumeCount;
         Counter mHelloResumeFailedCount;
         Counter mPartialHelloResumeFailedCount;
+        Counter mFdCacheHitCount;
+        Counter mFdCacheMissCount;
+        Counter mFdCacheIdleSecs;
+        Counter mChunkOpenCount;
+        Counter mChunkOpenUsecs;
 
         void Clear()
         {
@@ -116,6 +122,11 @@ public:
             mHelloResumeCount                    = 0;
             mHelloResumeFailedCount              = 0;
             mPartialHelloResumeFailedCount       = 0;
+            mFdCacheHitCount                     = 0;
+            mFdCacheMissCount                    = 0;
+            mFdCacheIdleSecs                     = 0;
+            mChunkOpenCount                      = 0;
+            mChunkOpenUsecs                      = 0;
         }
     };
 
@@ -252,6 +263,10 @@ public:
     /// @param[in] op  The write op that just finished
     ///
     bool ReadChunkDone(ReadOp *op);
+    /// Read disk io error handler. Returns true if the read was re-issued
+    /// from the chunk file after read cache file io error, false if the
+    /// read has failed.
+    bool ReadChunkFailed(ReadOp *op);
     void ReplicationDone(kfsChunkId_t chunkId, int status,
         const DiskIo::FilePtr& filePtr);
     /// Determine the size of a chunk.
@@ -369,6 +384,8 @@ public:
 
     void GetCounters(Counters& counters)
         { counters = mCounters; }
+    void GetReadCacheCounters(ChunkReadCache::Counters& counters) const
+        { mReadCache.GetCounters(counters); }
 
     /// Utility function that sets up a disk connection for an
     /// I/O operation on a chunk.
@@ -914,6 +931,13 @@ private:
     time_t mNextInactiveFdCleanupTime;
     int    mInactiveFdFullScanIntervalSecs;
     time_t mNextInactiveFdFullScanTime;
+    // Stable chunk files are kept open for up to the max idle time, the
+    // current idle time adapts to the open miss ratio and fd headroom.
+    int     mFdCacheMaxIdleSecs;
+    int     mFdCacheIdleSecs;
+    double  mFdCacheGrowMissRatio;
+    int64_t mFdCachePrevHitCount;
+    int64_t mFdCachePrevMissCount;
 
     int mReadChecksumMismatchMaxRetryCount;
     bool mAbortOnChecksumMismatchFlag; // For debugging
@@ -940,6 +964,7 @@ private:
 
     Counters   mCounters;
     DirChecker mDirChecker;
+    ChunkReadCache mReadCache;
     bool       mCleanupChunkDirsFlag;
     string     mStaleChunksDir;
     string     mDirtyChunksDir;
@@ -1075,6 +1100,8 @@ private:
     /// If we have too many open fd's close out whatever we can.  When
     /// periodic is set, we do a scan and clean up.
     bool CleanupInactiveFds(time_t now, const ChunkInfoHandle* cur = 0);
+    void UpdateFdCacheIdleTime();
+    void ApplyFdCacheIdleTimeBounds();
 
     /// For some reason, dirname is not accessable (for instance, the
     /// drive may have failed); in this case, notify metaserver that
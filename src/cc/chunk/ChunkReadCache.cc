@@ -0,0 +1,891 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \file ChunkReadCache.cc
+// \brief Stable chunk files read cache tier.
+//
+//----------------------------------------------------------------------------
+
+#include "ChunkReadCache.h"
+#include "Chunk.h"
+
+#include "common/MsgLogger.h"
+#include "common/Properties.h"
+#include "common/StdAllocator.h"
+#include "common/time.h"
+#include "kfsio/Globals.h"
+
+#include "qcdio/QCThread.h"
+#include "qcdio/QCMutex.h"
+#include "qcdio/QCUtils.h"
+#include "qcdio/QCDLList.h"
+#include "qcdio/qcstutils.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+#include <sstream>
+
+namespace KFS
+{
+
+using std::deque;
+using std::map;
+using std::vector;
+using std::less;
+using std::pair;
+using std::make_pair;
+using std::min;
+using std::max;
+using std::ostringstream;
+using libkfsio::globalNetManager;
+
+// Count min sketch with 4 bit like aging: all counters are halved after the
+// number of increments reaches 10 times the sketch width.
+class ChunkAccessSketch
+{
+public:
+    enum { kDepth = 4 };
+
+    ChunkAccessSketch()
+        : mTable(),
+          mMask(0),
+          mAddCount(0),
+          mResetCount(0)
+        { ChunkAccessSketch::SetWidth(64 << 10); }
+    void SetWidth(
+        int inWidth)
+    {
+        size_t theWidth = 64;
+        while ((int64_t)theWidth < inWidth && theWidth < (size_t(1) << 28)) {
+            theWidth <<= 1;
+        }
+        if (theWidth == (size_t)(mMask + 1)) {
+            return;
+        }
+        mMask = theWidth - 1;
+        mTable.assign(theWidth * kDepth, uint8_t(0));
+        mAddCount   = 0;
+        mResetCount = (int64_t)theWidth * 10;
+    }
+    int Add(
+        kfsChunkId_t inChunkId)
+    {
+        uint8_t* thePtrs[kDepth];
+        int      theMin = 255;
+        for (int i = 0; i < kDepth; i++) {
+            thePtrs[i] = &mTable[Index(inChunkId, i)];
+            theMin = min(theMin, (int)*thePtrs[i]);
+        }
+        if (theMin < 255) {
+            // Conservative update.
+            for (int i = 0; i < kDepth; i++) {
+                if (*thePtrs[i] == theMin) {
+                    (*thePtrs[i])++;
+                }
+            }
+            theMin++;
+        }
+        if (mResetCount <= ++mAddCount) {
+            mAddCount = 0;
+            for (vector<uint8_t>::iterator theIt = mTable.begin();
+                    theIt != mTable.end();
+                    ++theIt) {
+                *theIt >>= 1;
+            }
+        }
+        return theMin;
+    }
+    int Estimate(
+        kfsChunkId_t inChunkId) const
+    {
+        int theMin = 255;
+        for (int i = 0; i < kDepth; i++) {
+            theMin = min(theMin, (int)mTable[Index(inChunkId, i)]);
+        }
+        return theMin;
+    }
+private:
+    vector<uint8_t> mTable;
+    uint64_t        mMask;
+    int64_t         mAddCount;
+    int64_t         mResetCount;
+
+    size_t Index(
+        kfsChunkId_t inChunkId,
+        int          inRow) const
+    {
+        static const uint64_t kSeeds[kDepth] = {
+            0x9E3779B97F4A7C15ull,
+            0xC2B2AE3D27D4EB4Full,
+            0x165667B19E3779F9ull,
+            0x27D4EB2F165667C5ull
+        };
+        uint64_t theHash = (uint64_t)inChunkId ^ kSeeds[inRow];
+        theHash ^= theHash >> 33;
+        theHash *= 0xFF51AFD7ED558CCDull;
+        theHash ^= theHash >> 33;
+        theHash *= 0xC4CEB9FE1A85EC53ull;
+        theHash ^= theHash >> 33;
+        return (size_t)(theHash & mMask) * kDepth + inRow;
+    }
+};
+
+class ChunkReadCache::Impl : public QCRunnable
+{
+public:
+    typedef ChunkReadCache::Counters Counters;
+
+    Impl()
+        : QCRunnable(),
+          mDirName(),
+          mMaxBytes(0),
+          mMinAdmitFrequency(4),
+          mMaxPendingCopies(4),
+          mMaxOpenFiles(256),
+          mMaxCopyBytesPerSec(64 << 20),
+          mMaxIoErrors(4),
+          mErrorBackoffSec(60),
+          mBufferedIoFlag(false),
+          mQueuePtr(0),
+          mSketch(),
+          mEntries(),
+          mByteCount(0),
+          mOpenFileCount(0),
+          mPendingCopyCount(0),
+          mSeq(0),
+          mErrorCount(0),
+          mSuspendCount(0),
+          mSuspendEndTime(0),
+          mFailedChunks(),
+          mCounters(),
+          mThread(),
+          mMutex(),
+          mCond(),
+          mRequests(),
+          mDone(),
+          mRunFlag(false)
+    {
+        Lru::Init(mLru);
+        mCounters.Clear();
+    }
+    virtual ~Impl()
+        { Impl::Stop(); }
+    void SetParameters(
+        const Properties& inProperties)
+    {
+        if (! mQueuePtr) {
+            mDirName = inProperties.getValue(
+                "chunkServer.readCache.dir", mDirName);
+        }
+        mMaxBytes = inProperties.getValue(
+            "chunkServer.readCache.maxBytes", mMaxBytes);
+        mMinAdmitFrequency = max(1, inProperties.getValue(
+            "chunkServer.readCache.minAdmitFrequency", mMinAdmitFrequency));
+        mMaxPendingCopies = max(1, inProperties.getValue(
+            "chunkServer.readCache.maxPendingCopies", mMaxPendingCopies));
+        mMaxOpenFiles = max(1, inProperties.getValue(
+            "chunkServer.readCache.maxOpenFiles", mMaxOpenFiles));
+        mBufferedIoFlag = inProperties.getValue(
+            "chunkServer.readCache.bufferedIo", mBufferedIoFlag ? 1 : 0) != 0;
+        mMaxIoErrors = max(1, inProperties.getValue(
+            "chunkServer.readCache.maxIoErrors", mMaxIoErrors));
+        mErrorBackoffSec = max(1, inProperties.getValue(
+            "chunkServer.readCache.errorBackoffSec", mErrorBackoffSec));
+        QCStMutexLocker theLocker(mMutex);
+        mMaxCopyBytesPerSec = inProperties.getValue(
+            "chunkServer.readCache.maxCopyBytesPerSec", mMaxCopyBytesPerSec);
+        mSketch.SetWidth(inProperties.getValue(
+            "chunkServer.readCache.sketchWidth", 64 << 10));
+    }
+    bool Start(
+        string* inErrMessagePtr)
+    {
+        if (mQueuePtr) {
+            return true;
+        }
+        if (mDirName.empty() || mMaxBytes <= 0) {
+            return false;
+        }
+        if (*mDirName.rbegin() != '/') {
+            mDirName += '/';
+        }
+        struct stat theStat = {0};
+        if (stat(mDirName.c_str(), &theStat) || ! S_ISDIR(theStat.st_mode)) {
+            const int theErr = errno;
+            if (inErrMessagePtr) {
+                *inErrMessagePtr = mDirName + ": " +
+                    QCUtils::SysError(theErr ? theErr : ENOTDIR);
+            }
+            return false;
+        }
+        RemoveCacheFiles();
+        // Use device id range that does not intersect with chunk and object
+        // store directories device ids.
+        const DiskIo::DeviceId kDeviceId =
+            DiskIo::DeviceId(1) << (sizeof(DiskIo::DeviceId) * 8 - 3);
+        const int  kMinWriteBlkSize               = 0;
+        const bool kBufferDataIgnoreOverwriteFlag = false;
+        const int  kBufferDataTailToKeepSize      = 0;
+        const bool kCreateExclusiveFlag           = false;
+        if (! DiskIo::StartIoQueue(
+                mDirName.c_str(),
+                kDeviceId,
+                mMaxOpenFiles,
+                inErrMessagePtr,
+                kMinWriteBlkSize,
+                kBufferDataIgnoreOverwriteFlag,
+                kBufferDataTailToKeepSize,
+                kCreateExclusiveFlag)) {
+            return false;
+        }
+        if (! (mQueuePtr = DiskIo::FindDiskQueue(mDirName.c_str()))) {
+            if (inErrMessagePtr) {
+                *inErrMessagePtr = mDirName + ": failed to find disk queue";
+            }
+            return false;
+        }
+        QCStMutexLocker theLocker(mMutex);
+        mRunFlag = true;
+        const int kStackSize = 64 << 10;
+        mThread.Start(this, kStackSize, "ChunkReadCache");
+        KFS_LOG_STREAM_INFO <<
+            "read cache: " << mDirName <<
+            " max bytes: " << mMaxBytes <<
+        KFS_LOG_EOM;
+        return true;
+    }
+    void Stop()
+    {
+        {
+            QCStMutexLocker theLocker(mMutex);
+            if (! mRunFlag) {
+                return;
+            }
+            mRunFlag = false;
+            mRequests.clear();
+            mCond.Notify();
+        }
+        mThread.Join();
+        mDone.clear();
+        Entry* thePtr;
+        while ((thePtr = Lru::PopFront(mLru))) {
+            delete thePtr;
+        }
+        mEntries.clear();
+        mFailedChunks.clear();
+        mByteCount        = 0;
+        mOpenFileCount    = 0;
+        mPendingCopyCount = 0;
+        mErrorCount       = 0;
+        mSuspendCount     = 0;
+        mSuspendEndTime   = 0;
+    }
+    DiskIo::FilePtr Get(
+        kfsChunkId_t inChunkId,
+        kfsSeq_t     inChunkVersion,
+        int64_t      inByteCount,
+        bool&        outAdmitFlag)
+    {
+        outAdmitFlag = false;
+        const int theFrequency = mSketch.Add(inChunkId);
+        if (0 < mSuspendEndTime) {
+            if (globalNetManager().Now() < mSuspendEndTime) {
+                mCounters.mMissCount++;
+                return DiskIo::FilePtr();
+            }
+            mSuspendEndTime = 0;
+        }
+        Entries::iterator const theIt = mEntries.find(inChunkId);
+        if (theIt != mEntries.end()) {
+            Entry& theEntry = *theIt->second;
+            if (theEntry.mChunkVersion != inChunkVersion) {
+                Invalidate(inChunkId, false);
+            } else if (theEntry.mReadyFlag) {
+                if (! theEntry.mFilePtr && ! Open(theEntry)) {
+                    Invalidate(inChunkId, true);
+                    mCounters.mMissCount++;
+                    return DiskIo::FilePtr();
+                }
+                Lru::Remove(mLru, theEntry);
+                Lru::PushBack(mLru, theEntry);
+                mCounters.mHitCount++;
+                mCounters.mHitByteCount += max(int64_t(0), inByteCount);
+                return theEntry.mFilePtr;
+            } else {
+                mCounters.mMissCount++; // Copy in flight.
+                return DiskIo::FilePtr();
+            }
+        }
+        mCounters.mMissCount++;
+        if (theFrequency < mMinAdmitFrequency ||
+                mMaxPendingCopies <= mPendingCopyCount) {
+            return DiskIo::FilePtr();
+        }
+        FailedChunks::iterator const theFIt = mFailedChunks.find(inChunkId);
+        if (theFIt != mFailedChunks.end()) {
+            if (globalNetManager().Now() < theFIt->second) {
+                mCounters.mRejectCount++;
+                return DiskIo::FilePtr();
+            }
+            mFailedChunks.erase(theFIt);
+        }
+        const Entry* const theVictimPtr = GetVictim();
+        if (theVictimPtr && mMaxBytes < mByteCount +
+                    (int64_t)(CHUNKSIZE + KFS_CHUNK_HEADER_SIZE) &&
+                theFrequency <= mSketch.Estimate(theVictimPtr->mChunkId)) {
+            mCounters.mRejectCount++;
+            return DiskIo::FilePtr();
+        }
+        outAdmitFlag = true;
+        return DiskIo::FilePtr();
+    }
+    void Admit(
+        kfsChunkId_t  inChunkId,
+        kfsSeq_t      inChunkVersion,
+        const string& inFileName,
+        int64_t       inFileSize)
+    {
+        if (! mQueuePtr || inFileSize <= 0 || mMaxBytes < inFileSize ||
+                mEntries.find(inChunkId) != mEntries.end()) {
+            mCounters.mRejectCount++;
+            return;
+        }
+        const int theFrequency = mSketch.Estimate(inChunkId);
+        while (mMaxBytes < mByteCount + inFileSize) {
+            Entry* const theVictimPtr = GetVictim();
+            if (! theVictimPtr ||
+                    theFrequency <= mSketch.Estimate(theVictimPtr->mChunkId)) {
+                mCounters.mRejectCount++;
+                return;
+            }
+            mCounters.mEvictCount++;
+            Remove(*theVictimPtr);
+        }
+        Entry& theEntry = *(new Entry(
+            inChunkId, inChunkVersion, inFileSize, ++mSeq));
+        mEntries.insert(make_pair(inChunkId, &theEntry));
+        Lru::PushBack(mLru, theEntry);
+        mByteCount += inFileSize;
+        mPendingCopyCount++;
+        mCounters.mAdmitCount++;
+        Request theRequest;
+        theRequest.mChunkId      = inChunkId;
+        theRequest.mChunkVersion = inChunkVersion;
+        theRequest.mSeq          = theEntry.mSeq;
+        theRequest.mSize         = inFileSize;
+        theRequest.mSrcName      = inFileName;
+        theRequest.mDstName      = MakeFileName(theEntry);
+        theRequest.mStatus       = 0;
+        QCStMutexLocker theLocker(mMutex);
+        mRequests.push_back(theRequest);
+        mCond.Notify();
+    }
+    bool IsCacheFile(
+        const DiskIo::File* inFilePtr) const
+    {
+        return (mQueuePtr && inFilePtr &&
+            inFilePtr->GetDiskQueuePtr() == mQueuePtr);
+    }
+    void Invalidate(
+        kfsChunkId_t inChunkId,
+        bool         inIoErrorFlag)
+    {
+        Entries::iterator const theIt = mEntries.find(inChunkId);
+        if (theIt == mEntries.end()) {
+            return;
+        }
+        if (inIoErrorFlag) {
+            mCounters.mReadErrorCount++;
+            IoError(inChunkId);
+        }
+        mCounters.mInvalidateCount++;
+        Remove(*theIt->second);
+    }
+    void Timeout()
+    {
+        if (! mQueuePtr) {
+            return;
+        }
+        Requests theDone;
+        {
+            QCStMutexLocker theLocker(mMutex);
+            theDone.swap(mDone);
+        }
+        for (Requests::iterator theIt = theDone.begin();
+                theIt != theDone.end();
+                ++theIt) {
+            CopyDone(*theIt);
+        }
+        const time_t theNow = globalNetManager().Now();
+        for (FailedChunks::iterator theIt = mFailedChunks.begin();
+                theIt != mFailedChunks.end(); ) {
+            if (theIt->second <= theNow) {
+                mFailedChunks.erase(theIt++);
+            } else {
+                ++theIt;
+            }
+        }
+        Entry* thePtr;
+        while (mMaxBytes < mByteCount && (thePtr = GetVictim())) {
+            mCounters.mEvictCount++;
+            Remove(*thePtr);
+        }
+        Lru::Iterator theLruIt(mLru);
+        while (mMaxOpenFiles < mOpenFileCount && (thePtr = theLruIt.Next())) {
+            if (thePtr->mFilePtr) {
+                // The file is closed once the last in flight io completes.
+                thePtr->mFilePtr.reset();
+                mOpenFileCount--;
+            }
+        }
+    }
+    void GetCounters(
+        Counters& outCounters) const
+    {
+        outCounters = mCounters;
+        outCounters.mEntryCount = (Counters::Counter)mEntries.size();
+        outCounters.mByteCount  = mByteCount;
+    }
+    virtual void Run()
+    {
+        QCStMutexLocker theLocker(mMutex);
+        while (mRunFlag) {
+            if (mRequests.empty()) {
+                mCond.Wait(mMutex);
+                continue;
+            }
+            Request theRequest = mRequests.front();
+            mRequests.pop_front();
+            const int64_t theMaxBytesPerSec = mMaxCopyBytesPerSec;
+            {
+                QCStMutexUnlocker theUnlocker(mMutex);
+                if (theRequest.mSrcName.empty()) {
+                    unlink(theRequest.mDstName.c_str());
+                    continue;
+                }
+                theRequest.mStatus = Copy(theRequest, theMaxBytesPerSec);
+            }
+            mDone.push_back(theRequest);
+        }
+    }
+private:
+    struct Entry
+    {
+        Entry(
+            kfsChunkId_t inChunkId,
+            kfsSeq_t     inChunkVersion,
+            int64_t      inSize,
+            uint64_t     inSeq)
+            : mChunkId(inChunkId),
+              mChunkVersion(inChunkVersion),
+              mSize(inSize),
+              mSeq(inSeq),
+              mReadyFlag(false),
+              mFilePtr()
+            { Lru::Init(*this); }
+        kfsChunkId_t const mChunkId;
+        kfsSeq_t     const mChunkVersion;
+        int64_t      const mSize;
+        uint64_t     const mSeq;
+        bool               mReadyFlag;
+        DiskIo::FilePtr    mFilePtr;
+        Entry*             mPrevPtr[1];
+        Entry*             mNextPtr[1];
+    };
+    typedef QCDLList<Entry> Lru;
+    typedef map<
+        kfsChunkId_t,
+        Entry*,
+        less<kfsChunkId_t>,
+        StdFastAllocator<pair<const kfsChunkId_t, Entry*> >
+    > Entries;
+    // Chunk id to the time when the chunk can be admitted again.
+    typedef map<
+        kfsChunkId_t,
+        time_t,
+        less<kfsChunkId_t>,
+        StdFastAllocator<pair<const kfsChunkId_t, time_t> >
+    > FailedChunks;
+    struct Request
+    {
+        kfsChunkId_t mChunkId;
+        kfsSeq_t     mChunkVersion;
+        uint64_t     mSeq;
+        int64_t      mSize;
+        string       mSrcName;
+        string       mDstName;
+        int          mStatus;
+    };
+    typedef deque<Request> Requests;
+
+    string            mDirName;
+    int64_t           mMaxBytes;
+    int               mMinAdmitFrequency;
+    int               mMaxPendingCopies;
+    int               mMaxOpenFiles;
+    int64_t           mMaxCopyBytesPerSec;
+    int               mMaxIoErrors;
+    int               mErrorBackoffSec;
+    bool              mBufferedIoFlag;
+    DiskQueue*        mQueuePtr;
+    ChunkAccessSketch mSketch;
+    Entries           mEntries;
+    int64_t           mByteCount;
+    int               mOpenFileCount;
+    int               mPendingCopyCount;
+    uint64_t          mSeq;
+    int               mErrorCount;
+    int               mSuspendCount;
+    time_t            mSuspendEndTime;
+    FailedChunks      mFailedChunks;
+    Counters          mCounters;
+    QCThread          mThread;
+    QCMutex           mMutex;
+    QCCondVar         mCond;
+    Requests          mRequests;
+    Requests          mDone;
+    bool              mRunFlag;
+    Entry*            mLru[1];
+
+    // The entry sequence number makes the file name unique, therefore the
+    // deferred unlink of an evicted or failed entry file cannot remove the
+    // file of a newer entry of the same chunk. Reads in flight hold the
+    // evicted file open.
+    string MakeFileName(
+        const Entry& inEntry) const
+    {
+        ostringstream theStream;
+        theStream << mDirName << inEntry.mChunkId << "." <<
+            inEntry.mChunkVersion << "." << inEntry.mSeq << ".rc";
+        return theStream.str();
+    }
+    void IoError(
+        kfsChunkId_t inChunkId)
+    {
+        const time_t theNow = globalNetManager().Now();
+        mFailedChunks[inChunkId] = theNow + mErrorBackoffSec;
+        if (++mErrorCount < mMaxIoErrors) {
+            return;
+        }
+        mErrorCount = 0;
+        const int theBackoff = mErrorBackoffSec << min(6, mSuspendCount);
+        mSuspendCount++;
+        mSuspendEndTime = theNow + theBackoff;
+        mCounters.mSuspendCount++;
+        KFS_LOG_STREAM_ERROR <<
+            "read cache: " << mDirName <<
+            " " << mMaxIoErrors << " consecutive errors,"
+            " suspended for " << theBackoff << " sec" <<
+        KFS_LOG_EOM;
+    }
+    Entry* GetVictim() const
+    {
+        Lru::Iterator theIt(mLru);
+        Entry*        thePtr;
+        while ((thePtr = theIt.Next()) && ! thePtr->mReadyFlag)
+            {}
+        return thePtr;
+    }
+    bool Open(
+        Entry& inEntry)
+    {
+        const string theName = MakeFileName(inEntry);
+        DiskIo::FilePtr theFilePtr(new DiskIo::File());
+        string          theErrMsg;
+        const bool      kReadOnlyFlag         = true;
+        const bool      kReserveFileSpaceFlag = false;
+        const bool      kCreateFlag           = false;
+        if (! theFilePtr->Open(theName.c_str(), -1, kReadOnlyFlag,
+                kReserveFileSpaceFlag, kCreateFlag, &theErrMsg, 0,
+                mBufferedIoFlag)) {
+            KFS_LOG_STREAM_ERROR <<
+                "read cache: failed to open " << theName <<
+                " " << theErrMsg <<
+            KFS_LOG_EOM;
+            return false;
+        }
+        inEntry.mFilePtr = theFilePtr;
+        mOpenFileCount++;
+        return true;
+    }
+    void Remove(
+        Entry& inEntry)
+    {
+        mEntries.erase(inEntry.mChunkId);
+        Lru::Remove(mLru, inEntry);
+        mByteCount -= inEntry.mSize;
+        if (inEntry.mFilePtr) {
+            mOpenFileCount--;
+        }
+        if (inEntry.mReadyFlag) {
+            // Unlink in the cache thread. Reads in flight, if any, hold the
+            // file open.
+            Request theRequest;
+            theRequest.mChunkId      = inEntry.mChunkId;
+            theRequest.mChunkVersion = inEntry.mChunkVersion;
+            theRequest.mSeq          = inEntry.mSeq;
+            theRequest.mSize         = 0;
+            theRequest.mDstName      = MakeFileName(inEntry);
+            theRequest.mStatus       = 0;
+            QCStMutexLocker theLocker(mMutex);
+            mRequests.push_back(theRequest);
+            mCond.Notify();
+        } else {
+            // Copy in flight, CopyDone() will remove the file.
+            mPendingCopyCount--;
+        }
+        delete &inEntry;
+    }
+    void CopyDone(
+        Request& inRequest)
+    {
+        Entries::iterator const theIt = mEntries.find(inRequest.mChunkId);
+        Entry* const thePtr = theIt == mEntries.end() ? 0 : theIt->second;
+        if (! thePtr || thePtr->mSeq != inRequest.mSeq ||
+                thePtr->mReadyFlag || inRequest.mStatus != 0) {
+            if (inRequest.mStatus != 0) {
+                mCounters.mCopyErrorCount++;
+                KFS_LOG_STREAM_ERROR <<
+                    "read cache: failed to copy " << inRequest.mSrcName <<
+                    " to " << inRequest.mDstName <<
+                    " " << QCUtils::SysError(-inRequest.mStatus) <<
+                KFS_LOG_EOM;
+                if (thePtr && thePtr->mSeq == inRequest.mSeq) {
+                    Remove(*thePtr);
+                }
+                IoError(inRequest.mChunkId);
+            }
+            // Invalidated while copy was in flight, or failed.
+            inRequest.mSrcName.clear();
+            QCStMutexLocker theLocker(mMutex);
+            mRequests.push_back(inRequest);
+            mCond.Notify();
+            return;
+        }
+        thePtr->mReadyFlag = true;
+        mPendingCopyCount--;
+        mErrorCount        = 0;
+        mSuspendCount      = 0;
+        mCounters.mCopyCount++;
+        mCounters.mCopyByteCount += thePtr->mSize;
+        KFS_LOG_STREAM_DEBUG <<
+            "read cache: added"
+            " chunk: "   << thePtr->mChunkId <<
+            " version: " << thePtr->mChunkVersion <<
+            " size: "    << thePtr->mSize <<
+        KFS_LOG_EOM;
+    }
+    // The copy io is not issued through the disk queues, therefore it is rate
+    // limited in order to keep the chunk and cache directories io bandwidth
+    // available for the client requests.
+    static int Copy(
+        const Request& inRequest,
+        int64_t        inMaxBytesPerSec)
+    {
+        const int theSrcFd = open(inRequest.mSrcName.c_str(), O_RDONLY);
+        if (theSrcFd < 0) {
+            return (errno ? -errno : -EIO);
+        }
+        const string theTmpName = inRequest.mDstName + ".tmp";
+        const int    theDstFd   = open(theTmpName.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (theDstFd < 0) {
+            const int theErr = errno ? -errno : -EIO;
+            close(theSrcFd);
+            return theErr;
+        }
+        const size_t kBufSize = 1 << 20;
+        vector<char> theBuf(kBufSize);
+        int64_t      theRem   = inRequest.mSize;
+        int          theRet   = 0;
+        const int64_t theStart = microseconds();
+        while (0 < theRem) {
+            if (0 < inMaxBytesPerSec) {
+                const int64_t theDone  = inRequest.mSize - theRem;
+                const int64_t theSleep = theDone * 1000 * 1000 /
+                    inMaxBytesPerSec - (microseconds() - theStart);
+                if (0 < theSleep) {
+                    usleep((useconds_t)min(theSleep, int64_t(1000 * 1000)));
+                    continue;
+                }
+            }
+            const ssize_t theNRd = read(theSrcFd, &theBuf[0],
+                (size_t)min(theRem, (int64_t)kBufSize));
+            if (theNRd <= 0) {
+                theRet = theNRd < 0 ? (errno ? -errno : -EIO) : -EIO;
+                break;
+            }
+            const char* thePtr = &theBuf[0];
+            ssize_t     theLen = theNRd;
+            while (0 < theLen) {
+                const ssize_t theNWr = write(theDstFd, thePtr, (size_t)theLen);
+                if (theNWr <= 0) {
+                    theRet = errno ? -errno : -EIO;
+                    break;
+                }
+                thePtr += theNWr;
+                theLen -= theNWr;
+            }
+            if (theRet != 0) {
+                break;
+            }
+            theRem -= theNRd;
+        }
+        close(theSrcFd);
+        if (close(theDstFd) && theRet == 0) {
+            theRet = errno ? -errno : -EIO;
+        }
+        if (theRet == 0 &&
+                rename(theTmpName.c_str(), inRequest.mDstName.c_str())) {
+            theRet = errno ? -errno : -EIO;
+        }
+        if (theRet != 0) {
+            unlink(theTmpName.c_str());
+        }
+        return theRet;
+    }
+    void RemoveCacheFiles()
+    {
+        DIR* const theDirPtr = opendir(mDirName.c_str());
+        if (! theDirPtr) {
+            return;
+        }
+        const struct dirent* thePtr;
+        while ((thePtr = readdir(theDirPtr))) {
+            const char* const theNamePtr = thePtr->d_name;
+            const size_t      theLen     = strlen(theNamePtr);
+            if ((3 < theLen &&
+                    strcmp(theNamePtr + theLen - 3, ".rc") == 0) ||
+                    (7 < theLen &&
+                    strcmp(theNamePtr + theLen - 7, ".rc.tmp") == 0)) {
+                unlink((mDirName + theNamePtr).c_str());
+            }
+        }
+        closedir(theDirPtr);
+    }
+private:
+    Impl(
+        const Impl& inImpl);
+    Impl& operator=(
+        const Impl& inImpl);
+};
+
+ChunkReadCache::ChunkReadCache()
+    : mImpl(*(new Impl())),
+      mEnabledFlag(false)
+    {}
+
+ChunkReadCache::~ChunkReadCache()
+{
+    delete &mImpl;
+}
+
+    void
+ChunkReadCache::SetParameters(
+    const Properties& inProperties)
+{
+    mImpl.SetParameters(inProperties);
+}
+
+    bool
+ChunkReadCache::Start(
+    string* inErrMessagePtr)
+{
+    mEnabledFlag = mImpl.Start(inErrMessagePtr);
+    return mEnabledFlag;
+}
+
+    void
+ChunkReadCache::Stop()
+{
+    mEnabledFlag = false;
+    mImpl.Stop();
+}
+
+    DiskIo::FilePtr
+ChunkReadCache::Get(
+    kfsChunkId_t inChunkId,
+    kfsSeq_t     inChunkVersion,
+    int64_t      inByteCount,
+    bool&        outAdmitFlag)
+{
+    if (! mEnabledFlag) {
+        outAdmitFlag = false;
+        return DiskIo::FilePtr();
+    }
+    return mImpl.Get(inChunkId, inChunkVersion, inByteCount, outAdmitFlag);
+}
+
+    void
+ChunkReadCache::Admit(
+    kfsChunkId_t  inChunkId,
+    kfsSeq_t      inChunkVersion,
+    const string& inFileName,
+    int64_t       inFileSize)
+{
+    if (mEnabledFlag) {
+        mImpl.Admit(inChunkId, inChunkVersion, inFileName, inFileSize);
+    }
+}
+
+    bool
+ChunkReadCache::IsCacheFile(
+    const DiskIo::File* inFilePtr) const
+{
+    return (mEnabledFlag && mImpl.IsCacheFile(inFilePtr));
+}
+
+    void
+ChunkReadCache::Invalidate(
+    kfsChunkId_t inChunkId,
+    bool         inIoErrorFlag)
+{
+    if (mEnabledFlag) {
+        mImpl.Invalidate(inChunkId, inIoErrorFlag);
+    }
+}
+
+    void
+ChunkReadCache::Timeout()
+{
+    if (mEnabledFlag) {
+        mImpl.Timeout();
+    }
+}
+
+    void
+ChunkReadCache::GetCounters(
+    Counters& outCounters) const
+{
+    mImpl.GetCounters(outCounters);
+}
+
+}
@@ -0,0 +1,148 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \file ChunkReadCache.h
+// \brief Stable chunk files read cache tier.
+//
+//----------------------------------------------------------------------------
+
+#ifndef CHUNK_READ_CACHE_H
+#define CHUNK_READ_CACHE_H
+
+#include "DiskIo.h"
+#include "common/kfstypes.h"
+
+#include <string>
+#include <inttypes.h>
+
+namespace KFS
+{
+
+using std::string;
+
+class Properties;
+
+// Optional read cache tier. Stable chunk files that are read frequently,
+// according to the access frequency sketch, are copied by the cache thread
+// into the cache directory, presumably on a faster device, and subsequent
+// reads of the same chunk version are served from the copy. The cache entries
+// are keyed by chunk id and version, the chunk manager invalidates entries on
+// chunk version change and deletion. The cache directory content is discarded
+// on start.
+// Admission: the chunk access frequency must be at least the configured
+// minimum, and if the cache is full, greater than the frequency of the least
+// recently used entry that would be evicted.
+// Error backoff: a chunk whose cached copy had io error or checksum mismatch is
+// not re-admitted for the error backoff time. After the configured number of
+// consecutive errors the cache is suspended for the backoff time, doubled on
+// every subsequent suspend, until a copy completes successfully.
+class ChunkReadCache
+{
+public:
+    struct Counters
+    {
+        typedef int64_t Counter;
+
+        Counter mHitCount;
+        Counter mHitByteCount;
+        Counter mMissCount;
+        Counter mAdmitCount;
+        Counter mRejectCount;
+        Counter mEvictCount;
+        Counter mInvalidateCount;
+        Counter mCopyCount;
+        Counter mCopyByteCount;
+        Counter mCopyErrorCount;
+        Counter mReadErrorCount;
+        Counter mSuspendCount;
+        Counter mEntryCount;
+        Counter mByteCount;
+
+        void Clear()
+        {
+            mHitCount        = 0;
+            mHitByteCount    = 0;
+            mMissCount       = 0;
+            mAdmitCount      = 0;
+            mRejectCount     = 0;
+            mEvictCount      = 0;
+            mInvalidateCount = 0;
+            mCopyCount       = 0;
+            mCopyByteCount   = 0;
+            mCopyErrorCount  = 0;
+            mReadErrorCount  = 0;
+            mSuspendCount    = 0;
+            mEntryCount      = 0;
+            mByteCount       = 0;
+        }
+    };
+
+    ChunkReadCache();
+    ~ChunkReadCache();
+    void SetParameters(
+        const Properties& inProperties);
+    bool Start(
+        string* inErrMessagePtr = 0);
+    void Stop();
+    bool IsEnabled() const
+        { return mEnabledFlag; }
+    // Returns cached file, if any. Sets admit flag if the chunk file should be
+    // copied into the cache, in which case the caller is expected to invoke
+    // Admit().
+    DiskIo::FilePtr Get(
+        kfsChunkId_t inChunkId,
+        kfsSeq_t     inChunkVersion,
+        int64_t      inByteCount,
+        bool&        outAdmitFlag);
+    void Admit(
+        kfsChunkId_t  inChunkId,
+        kfsSeq_t      inChunkVersion,
+        const string& inFileName,
+        int64_t       inFileSize);
+    bool IsCacheFile(
+        const DiskIo::File* inFilePtr) const;
+    bool IsCacheFile(
+        const DiskIo* inDiskIoPtr) const
+    {
+        return (inDiskIoPtr &&
+            IsCacheFile(inDiskIoPtr->GetFilePtr().get()));
+    }
+    void Invalidate(
+        kfsChunkId_t inChunkId,
+        bool         inIoErrorFlag = false);
+    // Installs completed copies, and closes excess open cache files.
+    void Timeout();
+    void GetCounters(
+        Counters& outCounters) const;
+private:
+    class Impl;
+    Impl& mImpl;
+    bool  mEnabledFlag;
+private:
+    ChunkReadCache(
+        const ChunkReadCache& inCache);
+    ChunkReadCache& operator=(
+        const ChunkReadCache& inCache);
+};
+
+}
+
+#endif /* CHUNK_READ_CACHE_H */
@@ -49,7 +49,8 @@ public:
         bool                  ipV6OnlyFlag,
         const string&         serverIp,
         int                   threadCount,
-        int                   firstCpuIdx);
+        int                   firstCpuIdx,
+        bool                  threadAcceptFlag);
     bool MainLoop(
         const vector<string>& chunkDirs,
         const Properties&     props);
@@ -177,6 +177,7 @@ private:
 
 ClientManager::ClientManager()
     : mAcceptorPtr(0),
+      mThreadAcceptFlag(false),
       mIoTimeoutSec(5 * 60),
       mIdleTimeoutSec(10 * 60),
       mMaxClientCount(64 << 10),
@@ -204,14 +205,16 @@ ClientManager::BindAcceptor(
     bool                  ipV6OnlyFlag,
     int                   inThreadCount,
     int                   inFirstCpuIdx,
+    bool                  inThreadAcceptFlag,
     QCMutex*&             outMutexPtr)
 {
     Stop();
     delete mAcceptorPtr;
     delete [] mThreadsPtr;
-    mAcceptorPtr = 0;
-    mThreadsPtr  = 0;
-    mThreadCount = 0;
+    mAcceptorPtr      = 0;
+    mThreadsPtr       = 0;
+    mThreadCount      = 0;
+    mThreadAcceptFlag = inThreadAcceptFlag && 0 < inThreadCount;
     const bool kBindOnlyFlag = true;
     mAcceptorPtr = new Acceptor(
         globalNetManager(), clientListener, ipV6OnlyFlag, this, kBindOnlyFlag);
@@ -235,7 +238,26 @@ ClientManager::StartListening()
         return false;
     }
     mAcceptorPtr->StartListening();
-    return mAcceptorPtr->IsAcceptorStarted();
+    if (! mAcceptorPtr->IsAcceptorStarted()) {
+        return false;
+    }
+    if (mThreadAcceptFlag) {
+        // The main acceptor continues to listen, in order to ensure that the
+        // connections are accepted even if client thread acceptor fails to
+        // start. The client threads accept on the duplicates of the main
+        // acceptor socket, as binding the same port more than once would
+        // require SO_REUSEPORT, which also permits another chunk server
+        // instance to silently bind the same port.
+        for (int i = max(0, mFirstClientThreadIndex); i < mThreadCount; i++) {
+            TcpSocket* const theListenerPtr = mAcceptorPtr->DupListener();
+            if (! theListenerPtr) {
+                break;
+            }
+            mThreadsPtr[i].StartAcceptor(
+                mAcceptorPtr->GetLocation(), theListenerPtr);
+        }
+    }
+    return true;
 }
 
     void
@@ -247,6 +269,14 @@ ClientManager::Stop()
     /* virtual */ KfsCallbackObj*
 ClientManager::CreateKfsCallbackObj(
     NetConnectionPtr& inConnPtr)
+{
+    return CreateKfsCallbackObj(inConnPtr, 0);
+}
+
+    KfsCallbackObj*
+ClientManager::CreateKfsCallbackObj(
+    NetConnectionPtr& inConnPtr,
+    ClientThread*     inThreadPtr)
 {
     if (! inConnPtr || ! inConnPtr->IsGood()) {
         return 0;
@@ -263,7 +293,8 @@ ClientManager::CreateKfsCallbackObj(
     }
     mCounters.mAcceptCount++;
     mCounters.mClientCount++;
-    ClientThread* const theThreadPtr = GetNextClientThreadPtr();
+    ClientThread* const theThreadPtr =
+        inThreadPtr ? inThreadPtr : GetNextClientThreadPtr();
     ClientSM*     const theClientPtr = new ClientSM(inConnPtr, theThreadPtr);
     if (! mAuth.Setup(*inConnPtr, *theClientPtr)) {
         delete theClientPtr;
@@ -106,10 +106,15 @@ public:
         bool                  ipV6OnlyFlag,
         int                   inThreadCount,
         int                   inFirstCpuIdx,
+        bool                  inThreadAcceptFlag,
         QCMutex*&             outMutexPtr);
     bool StartListening();
     virtual KfsCallbackObj* CreateKfsCallbackObj(
         NetConnectionPtr& inConnPtr);
+    // Invoked by client thread acceptor, with the client thread mutex held.
+    KfsCallbackObj* CreateKfsCallbackObj(
+        NetConnectionPtr& inConnPtr,
+        ClientThread*     inThreadPtr);
     void GetCounters(
         Counters& outCounters) const;
     bool SetParameters(
@@ -208,6 +213,8 @@ public:
     ClientThread* GetNextClientThreadPtr();
     ClientThread* GetClientThread(
         int inIdx);
+    bool IsThreadAcceptEnabled() const
+        { return mThreadAcceptFlag; }
     bool IsAuthEnabled() const;
     bool SetParameters(
         const char*       inParamsPrefixPtr,
@@ -221,6 +228,7 @@ private:
     class Auth;
 
     Acceptor*     mAcceptorPtr;
+    bool          mThreadAcceptFlag;
     int           mIoTimeoutSec;
     int           mIdleTimeoutSec;
     int           mMaxClientCount;
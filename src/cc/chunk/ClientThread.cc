@@ -24,6 +24,7 @@
 //----------------------------------------------------------------------------
 
 #include "ClientThread.h"
+#include "ClientManager.h"
 #include "ClientSM.h"
 #include "RemoteSyncSM.h"
 #include "Replicator.h"
@@ -37,6 +38,7 @@
 #include "qcdio/qcdebug.h"
 
 #include "kfsio/NetManager.h"
+#include "kfsio/Acceptor.h"
 #include "kfsio/IOBuffer.h"
 #include "kfsio/Globals.h"
 #include "kfsio/checksum.h"
@@ -104,7 +106,8 @@ ClientThreadRemoteSyncListEntry::RemoveFromList(
 class ClientThreadImpl : public QCRunnable, public NetManager::Dispatcher
 {
 public:
-    typedef ClientThread Outer;
+    typedef ClientThread       Outer;
+    typedef Outer::Counters    Counters;
 
     static void Lock(
         Outer& inThread)
@@ -182,7 +185,12 @@ public:
           mUseOsResolverFlag(mNetManager.GetResolverOsFlag()),
           mResolverUpdateParamsFlag(false),
           mWakeupCnt(0),
-          mOuter(inOuter)
+          mOuter(inOuter),
+          mAcceptorOwner(inOuter),
+          mAcceptorPtr(0),
+          mAcceptorLocation(),
+          mAcceptorListenerPtr(0),
+          mNetConnectionCount(0)
     {
         QCASSERT(GetMutex().IsOwned());
         DispatchQueue::Init(mDispatchQueuePtr);
@@ -196,6 +204,8 @@ public:
         if (IsStarted()) {
             ClientThreadImpl::Stop();
         }
+        delete mAcceptorPtr;
+        delete mAcceptorListenerPtr;
     }
     void Add(
         ClientSM& inClient)
@@ -261,9 +271,31 @@ public:
         QCStMutexUnlocker theUnlocker(GetMutex());
         QCASSERT(! GetMutex().IsOwned());
         mThread.Join();
+        theUnlocker.Lock();
+        delete mAcceptorPtr;
+        mAcceptorPtr = 0;
+        delete mAcceptorListenerPtr;
+        mAcceptorListenerPtr = 0;
+    }
+    void StartAcceptor(
+        const ServerLocation& inLocation,
+        TcpSocket*            inListenerPtr)
+    {
+        QCASSERT(GetMutex().IsOwned());
+        delete mAcceptorListenerPtr;
+        mAcceptorLocation    = inLocation;
+        mAcceptorListenerPtr = inListenerPtr;
+        Wakeup();
+    }
+    void GetCounters(
+        Counters& outCounters) const
+    {
+        QCASSERT(GetMutex().IsOwned());
+        outCounters.mAcceptCount     = mAcceptorOwner.mAcceptCount;
+        outCounters.mConnectionCount = mNetConnectionCount;
     }
     virtual void DispatchEnd()
-        {}
+        { mNetConnectionCount = mNetManager.GetConnectionCount(); }
     virtual void DispatchExit()
         { mShutdownFlag = true; }
     virtual void DispatchStart()
@@ -281,6 +313,9 @@ public:
                 mResolverCacheSize, mResolverCacheExpiration);
             mResolverUpdateParamsFlag = false;
         }
+        if (mAcceptorListenerPtr) {
+            StartAcceptorSelf();
+        }
         ClientThreadListEntry* theAddQueuePtr[kDispatchQueueCount];
         DispatchQueue::Init(theAddQueuePtr);
         DispatchQueue::PushBackList(theAddQueuePtr, mAddQueuePtr);
@@ -529,6 +564,26 @@ public:
         ClientThread& inThread)
         { return inThread.mImpl; }
 private:
+    class AcceptorOwner : public IAcceptorOwner
+    {
+    public:
+        AcceptorOwner(
+            Outer& inOuter)
+            : IAcceptorOwner(),
+              mAcceptCount(0),
+              mOuter(inOuter)
+            {}
+        virtual KfsCallbackObj* CreateKfsCallbackObj(
+            NetConnectionPtr& inConnPtr)
+        {
+            StMutexLocker theLocker(mOuter);
+            mAcceptCount++;
+            return gClientManager.CreateKfsCallbackObj(inConnPtr, &mOuter);
+        }
+        Counters::Counter mAcceptCount;
+    private:
+        Outer& mOuter;
+    };
     typedef ClientThreadListEntry::DispatchQueue DispatchQueue;
     typedef vector<ClientSM*>                    TmpDispatchQueue;
     typedef vector<RemoteSyncSM*>                TmpSyncSMQueue;
@@ -550,6 +605,11 @@ private:
     bool                   mResolverUpdateParamsFlag;
     volatile int           mWakeupCnt;
     ClientThread&          mOuter;
+    AcceptorOwner          mAcceptorOwner;
+    Acceptor*              mAcceptorPtr;
+    ServerLocation         mAcceptorLocation;
+    TcpSocket*             mAcceptorListenerPtr;
+    volatile int           mNetConnectionCount;
     ClientThreadListEntry* mAddQueuePtr[kDispatchQueueCount];
     ClientThreadListEntry* mDispatchQueuePtr[kDispatchQueueCount];
     char                   mParseBuffer[MAX_RPC_HEADER_LEN];
@@ -557,6 +617,34 @@ private:
     static ClientThread* sCurrentClientThreadPtr;
     static int           sLockCnt;
 
+    void StartAcceptorSelf()
+    {
+        if (mShutdownFlag || ! mRunFlag) {
+            return;
+        }
+        delete mAcceptorPtr;
+        // The acceptor takes ownership of the listening socket.
+        TcpSocket* const theListenerPtr = mAcceptorListenerPtr;
+        mAcceptorListenerPtr = 0;
+        mAcceptorPtr = new Acceptor(
+            mNetManager,
+            mAcceptorLocation,
+            theListenerPtr,
+            &mAcceptorOwner
+        );
+        if (mAcceptorPtr->IsAcceptorStarted()) {
+            KFS_LOG_STREAM_INFO <<
+                "client thread acceptor started on: " << mAcceptorLocation <<
+            KFS_LOG_EOM;
+        } else {
+            KFS_LOG_STREAM_ERROR <<
+                "failed to start client thread acceptor on: " <<
+                    mAcceptorLocation <<
+            KFS_LOG_EOM;
+            delete mAcceptorPtr;
+            mAcceptorPtr = 0;
+        }
+    }
     void CheckQueueSize(
         int         inSize,
         const char* inNamePtr)
@@ -865,6 +953,21 @@ ClientThread::GetThread() const
     return mImpl.GetThread();
 }
 
+    void
+ClientThread::StartAcceptor(
+    const ServerLocation& inLocation,
+    TcpSocket*            inListenerPtr)
+{
+    mImpl.StartAcceptor(inLocation, inListenerPtr);
+}
+
+    void
+ClientThread::GetCounters(
+    Counters& outCounters) const
+{
+    mImpl.GetCounters(outCounters);
+}
+
     /* static */ const QCMutex&
 ClientThread::GetMutex()
 {
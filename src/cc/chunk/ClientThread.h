@@ -26,6 +26,10 @@
 #ifndef CLIENT_THREAD_H
 #define CLIENT_THREAD_H
 
+#include "common/kfsdecls.h"
+
+#include <inttypes.h>
+
 class QCMutex;
 class QCThread;
 
@@ -37,6 +41,7 @@ class RemoteSyncSM;
 class NetManager;
 class RemoteSyncSM;
 class RSReplicatorEntry;
+class TcpSocket;
 class Properties;
 struct KfsOp;
 
@@ -73,6 +78,20 @@ public:
             const StMutexLocker& inLocker);
     };
 
+    struct Counters
+    {
+        typedef int64_t Counter;
+
+        Counter mAcceptCount;
+        Counter mConnectionCount;
+
+        void Clear()
+        {
+            mAcceptCount     = 0;
+            mConnectionCount = 0;
+        }
+    };
+
     ClientThread();
     ~ClientThread();
     void Add(
@@ -81,6 +100,15 @@ public:
     void Lock();
     void Unlock();
     const QCThread& GetThread() const;
+    // Accept connections on the duplicate of the main acceptor listening
+    // socket in the client thread's own net manager, in parallel with the main
+    // acceptor and the acceptors of the other client threads. The thread takes
+    // ownership of the socket.
+    void StartAcceptor(
+        const ServerLocation& inLocation,
+        TcpSocket*            inListenerPtr);
+    void GetCounters(
+        Counters& outCounters) const;
     static ClientThread* GetCurrentClientThreadPtr();
     static const QCMutex& GetMutex();
     static ClientThread* CreateThreads(
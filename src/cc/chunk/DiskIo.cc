@@ -28,6 +28,7 @@
 #include "IOMethod.h"
 
 #include "kfsio/IOBuffer.h"
+#include "kfsio/IOBufferMagazineAllocator.h"
 #include "kfsio/Globals.h"
 #include "kfsio/PrngIsaac64.h"
 #include "common/Properties.h"
@@ -723,6 +724,8 @@ public:
             "chunkServer.ioBufferPool.bufferSize", 4 << 10)),
           mBufferPoolLockMemoryFlag(inConfig.getValue(
             "chunkServer.ioBufferPool.lockMemory", 0) != 0),
+          mBufferPoolMagazineSize(inConfig.getValue(
+            "chunkServer.ioBufferPool.magazineSize", 0)),
           mDiskQueueMaxQueueDepth(max(8, inConfig.getValue(
             "chunkServer.diskQueue.maxDepth",
                 max(4 << 10, (int)(int64_t(mBufferPoolPartitionCount) *
@@ -788,6 +791,8 @@ public:
             "chunkServer.diskQueue.cpuAffinity", -1)),
           mDiskQueueTraceFlag(inConfig.getValue(
             "chunkServer.diskQueue.trace", 0) != 0),
+          mMaxWriteCoalesceSize(inConfig.getValue(
+            "chunkServer.diskQueue.maxWriteCoalesceSize", 4 << 20)),
           mParameters(inConfig)
     {
         mCounters.Clear();
@@ -825,6 +830,7 @@ public:
             if (mDebugVerifyIoBuffersFlag) {
                 SetIOBufferVerifier(&mBufferAllocator);
             }
+            mBufferAllocator.SetMagazineSize(mBufferPoolMagazineSize);
             if (! SetIOBufferAllocator(&mBufferAllocator)) {
                 DiskIoReportError("failed to set buffer allocator");
                 if (inErrMessagePtr) {
@@ -864,7 +870,8 @@ public:
                     mBufferPoolPartitionCount * mBufferPoolPartitionBufferCount),
                 mMaxClientQuota,
                 mDiskOverloadedPendingWriteByteCount /
-                    mBufferAllocator.GetBufferSize()
+                    mBufferAllocator.GetBufferSize(),
+                mBufferAllocator.GetMagazineAllocator()
             );
         }
         return (! theSysError);
@@ -1142,6 +1149,8 @@ public:
             }
             return false;
         }
+        theQueuePtr->SetMaxWriteCoalesceBlockCount(
+            GetMaxWriteCoalesceBlockCount());
         return true;
     }
     DiskQueue::Time GetMaxEnqueueWaitTimeNanoSec() const
@@ -1269,7 +1278,23 @@ public:
         { return mDiskQueueThreadCount; }
     void GetCounters(
         Counters& outCounters)
-        { outCounters = mCounters; }
+    {
+        outCounters = mCounters;
+        outCounters.mWriteIssuedCount        = 0;
+        outCounters.mWriteCoalescedCount     = 0;
+        outCounters.mWriteCoalescedByteCount = 0;
+        DiskQueueList::Iterator theIt(mDiskQueuesPtr);
+        DiskQueue* thePtr;
+        while ((thePtr = theIt.Next())) {
+            QCDiskQueue::WriteCoalesceCounters theCounters;
+            thePtr->GetWriteCoalesceCounters(theCounters);
+            outCounters.mWriteIssuedCount    += theCounters.mIssuedWriteCount;
+            outCounters.mWriteCoalescedCount += theCounters.mCoalescedCount;
+            outCounters.mWriteCoalescedByteCount +=
+                theCounters.mCoalescedBlockCount * mBufferPoolBufferSize;
+        }
+        mBufferAllocator.GetMagazineCounters(outCounters);
+    }
     void SetInFlight(
         DiskIo* inIoPtr)
     {
@@ -1328,6 +1353,18 @@ public:
         }
         mMaxIoTime = max(1, inProperties.getValue(
             "chunkServer.diskIo.maxIoTimeSec", mMaxIoTime));
+        const int theMaxWriteCoalesceSize = inProperties.getValue(
+            "chunkServer.diskQueue.maxWriteCoalesceSize",
+            mMaxWriteCoalesceSize);
+        if (theMaxWriteCoalesceSize != mMaxWriteCoalesceSize) {
+            mMaxWriteCoalesceSize = theMaxWriteCoalesceSize;
+            DiskQueueList::Iterator theIt(mDiskQueuesPtr);
+            DiskQueue* thePtr;
+            while ((thePtr = theIt.Next())) {
+                thePtr->SetMaxWriteCoalesceBlockCount(
+                    GetMaxWriteCoalesceBlockCount());
+            }
+        }
         mValidateIoBuffersFlag = inProperties.getValue(
             "chunkServer.diskIo.debugValidateIoBuffers",
             mValidateIoBuffersFlag ? 1 : 0) != 0;
@@ -1434,13 +1471,17 @@ private:
         BufferAllocator()
             : IOBufferAllocator(),
               IOBufferVerifier(),
-              mBufferPool()
+              mBufferPool(),
+              mMagazineAllocatorPtr(0)
             {}
+        ~BufferAllocator()
+            { delete mMagazineAllocatorPtr; }
         virtual size_t GetBufferSize() const
             { return mBufferPool.GetBufferSize(); }
         virtual char* Allocate()
         {
-            char* const theBufPtr = mBufferPool.Get();
+            char* const theBufPtr = mMagazineAllocatorPtr ?
+                mMagazineAllocatorPtr->Allocate() : mBufferPool.Get();
             if (! theBufPtr) {
                 FatalError("out of io buffers", 0);
             }
@@ -1448,9 +1489,52 @@ private:
         }
         virtual void Deallocate(
             char* inBufferPtr)
-            { mBufferPool.Put(inBufferPtr); }
+        {
+            if (mMagazineAllocatorPtr) {
+                mMagazineAllocatorPtr->Deallocate(inBufferPtr);
+            } else {
+                mBufferPool.Put(inBufferPtr);
+            }
+        }
         QCIoBufferPool& GetBufferPool()
             { return mBufferPool; }
+        const IOBufferMagazineAllocator* GetMagazineAllocator() const
+            { return mMagazineAllocatorPtr; }
+        // Free buffer count, including the buffers cached in the magazines.
+        int GetFreeBufferCount()
+        {
+            return (mBufferPool.GetFreeBufferCount() + (mMagazineAllocatorPtr ?
+                mMagazineAllocatorPtr->GetCachedBufferCount() : 0));
+        }
+        // Must be called before the first allocation.
+        void SetMagazineSize(
+            int inSize)
+        {
+            delete mMagazineAllocatorPtr;
+            mMagazineAllocatorPtr = 0 < inSize ?
+                new IOBufferMagazineAllocator(mBufferPool, inSize) : 0;
+        }
+        void GetMagazineCounters(
+            Counters& ioCounters) const
+        {
+            if (! mMagazineAllocatorPtr) {
+                return;
+            }
+            IOBufferMagazineAllocator::Counters theCounters;
+            mMagazineAllocatorPtr->GetCounters(theCounters);
+            ioCounters.mBufMagazineCount       = theCounters.mMagazineCount;
+            ioCounters.mBufMagazineAllocCount  = theCounters.mAllocCount;
+            ioCounters.mBufMagazineHitCount    =
+                theCounters.mMagazineAllocCount;
+            ioCounters.mBufMagazineRefillCount = theCounters.mRefillCount;
+            ioCounters.mBufMagazineFlushCount  = theCounters.mFlushCount;
+            ioCounters.mBufMagazineDepotTimeUsec    =
+                theCounters.mDepotTimeUsec;
+            ioCounters.mBufMagazineDepotMaxTimeUsec =
+                theCounters.mDepotMaxTimeUsec;
+            ioCounters.mBufMagazineCachedCount =
+                theCounters.mCachedBufferCount;
+        }
         virtual void Verify(
             const IOBuffer& inBuffer,
             bool            /* inModifiedFlag */)
@@ -1485,7 +1569,8 @@ private:
             );
         }
     private:
-        QCIoBufferPool mBufferPool;
+        QCIoBufferPool             mBufferPool;
+        IOBufferMagazineAllocator* mMagazineAllocatorPtr;
 
         void SetPinnedSelf(
             const char*                    inPtr,
@@ -1525,6 +1610,7 @@ private:
     const int                      mBufferPoolPartitionBufferCount;
     const int                      mBufferPoolBufferSize;
     const int                      mBufferPoolLockMemoryFlag;
+    const int                      mBufferPoolMagazineSize;
     const int                      mDiskQueueMaxQueueDepth;
     const int                      mDiskOverloadedPendingRequestCount;
     const int                      mDiskClearOverloadedPendingRequestCount;
@@ -1564,8 +1650,14 @@ private:
     DiskErrorSimulator::Config     mDiskErrorSimulatorConfig;
     const QCDiskQueue::CpuAffinity mCpuAffinity;
     const int                      mDiskQueueTraceFlag;
+    int                            mMaxWriteCoalesceSize;
     Properties                     mParameters;
 
+    int GetMaxWriteCoalesceBlockCount() const
+    {
+        return (mMaxWriteCoalesceSize / max(1, mBufferPoolBufferSize));
+    }
+
     QCIoBufferPool& GetBufferPool()
         { return mBufferAllocator.GetBufferPool(); }
 
@@ -1631,14 +1723,14 @@ private:
             mWritePendingBytes > mDiskClearOverloadedPendingWriteByteCount ||
             theReqCount        > mDiskClearOverloadedPendingRequestCount   ||
             (mWritePendingBytes > 0 &&
-                mBufferAllocator.GetBufferPool().GetFreeBufferCount() <
+                mBufferAllocator.GetFreeBufferCount() <
                 mDiskClearOverloadedMinFreeBufferCount
             )
         :
             mWritePendingBytes > mDiskOverloadedPendingWriteByteCount ||
             theReqCount        > mDiskOverloadedPendingRequestCount   ||
             (mWritePendingBytes > 0 &&
-                mBufferAllocator.GetBufferPool().GetFreeBufferCount() <
+                mBufferAllocator.GetFreeBufferCount() <
                 mDiskOverloadedMinFreeBufferCount
             )
         );
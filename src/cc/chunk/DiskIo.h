@@ -81,6 +81,17 @@ public:
         Counter mTimedOutErrorReadByteCount;
         Counter mTimedOutErrorWriteByteCount;
         Counter mOpenFilesCount;
+        Counter mWriteIssuedCount;
+        Counter mWriteCoalescedCount;
+        Counter mWriteCoalescedByteCount;
+        Counter mBufMagazineCount;
+        Counter mBufMagazineAllocCount;
+        Counter mBufMagazineHitCount;
+        Counter mBufMagazineRefillCount;
+        Counter mBufMagazineFlushCount;
+        Counter mBufMagazineDepotTimeUsec;
+        Counter mBufMagazineDepotMaxTimeUsec;
+        Counter mBufMagazineCachedCount;
         void Clear()
         {
             mReadCount                     = 0;
@@ -106,6 +117,17 @@ public:
             mTimedOutErrorReadByteCount    = 0;
             mTimedOutErrorWriteByteCount   = 0;
             mOpenFilesCount                = 0;
+            mWriteIssuedCount              = 0;
+            mWriteCoalescedCount           = 0;
+            mWriteCoalescedByteCount       = 0;
+            mBufMagazineCount              = 0;
+            mBufMagazineAllocCount         = 0;
+            mBufMagazineHitCount           = 0;
+            mBufMagazineRefillCount        = 0;
+            mBufMagazineFlushCount         = 0;
+            mBufMagazineDepotTimeUsec      = 0;
+            mBufMagazineDepotMaxTimeUsec   = 0;
+            mBufMagazineCachedCount        = 0;
         }
     };
     typedef int64_t Offset;
@@ -38,6 +38,7 @@
 #include "utils.h"
 #include "MetaServerSM.h"
 #include "ClientManager.h"
+#include "ClientThread.h"
 
 #include "common/Version.h"
 #include "common/kfstypes.h"
@@ -932,9 +933,8 @@ ReadOp::HandleDone(int code, void* data)
             " chunk: "    << chunkId <<
             " version: "  << chunkVersion <<
         KFS_LOG_EOM;
-        if (status != -ETIMEDOUT) {
-            gChunkManager.ChunkIOFailed(
-                chunkId, chunkVersion, status, diskIo.get());
+        if (gChunkManager.ReadChunkFailed(this)) {
+            return 0; // Retry.
         }
     } else if (code == EVENT_DISK_READ) {
         if (data) {
@@ -1779,6 +1779,11 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Chunk-read-errors",         cm.mReadErrorCount);
     HBAppend(os, "Chunk-write-errors",        cm.mWriteErrorCount);
     HBAppend(os, "Chunk-open-errors",         cm.mOpenErrorCount);
+    HBAppend(os, "Chunk-open-count",          cm.mChunkOpenCount);
+    HBAppend(os, "Chunk-open-usec",           cm.mChunkOpenUsecs);
+    HBAppend(os, "Chunk-fd-cache-hit",        cm.mFdCacheHitCount);
+    HBAppend(os, "Chunk-fd-cache-miss",       cm.mFdCacheMissCount);
+    HBAppend(os, "Chunk-fd-cache-idle-sec",   cm.mFdCacheIdleSecs);
     HBAppend(os, "Dir-chunk-lost",            cm.mDirLostChunkCount);
     HBAppend(os, "Chunk-dir-lost",            cm.mChunkDirLostCount);
     HBAppend(os, "Read-chksum",               cm.mReadChecksumCount);
@@ -1789,6 +1794,23 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Read-chksum-skip-cs-bytes",
         cm.mReadSkipDiskVerifyChecksumByteCount);
 
+    ChunkReadCache::Counters rc;
+    gChunkManager.GetReadCacheCounters(rc);
+    HBAppend(os, "Read-cache-hit",           rc.mHitCount);
+    HBAppend(os, "Read-cache-hit-bytes",     rc.mHitByteCount);
+    HBAppend(os, "Read-cache-miss",          rc.mMissCount);
+    HBAppend(os, "Read-cache-admit",         rc.mAdmitCount);
+    HBAppend(os, "Read-cache-reject",        rc.mRejectCount);
+    HBAppend(os, "Read-cache-evict",         rc.mEvictCount);
+    HBAppend(os, "Read-cache-invalidate",    rc.mInvalidateCount);
+    HBAppend(os, "Read-cache-copy",          rc.mCopyCount);
+    HBAppend(os, "Read-cache-copy-bytes",    rc.mCopyByteCount);
+    HBAppend(os, "Read-cache-copy-errors",   rc.mCopyErrorCount);
+    HBAppend(os, "Read-cache-read-errors",   rc.mReadErrorCount);
+    HBAppend(os, "Read-cache-suspend",       rc.mSuspendCount);
+    HBAppend(os, "Read-cache-entries",       rc.mEntryCount);
+    HBAppend(os, "Read-cache-bytes",         rc.mByteCount);
+
     MetaServerSM::Counters mc;
     gMetaServerSM.GetCounters(mc);
     HBAppend(os, "Meta-connect",      mc.mConnectCount);
@@ -1824,6 +1846,22 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Client-over-limit",         cli.mOverClientLimitCount);
     HBAppend(os, "Client-max-count",
         gClientManager.GetMaxClientCount());
+    if (gClientManager.IsThreadAcceptEnabled()) {
+        string accepts;
+        string connections;
+        for (int i = 0; i < gClientManager.GetClientThreadCount(); i++) {
+            ClientThread::Counters ctrs;
+            gClientManager.GetClientThread(i)->GetCounters(ctrs);
+            if (0 < i) {
+                accepts     += ' ';
+                connections += ' ';
+            }
+            AppendDecIntToString(accepts,     ctrs.mAcceptCount);
+            AppendDecIntToString(connections, ctrs.mConnectionCount);
+        }
+        HBAppend(os, "Client-thread-accept",      accepts);
+        HBAppend(os, "Client-thread-connections", connections);
+    }
 
     HBAppend(os, "Timer-overrun-count",
         globalNetManager().GetTimerOverrunCount());
@@ -1869,6 +1907,7 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "WAppend-lost-chunks",          wa.mLostChunkCount);
     HBAppend(os, "WAppend-pending-bytes",        wa.mPendingByteCount);
     HBAppend(os, "WAppend-low-buf-flush",        wa.mLowOnBuffersFlushCount);
+    HBAppend(os, "WAppend-group-flush",          wa.mGroupFlushCount);
 
     const BufferManager& bufMgr = DiskIo::GetBufferManager();
     HBAppend(os, "Buffer-bytes-total",      bufMgr.GetTotalByteCount());
@@ -1896,6 +1935,19 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Buffer-req-granted-total", bmCnts.mRequestGrantedCount);
     HBAppend(os, "Buffer-req-granted-bytes", bmCnts.mRequestGrantedByteCount);
     HBAppend(os, "Buffer-req-wait-usec",     bmCnts.mRequestWaitUsecs);
+    static const char* const kBufferWaitHistogramNames[
+            BufferManager::Counters::kWaitHistogramSize] = {
+        "Buffer-req-wait-lt-100usec",
+        "Buffer-req-wait-lt-1msec",
+        "Buffer-req-wait-lt-10msec",
+        "Buffer-req-wait-lt-100msec",
+        "Buffer-req-wait-lt-1sec",
+        "Buffer-req-wait-ge-1sec"
+    };
+    for (int i = 0; i < BufferManager::Counters::kWaitHistogramSize; i++) {
+        HBAppend(os, kBufferWaitHistogramNames[i],
+            bmCnts.mRequestWaitHistogram[i]);
+    }
     HBAppend(os, "Buffer-req-denied-quota",
         bmCnts.mOverQuotaRequestDeniedCount);
     HBAppend(os, "Buffer-req-denied-quota-bytes",
@@ -1909,6 +1961,18 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Disk-write-count",          dio.mWriteCount);
     HBAppend(os, "Disk-write-bytes",          dio.mWriteByteCount);
     HBAppend(os, "Disk-write-errors",         dio.mWriteErrorCount);
+    HBAppend(os, "Disk-write-issued-count",   dio.mWriteIssuedCount);
+    HBAppend(os, "Disk-write-coalesced-count", dio.mWriteCoalescedCount);
+    HBAppend(os, "Disk-write-coalesced-bytes", dio.mWriteCoalescedByteCount);
+    HBAppend(os, "Buffer-magazine-count",     dio.mBufMagazineCount);
+    HBAppend(os, "Buffer-magazine-alloc",     dio.mBufMagazineAllocCount);
+    HBAppend(os, "Buffer-magazine-hit",       dio.mBufMagazineHitCount);
+    HBAppend(os, "Buffer-magazine-refill",    dio.mBufMagazineRefillCount);
+    HBAppend(os, "Buffer-magazine-flush",     dio.mBufMagazineFlushCount);
+    HBAppend(os, "Buffer-magazine-pool-usec", dio.mBufMagazineDepotTimeUsec);
+    HBAppend(os, "Buffer-magazine-pool-max-usec",
+        dio.mBufMagazineDepotMaxTimeUsec);
+    HBAppend(os, "Buffer-magazine-cached",    dio.mBufMagazineCachedCount);
     HBAppend(os, "Disk-sync-count",           dio.mSyncCount);
     HBAppend(os, "Disk-sync-errors",          dio.mSyncErrorCount);
     HBAppend(os, "Disk-delete-count",         dio.mDeleteCount);
@@ -1936,6 +2000,10 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Msg-log-write-errors",     msgLogCntrs.mWriteErrorCount);
     HBAppend(os, "Msg-log-wait",             msgLogCntrs.mAppendWaitCount);
     HBAppend(os, "Msg-log-waited-micro-sec", msgLogCntrs.mAppendWaitMicroSecs);
+    HBAppend(os, "Msg-log-async-count",      msgLogCntrs.mAsyncAppendCount);
+    HBAppend(os, "Msg-log-async-overflow",   msgLogCntrs.mAsyncOverflowCount);
+    HBAppend(os, "Msg-log-async-drop",       msgLogCntrs.mAsyncDroppedCount);
+    HBAppend(os, "Msg-log-async-threads",    msgLogCntrs.mAsyncThreadCount);
 
     Replicator::Counters replCntrs;
     Replicator::GetCounters(replCntrs);
@@ -1957,6 +2025,16 @@ HBAppendCounters(ostream* hbos)
     HBAppend(os, "Net-bytes-read",      globals().ctrNetBytesRead.GetValue());
     HBAppend(os, "Net-bytes-write",
         globals().ctrNetBytesWritten.GetValue());
+    HBAppend(os, "Net-ktls-send-sessions",
+        globals().ctrNetKtlsSendSessions.GetValue());
+    HBAppend(os, "Net-ktls-recv-sessions",
+        globals().ctrNetKtlsRecvSessions.GetValue());
+    HBAppend(os, "Net-ktls-fallbacks",
+        globals().ctrNetKtlsFallbacks.GetValue());
+    HBAppend(os, "Net-ktls-bytes-read",
+        globals().ctrNetKtlsBytesRead.GetValue());
+    HBAppend(os, "Net-ktls-bytes-write",
+        globals().ctrNetKtlsBytesWritten.GetValue());
     HBAppend(os, "Disk-bytes-read",     globals().ctrDiskBytesRead.GetValue());
     HBAppend(os, "Disk-bytes-write",
         globals().ctrDiskBytesWritten.GetValue());
@@ -149,6 +149,7 @@ private:
     bool           mClientListenerIpV6OnlyFlag;
     int            mClientThreadCount;
     int            mFirstCpuIndex;
+    bool           mClientThreadAcceptFlag;
     string         mChunkServerHostname;
     string         mClusterKey;
     int            mChunkServerRackId;
@@ -162,6 +163,7 @@ private:
           mClientListenerIpV6OnlyFlag(false),
           mClientThreadCount(0),
           mFirstCpuIndex(-1),
+          mClientThreadAcceptFlag(false),
           mChunkServerHostname(),
           mClusterKey(),
           mChunkServerRackId(-1),
@@ -259,8 +261,12 @@ ChunkServerMain::LoadParams(const char* fileName)
         "chunkServer.clientThreadCount", mClientThreadCount);
     mFirstCpuIndex = mProp.getValue(
         "chunkServer.clientThreadFirstCpuIndex", mFirstCpuIndex);
+    mClientThreadAcceptFlag = mProp.getValue(
+        "chunkServer.clientThreadAccept",
+        mClientThreadAcceptFlag ? 1 : 0) != 0;
     KFS_LOG_STREAM_INFO << "chunk server client thread count: " <<
         mClientThreadCount <<  " first cpu: " << mFirstCpuIndex <<
+        (mClientThreadAcceptFlag ? " thread accept" : "") <<
     KFS_LOG_EOM;
 
     mChunkServerHostname = mProp.getValue("chunkServer.hostname",
@@ -419,7 +425,8 @@ ChunkServerMain::Run(int argc, char **argv)
                 mClientListenerIpV6OnlyFlag,
                 mChunkServerHostname,
                 mClientThreadCount,
-                mFirstCpuIndex)) {
+                mFirstCpuIndex,
+                mClientThreadAcceptFlag)) {
         ret = gChunkServer.MainLoop(mChunkDirs, mProp) ? 0 : 1;
     }
     NetErrorSimulatorConfigure(globalNetManager());
@@ -26,12 +26,14 @@
 
 #include "BufferedLogWriter.h"
 #include "Properties.h"
+#include "kfsatomic.h"
 
 #include "qcdio/QCMutex.h"
 #include "qcdio/QCUtils.h"
 #include "qcdio/qcstutils.h"
 #include "qcdio/qcdebug.h"
 #include "qcdio/QCThread.h"
+#include "qcdio/QCDLList.h"
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -45,6 +47,7 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
 
 #include <vector>
 #include <string>
@@ -84,6 +87,8 @@ const int     kLogWriterMinLogBufferSize             = 16 << 10;
 const int64_t kLogWirterDefaultTimeToKeepSecs        = 60 * 60 * 24 * 30;
 const int     kLogWriterDefaulOpenFlags              =
     O_CREAT | O_APPEND | O_WRONLY /* | O_SYNC */;
+const int     kLogWriterMinThreadRingSize            = 64 << 10;
+const int64_t kLogWriterThreadRingDrainMicroSec      = 10000;
 
 class BufferedLogWriter::Impl : public QCRunnable
 {
@@ -157,8 +162,21 @@ public:
           mCpuAffinityIndex(-1),
           mMaxMsgStreamCount(256),
           mMsgStreamCount(0),
-          mMsgStreamHeadPtr(0)
+          mMsgStreamHeadPtr(0),
+          mThreadRingSize(0),
+          mThreadRingCount(0),
+          mRetiredThreadRingCount(0),
+          mThreadRingKey(),
+          mAsyncRetiredAppendCount(0),
+          mAsyncOverflowCount(0),
+          mAsyncDroppedCount(0)
     {
+        ThreadRingList::Init(mThreadRingsPtr);
+        const int theErr =
+            pthread_key_create(&mThreadRingKey, &Impl::ThreadRingExit);
+        if (theErr) {
+            QCUtils::FatalError("pthread_key_create", theErr);
+        }
         if (! mFileName.empty()) {
             mLogFileNamePrefixes.push_back(mFileName);
         }
@@ -187,6 +205,11 @@ public:
     virtual ~Impl()
     {
         Impl::Stop();
+        pthread_key_delete(mThreadRingKey);
+        ThreadRing* theRingPtr;
+        while ((theRingPtr = ThreadRingList::PopFront(mThreadRingsPtr))) {
+            delete theRingPtr;
+        }
         delete [] mBuf0Ptr;
         while (mMsgStreamHeadPtr) {
             QCASSERT(mMsgStreamCount > 0);
@@ -237,6 +260,11 @@ public:
         mCpuAffinityIndex = inProps.getValue(
             inPropsPrefix + "cpuAffinityIndex",
             mCpuAffinityIndex);
+        const int theThreadRingSize = inProps.getValue(
+            inPropsPrefix + "threadRingBufferSize",
+            mThreadRingSize);
+        mThreadRingSize = theThreadRingSize <= 0 ? 0 :
+            max(kLogWriterMinThreadRingSize, theThreadRingSize);
         string theLogFilePrefixes;
         for (LogFileNames::const_iterator theIt =
                 mLogFileNamePrefixes.begin();
@@ -453,6 +481,16 @@ public:
         outCounters.mWriteErrorCount     = mWriteErrCount;
         outCounters.mAppendWaitCount     = mBufWaitedCount;
         outCounters.mAppendWaitMicroSecs = mTotalLogWaitedTime;
+        outCounters.mAsyncAppendCount    = mAsyncRetiredAppendCount;
+        outCounters.mAsyncOverflowCount  = mAsyncOverflowCount;
+        outCounters.mAsyncDroppedCount   = mAsyncDroppedCount;
+        outCounters.mAsyncThreadCount    =
+            mThreadRingCount - mRetiredThreadRingCount;
+        ThreadRingList::Iterator theIt(mThreadRingsPtr);
+        const ThreadRing*        thePtr;
+        while ((thePtr = theIt.Next())) {
+            outCounters.mAsyncAppendCount += thePtr->GetAppendCount();
+        }
     }
     void PrepareToFork()
         { mMutex.Lock(); }
@@ -474,6 +512,7 @@ public:
             return;
         }
         QCStMutexLocker theLocker(mMutex);
+        DrainThreadRings();
         static va_list theArgs; // dummy
         AppendSelf(inLogLevel, &inWriter, 0, "", theArgs);
     }
@@ -485,23 +524,43 @@ public:
         if (! mRunFlag) {
             return;
         }
+        if (0 < mThreadRingSize) {
+            // Format on the caller's stack, and queue into the thread ring.
+            // Long messages take the synchronous path.
+            char    theBuf[1024];
+            va_list theArgs;
+            va_copy(theArgs, inArgs);
+            const int theLen = ::vsnprintf(
+                theBuf, sizeof(theBuf), inFmtStrPtr, theArgs);
+            va_end(theArgs);
+            if (0 <= theLen && theLen < (int)sizeof(theBuf) &&
+                    AsyncAppend(inLogLevel, theBuf, theLen)) {
+                return;
+            }
+        }
         QCStMutexLocker theLocker(mMutex);
+        DrainThreadRings();
         AppendSelf(inLogLevel, 0, -1, inFmtStrPtr, inArgs);
     }
     void AppendSelf(
         LogLevel    inLogLevel,
         const char* inStrPtr,
-        int         inStrLen)
+        int         inStrLen,
+        int64_t     inTime     = -1,
+        bool        inWaitFlag = true)
     {
         static va_list theArgs; // dummy
-        AppendSelf(inLogLevel, 0, max(0, inStrLen), inStrPtr, theArgs);
+        AppendSelf(inLogLevel, 0, max(0, inStrLen), inStrPtr, theArgs,
+            inTime, inWaitFlag);
     }
     void AppendSelf(
         LogLevel    inLogLevel,
         Writer*     inWriterPtr,
         int         inStrLen,
         const char* inFmtStrPtr,
-        va_list     inArgs)
+        va_list     inArgs,
+        int64_t     inTime     = -1,
+        bool        inWaitFlag = true)
     {
         mMsgAppendCount++;
 
@@ -509,9 +568,10 @@ public:
         // the log are monotonically increasing. In the case of log wait this
         // holds only in the case when thread library services the condition
         // queue in FIFO order.
-        int64_t      theSec             = 0;
-        int64_t      theMicroSec        = 0;
-        bool         theGetTimeFlag     = true;
+        // Thread ring records carry the time captured by the caller thread.
+        int64_t      theSec             = inTime < 0 ? 0 : inTime / 1000000;
+        int64_t      theMicroSec        = inTime < 0 ? 0 : inTime % 1000000;
+        bool         theGetTimeFlag     = inTime < 0;
         const bool   theWasFlushingFlag = IsFlushing();
         const size_t kAvgPrefSize       = 64;
         const int    kAvgMsgSize        = 256;
@@ -522,7 +582,7 @@ public:
         for (int i = 0; ; i++) {
             while (mCurPtr + theBufSize >= mEndPtr && ! FlushSelf()) {
                 if (theTimeWaited >= mMaxLogWaitTime || ! mRunFlag || i >= 4 ||
-                        (size_t)mBufSize < theBufSize + 1) {
+                        ! inWaitFlag || (size_t)mBufSize < theBufSize + 1) {
                     mDroppedCount++;
                     mTotalDroppedCount++;
                     theBufSize = 0;
@@ -629,15 +689,20 @@ public:
         );
         for (; ;) {
             while (mRunFlag && ! mWritePtr) {
-                const QCMutex::Time theTimeoutNanoSecs = NanoSec(max(
+                QCMutex::Time theTimeoutNanoSecs = NanoSec(max(
                     QCMutex::Time(10000),
                     (QCMutex::Time)(mFlushInterval > 0 ?
                         mFlushInterval / 2 : Time(500000))
                 ));
+                if (0 < mThreadRingCount) {
+                    theTimeoutNanoSecs = min(theTimeoutNanoSecs,
+                        NanoSec(kLogWriterThreadRingDrainMicroSec));
+                }
                 mWriteCond.Wait(mMutex, theTimeoutNanoSecs);
                 if (mWritePtr) {
                     break;
                 }
+                DrainThreadRings();
                 int64_t theSec      = 0;
                 int64_t theMicroSec = 0;
                 Now(theSec, theMicroSec);
@@ -651,8 +716,15 @@ public:
                 }
             }
             if (! mWritePtr && ! mRunFlag) {
-                QCASSERT(mBufWaitersCount <= 0);
-                break;
+                // Write out the remaining thread ring records, and the
+                // buffer that Stop() might have failed to flush due to write
+                // in flight.
+                DrainThreadRings();
+                FlushSelf();
+                if (! mWritePtr) {
+                    QCASSERT(mBufWaitersCount <= 0);
+                    break;
+                }
             }
             if (mCloseFlag && mFd >= 0 && ! mFileName.empty()) {
                 const int theFd = mFd;
@@ -810,6 +882,14 @@ public:
             return *(new MsgStream(
                 inLogLevel, inDiscardFlag, inTeeStreamPtr));
         }
+        if (0 < mThreadRingSize) {
+            ThreadRing* const theRingPtr = GetThreadRing();
+            MsgStream*        theStreamPtr;
+            if (theRingPtr && (theStreamPtr = theRingPtr->GetStream())) {
+                theStreamPtr->Clear(inLogLevel, inDiscardFlag, inTeeStreamPtr);
+                return *theStreamPtr;
+            }
+        }
         QCStMutexLocker theLocker(mMutex);
         MsgStream* theRetPtr = mMsgStreamHeadPtr;
         if (theRetPtr) {
@@ -832,8 +912,20 @@ public:
             delete &theStream;
             return;
         }
+        bool theAppendFlag = ! theStream.IsDiscard();
+        if (0 < mThreadRingSize) {
+            if (theAppendFlag && AsyncAppend(theStream.GetLogLevel(),
+                    theStream.GetMsgPtr(), theStream.GetMsgLength())) {
+                theAppendFlag = false;
+            }
+            ThreadRing* const theRingPtr = theAppendFlag ? 0 : GetThreadRing();
+            if (theRingPtr && theRingPtr->PutStream(theStream)) {
+                return;
+            }
+        }
         QCStMutexLocker theLocker(mMutex);
-        if (! theStream.IsDiscard()) {
+        if (theAppendFlag) {
+            DrainThreadRings();
             AppendSelf(theStream.GetLogLevel(),
                 theStream.GetMsgPtr(), theStream.GetMsgLength());
         }
@@ -955,6 +1047,163 @@ private:
         MsgStream& operator=(
             const MsgStream&);
     };
+    // Single producer, single consumer ring buffer of the log records. The
+    // thread that owns the ring is the producer. The consumer is the thread
+    // that holds the log writer mutex, normally the log writer thread.
+    // The record prefix -- the time stamp and log level, is formatted by the
+    // consumer.
+    class ThreadRing
+    {
+    public:
+        struct Record
+        {
+            int32_t mLength;
+            int32_t mLogLevel;
+            int64_t mTime;
+            const char* GetMsgPtr() const
+                { return reinterpret_cast<const char*>(this + 1); }
+        };
+
+        ThreadRing(
+            Impl& inImpl,
+            int   inSize)
+            : mImpl(inImpl),
+              mSize(inSize / sizeof(Record) * sizeof(Record)),
+              mBufPtr(new Record[mSize / sizeof(Record)]),
+              mHead(0),
+              mTail(0),
+              mWakeupFlag(false),
+              mRetiredFlag(false),
+              mAppendCount(0),
+              mStreamPtr(0)
+            { ThreadRingList::Init(*this); }
+        ~ThreadRing()
+        {
+            delete mStreamPtr;
+            delete [] mBufPtr;
+        }
+        bool CanFit(
+            int inLength) const
+            { return (RecordSize(inLength) <= mSize / 4); }
+        // Returns false if the ring is full. Sets outWakeupFlag if the ring
+        // became more than half full, and the consumer has to be woken up.
+        bool Push(
+            LogLevel    inLogLevel,
+            int64_t     inTime,
+            const char* inMsgPtr,
+            int         inLength,
+            bool&       outWakeupFlag)
+        {
+            const Pos theRecSize = RecordSize(inLength);
+            const Pos theTail    = mTail;
+            const Pos theHead    = SyncLoadAcquire(mHead);
+            const Pos theOffset  = theTail % mSize;
+            // Records are contiguous, skip the remainder at the end.
+            const Pos theSkip    =
+                mSize - theOffset < theRecSize ? mSize - theOffset : 0;
+            if (mSize < theTail - theHead + theSkip + theRecSize) {
+                return false;
+            }
+            if (0 < theSkip) {
+                RecordAt(theOffset).mLength = -1;
+            }
+            Record& theRec = RecordAt((theTail + theSkip) % mSize);
+            theRec.mLength   = inLength;
+            theRec.mLogLevel = inLogLevel;
+            theRec.mTime     = inTime;
+            memcpy(&theRec + 1, inMsgPtr, inLength);
+            const Pos theNewTail = theTail + theSkip + theRecSize;
+            SyncStoreRelease(mTail, theNewTail);
+            mAppendCount++;
+            outWakeupFlag = ! mWakeupFlag && mSize < (theNewTail - theHead) * 2;
+            if (outWakeupFlag) {
+                mWakeupFlag = true;
+            }
+            return true;
+        }
+        const Record* Front()
+        {
+            const Pos theTail = SyncLoadAcquire(mTail);
+            while (mHead < theTail) {
+                const Pos     theOffset = mHead % mSize;
+                const Record& theRec    = RecordAt(theOffset);
+                if (0 <= theRec.mLength) {
+                    return &theRec;
+                }
+                SyncStoreRelease(mHead, mHead + (mSize - theOffset));
+            }
+            mWakeupFlag = false;
+            return 0;
+        }
+        void PopFront(
+            const Record& inRec)
+            { SyncStoreRelease(mHead, mHead + RecordSize(inRec.mLength)); }
+        bool IsEmpty() const
+            { return (SyncLoadAcquire(mTail) == mHead); }
+        MsgStream* GetStream()
+        {
+            MsgStream* const theRetPtr = mStreamPtr;
+            mStreamPtr = 0;
+            return theRetPtr;
+        }
+        bool PutStream(
+            MsgStream& inStream)
+        {
+            if (mStreamPtr || mRetiredFlag) {
+                return false;
+            }
+            inStream.ClearTeeStreamPtr();
+            inStream.tie(0);
+            mStreamPtr = &inStream;
+            return true;
+        }
+        Count GetAppendCount() const
+            { return mAppendCount; }
+        Count Retire()
+        {
+            delete mStreamPtr;
+            mStreamPtr   = 0;
+            mRetiredFlag = true;
+            const Count theRet = mAppendCount;
+            mAppendCount = 0;
+            return theRet;
+        }
+        bool IsRetired() const
+            { return mRetiredFlag; }
+        Impl& GetImpl() const
+            { return mImpl; }
+    private:
+        typedef uint64_t Pos;
+
+        Impl&         mImpl;
+        const Pos     mSize;
+        Record* const mBufPtr;
+        volatile Pos  mHead;
+        volatile Pos  mTail;
+        volatile bool mWakeupFlag;
+        bool          mRetiredFlag;
+        Count         mAppendCount;
+        MsgStream*    mStreamPtr;
+        ThreadRing*   mPrevPtr[1];
+        ThreadRing*   mNextPtr[1];
+
+        static Pos RecordSize(
+            int inLength)
+        {
+            return ((sizeof(Record) + inLength + sizeof(Record) - 1) /
+                sizeof(Record) * sizeof(Record));
+        }
+        Record& RecordAt(
+            Pos inOffset) const
+            { return mBufPtr[inOffset / sizeof(Record)]; }
+    private:
+        ThreadRing(
+            const ThreadRing&);
+        ThreadRing& operator=(
+            const ThreadRing&);
+    friend class QCDLListOp<ThreadRing, 0>;
+    };
+    typedef QCDLList<ThreadRing, 0> ThreadRingList;
 
     QCMutex      mMutex;
     QCCondVar    mWriteCond;
@@ -1012,6 +1261,14 @@ private:
     int          mMsgStreamCount;
     MsgStream*   mMsgStreamHeadPtr;
     char         mLogTimeStampPrefixStr[256];
+    int          mThreadRingSize;
+    int          mThreadRingCount;
+    int          mRetiredThreadRingCount;
+    pthread_key_t mThreadRingKey;
+    Count        mAsyncRetiredAppendCount;
+    Count        mAsyncOverflowCount;
+    Count        mAsyncDroppedCount;
+    ThreadRing*  mThreadRingsPtr[1];
 
     static inline Time Seconds(
         Time inSec)
@@ -1021,6 +1278,144 @@ private:
         { return (inMicroSec * 1000); }
     bool IsFlushing() const
         { return (mWritePtr != 0); }
+    ThreadRing* GetThreadRing()
+    {
+        ThreadRing* thePtr = reinterpret_cast<ThreadRing*>(
+            pthread_getspecific(mThreadRingKey));
+        if (thePtr || mThreadRingSize <= 0) {
+            return thePtr;
+        }
+        QCStMutexLocker theLocker(mMutex);
+        if (! mRunFlag || mThreadRingSize <= 0) {
+            return 0;
+        }
+        thePtr = new ThreadRing(*this, mThreadRingSize);
+        if (pthread_setspecific(mThreadRingKey, thePtr)) {
+            delete thePtr;
+            return 0;
+        }
+        ThreadRingList::PushBack(mThreadRingsPtr, *thePtr);
+        mThreadRingCount++;
+        return thePtr;
+    }
+    // Returns false if the record has to be appended synchronously.
+    bool AsyncAppend(
+        LogLevel    inLogLevel,
+        const char* inMsgPtr,
+        int         inLength)
+    {
+        ThreadRing* const theRingPtr = GetThreadRing();
+        if (! theRingPtr || ! theRingPtr->CanFit(inLength)) {
+            return false;
+        }
+        const Time theTime       = Now();
+        bool       theWakeupFlag = false;
+        if (theRingPtr->Push(
+                inLogLevel, theTime, inMsgPtr, inLength, theWakeupFlag)) {
+            if (theWakeupFlag) {
+                QCStMutexLocker theLocker(mMutex);
+                mWriteCond.Notify();
+            }
+            return true;
+        }
+        // The ring is full, drain the rings with this thread, and wait for
+        // the buffer to become available the same way as synchronous
+        // append does.
+        QCStMutexLocker theLocker(mMutex);
+        mAsyncOverflowCount++;
+        Time theTimeWaited = 0;
+        for (; ;) {
+            DrainThreadRings();
+            if (theRingPtr->Push(
+                    inLogLevel, theTime, inMsgPtr, inLength, theWakeupFlag)) {
+                return true;
+            }
+            if (! mRunFlag || mMaxLogWaitTime <= theTimeWaited) {
+                break;
+            }
+            mBufWaitersCount++;
+            mWriteDoneCond.Wait(mMutex,
+                NanoSec(mMaxLogWaitTime - theTimeWaited));
+            mBufWaitersCount--;
+            theTimeWaited = Now() - theTime;
+        }
+        mAsyncDroppedCount++;
+        mDroppedCount++;
+        mTotalDroppedCount++;
+        return true;
+    }
+    // Moves the thread rings records into the log buffer in time stamp order.
+    // Returns false if the log buffer is full, and write is in flight.
+    bool DrainThreadRings()
+    {
+        QCASSERT(mMutex.IsOwned());
+        if (mThreadRingCount <= 0) {
+            return true;
+        }
+        for (; ;) {
+            ThreadRingList::Iterator  theIt(mThreadRingsPtr);
+            ThreadRing*               theMinRingPtr = 0;
+            const ThreadRing::Record* theMinRecPtr  = 0;
+            ThreadRing*               thePtr;
+            while ((thePtr = theIt.Next())) {
+                const ThreadRing::Record* const theRecPtr = thePtr->Front();
+                if (theRecPtr && (! theMinRecPtr ||
+                        theRecPtr->mTime < theMinRecPtr->mTime)) {
+                    theMinRingPtr = thePtr;
+                    theMinRecPtr  = theRecPtr;
+                }
+            }
+            if (! theMinRecPtr) {
+                break;
+            }
+            // Reserve enough space for the prefix, and the dropped records
+            // message, in order to never drop records here.
+            const size_t kMaxPrefixSize = 512;
+            const size_t theSize        = min(GetMaxRecordSize(),
+                kMaxPrefixSize + theMinRecPtr->mLength);
+            if (mBufPtr < mCurPtr && mEndPtr <= mCurPtr + theSize &&
+                    ! FlushSelf()) {
+                return false;
+            }
+            AppendSelf(LogLevel(theMinRecPtr->mLogLevel),
+                theMinRecPtr->GetMsgPtr(), theMinRecPtr->mLength,
+                theMinRecPtr->mTime, false);
+            theMinRingPtr->PopFront(*theMinRecPtr);
+        }
+        if (0 < mRetiredThreadRingCount) {
+            ThreadRing* theListPtr[1];
+            ThreadRingList::Init(theListPtr);
+            ThreadRing* thePtr;
+            while ((thePtr = ThreadRingList::PopFront(mThreadRingsPtr))) {
+                if (thePtr->IsRetired() && thePtr->IsEmpty()) {
+                    delete thePtr;
+                    mThreadRingCount--;
+                    mRetiredThreadRingCount--;
+                } else {
+                    ThreadRingList::PushBack(theListPtr, *thePtr);
+                }
+            }
+            ThreadRingList::PushBackList(mThreadRingsPtr, theListPtr);
+        }
+        return true;
+    }
+    void RetireThreadRing(
+        ThreadRing& inRing)
+    {
+        QCStMutexLocker theLocker(mMutex);
+        mAsyncRetiredAppendCount += inRing.Retire();
+        mRetiredThreadRingCount++;
+        DrainThreadRings();
+    }
+    static void ThreadRingExit(
+        void* inRingPtr)
+    {
+        if (! inRingPtr) {
+            return;
+        }
+        ThreadRing& theRing = *reinterpret_cast<ThreadRing*>(inRingPtr);
+        theRing.GetImpl().RetireThreadRing(theRing);
+    }
     bool FlushSelf()
     {
         QCASSERT(mMutex.IsOwned());
@@ -70,6 +70,11 @@ public:
         int64_t mWriteErrorCount;
         int64_t mAppendWaitCount;
         int64_t mAppendWaitMicroSecs;
+        // Per thread ring buffers counters, see threadRingBufferSize.
+        int64_t mAsyncAppendCount;
+        int64_t mAsyncOverflowCount;
+        int64_t mAsyncDroppedCount;
+        int64_t mAsyncThreadCount;
     };
     BufferedLogWriter(
         int         inFd                        = -1,
@@ -35,6 +35,7 @@
 #include <vector>
 
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -474,7 +475,211 @@ private:
 
 typedef PropertiesTokenizerT<':', '\n'> PropertiesTokenizer;
 
-template <typename TOKEN, typename VALUE, typename TOKEN2KEY>
+// Perfect hash function for the dictionary keys: "hash, displace" scheme.
+// The first level hash selects the bucket, and the second level hash plus the
+// bucket displacement selects the table slot. The displacements are selected
+// when the dictionary is defined such that each key maps into its own slot.
+// Lookup requires one key hash computation and one key comparison.
+class RequestParserPerfectHash
+{
+public:
+    typedef unsigned int Index;
+
+    RequestParserPerfectHash()
+        : mSeed(0),
+          mBucketMask(0),
+          mSlotMask(0),
+          mDisplacements(),
+          mSlots()
+        {}
+    bool IsEmpty() const
+        { return mSlots.empty(); }
+    void Clear()
+    {
+        mDisplacements.clear();
+        mSlots.clear();
+    }
+    // Returns index + 1 of the key in the array the hash was built from, or 0
+    // if the key is not in the array. The caller must compare the key.
+    template<typename K>
+    Index Find(
+        const K& inKey) const
+    {
+        const uint64_t theHash = Hash(inKey, mSeed);
+        return mSlots[(Index(theHash) +
+            mDisplacements[Index(theHash >> 32) & mBucketMask]) & mSlotMask];
+    }
+    template<typename IT>
+    bool Build(
+        IT     inBegin,
+        size_t inSize)
+    {
+        Clear();
+        if (inSize <= 0) {
+            return true;
+        }
+        const Index theSlotCnt   = Pow2(inSize * 2);
+        const Index theBucketCnt = Pow2((inSize + 1) / 2);
+        vector<uint64_t> theHashes(inSize);
+        vector<Index>    theOrder(inSize);
+        vector<Index>    theBucketSizes(theBucketCnt);
+        for (uint64_t theSeed = 1; theSeed < 256; theSeed++) {
+            mSeed       = theSeed * 0x9E3779B97F4A7C15ull;
+            mBucketMask = theBucketCnt - 1;
+            mSlotMask   = theSlotCnt - 1;
+            mDisplacements.assign(theBucketCnt, Index(0));
+            mSlots.assign(theSlotCnt, Index(0));
+            theBucketSizes.assign(theBucketCnt, Index(0));
+            IT theIt = inBegin;
+            for (size_t i = 0; i < inSize; ++i, ++theIt) {
+                theHashes[i] = Hash(theIt->first, mSeed);
+                theOrder[i]  = Index(i);
+                theBucketSizes[Index(theHashes[i] >> 32) & mBucketMask]++;
+            }
+            // Place largest buckets first.
+            std::sort(theOrder.begin(), theOrder.end(),
+                BucketOrder(theHashes, theBucketSizes, mBucketMask));
+            size_t i = 0;
+            while (i < inSize) {
+                const Index theBucket =
+                    Index(theHashes[theOrder[i]] >> 32) & mBucketMask;
+                const size_t theEnd = i + theBucketSizes[theBucket];
+                Index theDisp = 0;
+                while (theDisp < theSlotCnt &&
+                        ! Place(theHashes, theOrder, i, theEnd, theDisp)) {
+                    theDisp++;
+                }
+                if (theSlotCnt <= theDisp) {
+                    break;
+                }
+                mDisplacements[theBucket] = theDisp;
+                i = theEnd;
+            }
+            if (inSize <= i) {
+                return true;
+            }
+        }
+        Clear();
+        return false;
+    }
+private:
+    uint64_t      mSeed;
+    Index         mBucketMask;
+    Index         mSlotMask;
+    vector<Index> mDisplacements;
+    vector<Index> mSlots;
+
+    class BucketOrder
+    {
+    public:
+        BucketOrder(
+            const vector<uint64_t>& inHashes,
+            const vector<Index>&    inBucketSizes,
+            Index                   inBucketMask)
+            : mHashes(inHashes),
+              mBucketSizes(inBucketSizes),
+              mBucketMask(inBucketMask)
+            {}
+        bool operator()(
+            Index inLhs,
+            Index inRhs) const
+        {
+            const Index theLhs = Index(mHashes[inLhs] >> 32) & mBucketMask;
+            const Index theRhs = Index(mHashes[inRhs] >> 32) & mBucketMask;
+            return (mBucketSizes[theLhs] != mBucketSizes[theRhs] ?
+                mBucketSizes[theLhs] > mBucketSizes[theRhs] :
+                theLhs < theRhs);
+        }
+    private:
+        const vector<uint64_t>& mHashes;
+        const vector<Index>&    mBucketSizes;
+        Index const             mBucketMask;
+    };
+
+    bool Place(
+        const vector<uint64_t>& inHashes,
+        const vector<Index>&    inOrder,
+        size_t                  inStart,
+        size_t                  inEnd,
+        Index                   inDisp)
+    {
+        size_t i;
+        for (i = inStart; i < inEnd; i++) {
+            Index& theSlot = mSlots[
+                (Index(inHashes[inOrder[i]]) + inDisp) & mSlotMask];
+            if (theSlot != 0) {
+                break;
+            }
+            theSlot = inOrder[i] + 1;
+        }
+        if (i < inEnd) {
+            while (inStart < i) {
+                mSlots[(Index(inHashes[inOrder[--i]]) + inDisp) &
+                    mSlotMask] = 0;
+            }
+            return false;
+        }
+        return true;
+    }
+    static Index Pow2(
+        size_t inSize)
+    {
+        Index theRet = 1;
+        while (theRet < inSize) {
+            theRet <<= 1;
+        }
+        return theRet;
+    }
+    static uint64_t Mix(
+        uint64_t inVal)
+    {
+        uint64_t theVal = inVal;
+        theVal ^= theVal >> 33;
+        theVal *= 0xFF51AFD7ED558CCDull;
+        theVal ^= theVal >> 33;
+        theVal *= 0xC4CEB9FE1A85EC53ull;
+        theVal ^= theVal >> 33;
+        return theVal;
+    }
+    template<typename T>
+    static uint64_t Hash(
+        const T& inKey,
+        uint64_t inSeed)
+    {
+        // Keys are short, hash 8 bytes at a time.
+        const char* thePtr = inKey.mPtr;
+        size_t      theLen = inKey.mLen;
+        uint64_t    theVal = inSeed ^ theLen;
+        uint64_t    theWord;
+        while (sizeof(theWord) <= theLen) {
+            memcpy(&theWord, thePtr, sizeof(theWord));
+            theVal = (theVal ^ theWord) * 0x9E3779B97F4A7C15ull;
+            theVal ^= theVal >> 29;
+            thePtr += sizeof(theWord);
+            theLen -= sizeof(theWord);
+        }
+        theWord = 0;
+        for (size_t i = 0; i < theLen; i++) {
+            theWord = (theWord << 8) | (thePtr[i] & 0xFF);
+        }
+        return Mix(theVal ^ theWord);
+    }
+    static uint64_t Hash(
+        unsigned int inKey,
+        uint64_t     inSeed)
+        { return Mix(inKey ^ inSeed); }
+    static uint64_t Hash(
+        int      inKey,
+        uint64_t inSeed)
+        { return Mix((unsigned int)inKey ^ inSeed); }
+};
+
+template <
+    typename TOKEN,
+    typename VALUE,
+    typename TOKEN2KEY,
+    bool     PERFECT_HASH_FLAG = true
+>
 class RequestParserDictionaryT
 {
 private:
@@ -499,7 +704,8 @@ public:
     typedef typename Vector::iterator       iterator;
 
     RequestParserDictionaryT()
-        : mVector()
+        : mVector(),
+          mHash()
         {}
     ~RequestParserDictionaryT()
         {}
@@ -518,6 +724,11 @@ public:
             return end();
         }
         const Key theKey = Token2Key::ToKey(inToken);
+        if (PERFECT_HASH_FLAG && ! mHash.IsEmpty()) {
+            const RequestParserPerfectHash::Index theIdx = mHash.Find(theKey);
+            return ((theIdx != 0 && mVector[theIdx - 1].first == theKey) ?
+                begin() + (theIdx - 1) : end());
+        }
         const_iterator const theIt = lower_bound(begin(), end(),
             make_pair(theKey, Value()), Less());
         return ((theIt == end() || theIt->first == theKey) ? theIt : end());
@@ -529,20 +740,27 @@ public:
             return make_pair(end(), false);
         }
         const Key theKey = Token2Key::ToKey(inKv.first);
-        iterator const theIt = lower_bound(begin(), end(),
+        iterator theIt = lower_bound(begin(), end(),
             make_pair(theKey, Value()), Less());
         if (theIt != mVector.end() && theIt->first == theKey) {
             return make_pair(theIt, false);
         }
-        return make_pair(mVector.insert(
-            theIt, make_pair(theKey, inKv.second)), true);
+        theIt = mVector.insert(theIt, make_pair(theKey, inKv.second));
+        if (PERFECT_HASH_FLAG) {
+            // The dictionary is only modified when defined, rebuild the hash
+            // with every insert in order to keep find() const and lock free.
+            // The lookup falls back to binary search if build fails.
+            mHash.Build(mVector.begin(), mVector.size());
+        }
+        return make_pair(theIt, true);
     }
     static Token GetName(
             Key        inKey,
             ScratchBuf inBuf)
         { return Token2Key::ToName(inKey, inBuf); }
 private:
-    Vector mVector;
+    Vector                   mVector;
+    RequestParserPerfectHash mHash;
 };
 
 template<typename TOKEN>
@@ -51,7 +51,11 @@ public:
         : mCurBucket(0),
           mNextRunTime(inNextRunTime),
           mTmpList()
-        {}
+    {
+        for (size_t i = 0; i < kBitmapSize; i++) {
+            mBitmap[i] = 0;
+        }
+    }
     void Schedule(
         T&    inEntry,
         TimeT inExpires)
@@ -69,12 +73,39 @@ public:
             theIdx -= BucketCntT;
         }
         ListT::Insert(inEntry, mBuckets[theIdx]);
+        mBitmap[theIdx / kBitsPerWord] |= size_t(1) << (theIdx % kBitsPerWord);
     }
     void SetNextRunTime(
         TimeT inNextRunTime)
         { mNextRunTime = inNextRunTime; }
     TimeT GetNextRunTime() const
         { return mNextRunTime; }
+    // Returns the time when Run() will traverse the first non empty bucket, or
+    // inMaxTime if no such bucket exists with the traversal time less than
+    // inMaxTime. Both the current and the next buckets are traversed at the
+    // next run time. Intended to be used to compute poll / sleep timeout.
+    // The non empty buckets are tracked with bitmap, set by Schedule() and
+    // cleared by Run(). As the entries are removed from the buckets directly
+    // with ListT::Remove(), the bits of the buckets that become empty this way
+    // are cleared here, therefore the cost is amortized O(1), with the bitmap
+    // traversal bounded by BucketCntT / (sizeof(size_t) * 8) words.
+    TimeT GetNextExpirationTime(
+        TimeT inMaxTime)
+    {
+        size_t theIdx;
+        while ((theIdx = FindNextBucket()) < BucketCntT) {
+            if (ListT::IsInList(mBuckets[theIdx])) {
+                const size_t theDist = mCurBucket <= theIdx ?
+                    theIdx - mCurBucket : theIdx + BucketCntT - mCurBucket;
+                const TimeT  theTime = mNextRunTime +
+                    TimeT(theDist <= 0 ? 0 : theDist - 1) * TimerResolutionT;
+                return (theTime < inMaxTime ? theTime : inMaxTime);
+            }
+            mBitmap[theIdx / kBitsPerWord] &=
+                ~(size_t(1) << (theIdx % kBitsPerWord));
+        }
+        return inMaxTime;
+    }
     template<typename FT>
     void Run(
         TimeT inNow,
@@ -97,6 +128,8 @@ public:
         do {
             ListT::Insert(mTmpList, mBuckets[mCurBucket]);
             ListT::Remove(mBuckets[mCurBucket]);
+            mBitmap[mCurBucket / kBitsPerWord] &=
+                ~(size_t(1) << (mCurBucket % kBitsPerWord));
             if (0 < theBucketCnt && BucketCntT <= ++mCurBucket) {
                 mCurBucket = 0;
             }
@@ -119,10 +152,55 @@ public:
         FT& inFunctor)
         { ApplySelf(inFunctor, &mTmpList); }
 private:
+    enum
+    {
+        kBitsPerWord = sizeof(size_t) * 8,
+        kBitmapSize  = (BucketCntT + kBitsPerWord - 1) / kBitsPerWord
+    };
     size_t mCurBucket;
     TimeT  mNextRunTime;
     T      mTmpList;
     T      mBuckets[BucketCntT];
+    size_t mBitmap[kBitmapSize];
+
+    static size_t LowestBit(
+        size_t inWord)
+    {
+        size_t theRet = 0;
+        for (size_t theShift = kBitsPerWord / 2; 0 < theShift; theShift /= 2) {
+            const size_t theMask = (size_t(1) << theShift) - 1;
+            if ((inWord & theMask) == 0) {
+                inWord >>= theShift;
+                theRet  += theShift;
+            }
+        }
+        return theRet;
+    }
+    // Returns the index of the first bucket with the bit set, starting from
+    // the current bucket in the traversal order, or BucketCntT if none.
+    size_t FindNextBucket() const
+    {
+        const size_t theStart = mCurBucket / kBitsPerWord;
+        size_t       theWord  = mBitmap[theStart] &
+            ~((size_t(1) << (mCurBucket % kBitsPerWord)) - 1);
+        for (size_t i = 0, k = theStart; ; ) {
+            if (theWord != 0) {
+                return (k * kBitsPerWord + LowestBit(theWord));
+            }
+            if (kBitmapSize <= ++i) {
+                break;
+            }
+            if (kBitmapSize <= ++k) {
+                k = 0;
+            }
+            theWord = mBitmap[k];
+        }
+        // Wrap around: the buckets preceding the current one in its word.
+        theWord = mBitmap[theStart] &
+            ((size_t(1) << (mCurBucket % kBitsPerWord)) - 1);
+        return (theWord == 0 ? BucketCntT :
+            theStart * kBitsPerWord + LowestBit(theWord));
+    }
 
     template<typename FT, typename ET>
     void ApplySelf(
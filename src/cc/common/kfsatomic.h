@@ -54,6 +54,21 @@ template<typename T> T SyncAddAndFetch(volatile T& val, T inc)
     return ret;
 }
 
+template<typename T> T SyncLoadAcquire(const volatile T& val)
+{
+    atomicmpl::AtomicLock();
+    const T ret = val;
+    atomicmpl::AtomicUnlock();
+    return ret;
+}
+
+template<typename T> void SyncStoreRelease(volatile T& val, T newVal)
+{
+    atomicmpl::AtomicLock();
+    val = newVal;
+    atomicmpl::AtomicUnlock();
+}
+
 #else
 
 template<typename T> T SyncAddAndFetch(volatile T& val, T inc)
@@ -61,6 +76,21 @@ template<typename T> T SyncAddAndFetch(volatile T& val, T inc)
     return __sync_add_and_fetch(&val, inc);
 }
 
+// Single producer single consumer hand off: the store makes all preceding
+// writes visible to the thread that observes the stored value with the load.
+template<typename T> T SyncLoadAcquire(const volatile T& val)
+{
+    const T ret = val;
+    __sync_synchronize();
+    return ret;
+}
+
+template<typename T> void SyncStoreRelease(volatile T& val, T newVal)
+{
+    __sync_synchronize();
+    val = newVal;
+}
+
 #endif /* _KFS_ATOMIC_USE_MUTEX */
 }
 
@@ -0,0 +1,207 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief Client library lock contention benchmark. Multiple threads share
+// single client instance, each thread works on its own file, and issues stat
+// and small read calls in a loop.
+//
+//----------------------------------------------------------------------------
+
+#include "libclient/KfsClient.h"
+#include "common/Properties.h"
+#include "common/kfsatomic.h"
+#include "qcdio/QCThread.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+using namespace KFS;
+
+static volatile int sStopFlag = 0;
+
+class Worker : public QCRunnable
+{
+public:
+    Worker(
+        KfsClient&    inClient,
+        const string& inPath,
+        int           inReadSize)
+        : mClient(inClient),
+          mPath(inPath),
+          mReadSize(inReadSize),
+          mOpCount(0),
+          mErrorCount(0),
+          mThread()
+        {}
+    int Create()
+    {
+        const int theFd = mClient.Create(mPath.c_str());
+        if (theFd < 0) {
+            return theFd;
+        }
+        vector<char> theBuf(mReadSize, 'x');
+        const ssize_t theRet = mClient.Write(theFd, &theBuf[0], theBuf.size());
+        mClient.Close(theFd);
+        return (theRet < 0 ? (int)theRet : 0);
+    }
+    void Start()
+        { mThread.Start(this); }
+    void Join()
+        { mThread.Join(); }
+    virtual void Run()
+    {
+        const int theFd = mClient.Open(mPath.c_str(), O_RDONLY);
+        if (theFd < 0) {
+            cerr << mPath << ": " << ErrorCodeToStr(theFd) << "\n";
+            mErrorCount++;
+            return;
+        }
+        vector<char> theBuf(mReadSize);
+        KfsFileAttr  theAttr;
+        while (! SyncLoadAcquire(sStopFlag)) {
+            if (mClient.Stat(mPath.c_str(), theAttr) != 0 ||
+                    mClient.PRead(theFd, 0, &theBuf[0], theBuf.size()) < 0) {
+                mErrorCount++;
+            }
+            mOpCount += 2;
+        }
+        mClient.Close(theFd);
+    }
+    int64_t GetOpCount() const
+        { return mOpCount; }
+    int64_t GetErrorCount() const
+        { return mErrorCount; }
+private:
+    KfsClient&   mClient;
+    const string mPath;
+    const int    mReadSize;
+    int64_t      mOpCount;
+    int64_t      mErrorCount;
+    QCThread     mThread;
+};
+
+int
+main(int argc, char** argv)
+{
+    string      host;
+    int         port         = -1;
+    string      dir          = "/clientcontention";
+    int         threadCount  = 8;
+    int         seconds      = 10;
+    int         readSize     = 4 << 10;
+    bool        statCache    = true;
+    bool        help         = false;
+    int         optchar;
+
+    while ((optchar = getopt(argc, argv, "s:p:d:t:n:r:c:h")) != -1) {
+        switch (optchar) {
+            case 's': host        = optarg;       break;
+            case 'p': port        = atoi(optarg); break;
+            case 'd': dir         = optarg;       break;
+            case 't': threadCount = atoi(optarg); break;
+            case 'n': seconds     = atoi(optarg); break;
+            case 'r': readSize    = atoi(optarg); break;
+            case 'c': statCache   = atoi(optarg) != 0; break;
+            default:
+                help = true;
+                break;
+        }
+    }
+    if (help || host.empty() || port <= 0 || threadCount <= 0 ||
+            readSize <= 0 || dir.empty() || dir[0] != '/') {
+        cout << "Usage: " << argv[0] <<
+            " -s <meta server host> -p <port>\n"
+            " [-d <absolute test directory path>]"
+                " default: " << dir << "\n"
+            " [-t <thread count>] default: " << threadCount << "\n"
+            " [-n <test duration seconds>] default: " << seconds << "\n"
+            " [-r <read size>] default: " << readSize << "\n"
+            " [-c <use stat cache 0|1>] default: " << statCache << "\n"
+        ;
+        return 1;
+    }
+    Properties props;
+    props.setValue("client.statCache", statCache ? "1" : "0");
+    KfsClient* const client = Connect(host, port, &props);
+    if (! client) {
+        cerr << "failed to connect to " << host << ":" << port << "\n";
+        return 1;
+    }
+    int status = client->Mkdirs(dir.c_str());
+    if (status < 0) {
+        cerr << dir << ": " << ErrorCodeToStr(status) << "\n";
+        delete client;
+        return 1;
+    }
+    vector<Worker*> workers;
+    for (int i = 0; i < threadCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "/f%d", i);
+        Worker* const worker = new Worker(*client, dir + name, readSize);
+        if ((status = worker->Create()) < 0) {
+            cerr << dir << name << ": " << ErrorCodeToStr(status) << "\n";
+            delete worker;
+            break;
+        }
+        workers.push_back(worker);
+    }
+    if (0 <= status) {
+        const time_t start = time(0);
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->Start();
+        }
+        sleep(seconds);
+        SyncStoreRelease(sStopFlag, 1);
+        int64_t ops    = 0;
+        int64_t errors = 0;
+        for (size_t i = 0; i < workers.size(); i++) {
+            workers[i]->Join();
+            ops    += workers[i]->GetOpCount();
+            errors += workers[i]->GetErrorCount();
+        }
+        const double elapsed = (double)(time(0) - start);
+        cout <<
+            "threads: "    << threadCount <<
+            " stat cache: " << statCache <<
+            " ops: "       << ops <<
+            " errors: "    << errors <<
+            " ops/sec: "   << (elapsed > 0 ? ops / elapsed : 0.) <<
+        "\n";
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        delete workers[i];
+    }
+    client->Rmdirs(dir.c_str());
+    delete client;
+    return (status < 0 ? 1 : 0);
+}
@@ -0,0 +1,275 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief IOBuffer unit and performance tests.
+//
+//----------------------------------------------------------------------------
+
+#include "kfsio/IOBuffer.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+using namespace KFS;
+using std::cout;
+using std::cerr;
+using std::string;
+
+static string
+ToString(const IOBuffer& buf)
+{
+    string ret;
+    IOBuffer::ByteIterator it(buf);
+    const char*            p;
+    while ((p = it.Next())) {
+        ret.push_back(*p);
+    }
+    return ret;
+}
+
+static void
+Check(const IOBuffer& buf, const string& model, const char* op, int iter)
+{
+    buf.Verify();
+    if (buf.BytesConsumable() != (int)model.size() || ToString(buf) != model) {
+        cerr << "mismatch: " << op << " iteration: " << iter <<
+            " size: " << buf.BytesConsumable() <<
+            " expected: " << model.size() << "\n";
+        abort();
+    }
+}
+
+// Random operations cross checked against std::string model.
+static void
+UnitTest(int iterations)
+{
+    const int kMaxLen = 3 * IOBufferData::GetDefaultBufferSize();
+    char*     data    = new char[kMaxLen];
+    for (int i = 0; i < kMaxLen; i++) {
+        data[i] = (char)('a' + i % 26);
+    }
+    IOBuffer bufs[3];
+    string   models[3];
+    for (int i = 0; i < iterations; i++) {
+        const int k   = rand() % 3;
+        const int o   = (k + 1 + rand() % 2) % 3;
+        const int len = rand() % kMaxLen;
+        const int sz  = (int)models[k].size();
+        const int pos = sz <= 0 ? 0 : rand() % sz;
+        const char* op = "";
+        switch (rand() % 9) {
+            case 0: {
+                op = "CopyIn";
+                const char* const p = data + rand() % (kMaxLen / 2);
+                const int         n = bufs[k].CopyIn(p, len / 2);
+                models[k].append(p, n);
+                break;
+            }
+            case 1: {
+                op = "Move";
+                const int n = bufs[k].Move(&bufs[o], len);
+                models[k].append(models[o], 0, n);
+                models[o].erase(0, n);
+                Check(bufs[o], models[o], op, i);
+                break;
+            }
+            case 2:
+                op = "MoveAll";
+                bufs[k].Move(&bufs[o]);
+                models[k] += models[o];
+                models[o].clear();
+                Check(bufs[o], models[o], op, i);
+                break;
+            case 3: {
+                // Copy shares buffers, and Replace modifies buffers in place,
+                // therefore do not keep the copy.
+                op = "Copy";
+                IOBuffer  copy;
+                const int n = copy.Copy(&bufs[o], len);
+                Check(copy, models[o].substr(0, n), op, i);
+                copy.Consume(len / 2);
+                copy.Clear();
+                Check(bufs[o], models[o], op, i);
+                break;
+            }
+            case 4: {
+                op = "Consume";
+                const int n = bufs[k].Consume(len);
+                models[k].erase(0, n);
+                break;
+            }
+            case 5: {
+                op = "Trim";
+                const int n = bufs[k].Trim(pos);
+                models[k].erase(n);
+                break;
+            }
+            case 6: {
+                op = "Replace";
+                const int n = std::min(len, (int)models[o].size());
+                string    m = models[k];
+                if ((int)m.size() < pos) {
+                    m.resize(pos, 0);
+                }
+                m.replace(pos, std::min(n, (int)m.size() - pos),
+                    models[o], 0, n);
+                bufs[k].Replace(&bufs[o], pos, n);
+                models[k] = m;
+                models[o].erase(0, n);
+                Check(bufs[o], models[o], op, i);
+                break;
+            }
+            case 7:
+                op = "MakeBuffersFull";
+                bufs[k].MakeBuffersFull();
+                break;
+            default: {
+                op = "WOStream";
+                IOBuffer::WOStream stream;
+                stream.Set(bufs[k]) << "seq: " << i << "\r\n";
+                stream.flush();
+                stream.Reset();
+                char tmp[64];
+                models[k].append(tmp,
+                    snprintf(tmp, sizeof(tmp), "seq: %d\r\n", i));
+                break;
+            }
+        }
+        Check(bufs[k], models[k], op, i);
+        if (kMaxLen * 8 < (int)models[k].size()) {
+            bufs[k].Clear();
+            models[k].clear();
+        }
+    }
+    delete [] data;
+    cout << "unit test: " << iterations << " iterations passed\n";
+}
+
+static void
+Report(const char* name, clock_t start, int count)
+{
+    const double t = double(clock() - start) / CLOCKS_PER_SEC;
+    cout << name << ": " << t << " sec " <<
+        (t > 0 ? count / t : 0.) << " ops/sec\n";
+}
+
+// Common rpc operations: small messages with 1 to 3 buffers.
+static void
+PerfTest(int count)
+{
+    const int  kMsgLen = 200;
+    char       msg[kMsgLen];
+    for (int i = 0; i < kMsgLen; i++) {
+        msg[i] = (char)('A' + i % 26);
+    }
+    int64_t   total = 0;
+    clock_t   start = clock();
+    for (int i = 0; i < count; i++) {
+        IOBuffer buf;
+        buf.CopyIn(msg, kMsgLen);
+        total += buf.BytesConsumable();
+    }
+    Report("small CopyIn", start, count);
+
+    IOBuffer::WOStream stream;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        IOBuffer buf;
+        stream.Set(buf) <<
+            "OK\r\n"
+            "Cseq: "          << i << "\r\n"
+            "Status: "        << 0 << "\r\n"
+            "Content-length: " << kMsgLen << "\r\n"
+        "\r\n";
+        stream.flush();
+        stream.Reset();
+        total += buf.BytesConsumable();
+    }
+    Report("WOStream response header", start, count);
+
+    const int kBufSize = IOBufferData::GetDefaultBufferSize();
+    IOBuffer  src;
+    for (int i = 0; i < 3; i++) {
+        IOBufferData data;
+        data.Fill(kBufSize / 2);
+        src.Append(data);
+    }
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        IOBuffer in;
+        in.Copy(&src, src.BytesConsumable());
+        IOBuffer out;
+        out.Move(&in);
+        total += out.BytesConsumable();
+        out.Consume(kBufSize / 4);
+        total += out.BytesConsumable();
+    }
+    Report("3 buffers Copy Move Consume", start, count);
+
+    start = clock();
+    int64_t sum = 0;
+    for (int i = 0; i < count / 100; i++) {
+        IOBuffer::ByteIterator it(src);
+        const char*            p;
+        while ((p = it.Next())) {
+            sum += *p;
+        }
+    }
+    Report("ByteIterator", start, count / 100);
+
+    IOBuffer large;
+    for (int i = 0; i < 64; i++) {
+        IOBufferData data;
+        data.Fill(kBufSize);
+        large.Append(data);
+    }
+    start = clock();
+    for (int i = 0; i < count / 16; i++) {
+        IOBuffer buf;
+        buf.Copy(&large, large.BytesConsumable());
+        IOBuffer tmp;
+        tmp.Move(&buf, buf.BytesConsumable() / 2 + 1);
+        buf.Move(&tmp);
+        IOBuffer rep;
+        rep.Copy(&large, kBufSize * 2);
+        buf.Replace(&rep, kBufSize * 8 + 3, rep.BytesConsumable());
+        total += buf.BytesConsumable();
+    }
+    Report("64 buffers Copy Move Replace", start, count / 16);
+    cout << "total: " << total << " sum: " << sum << "\n";
+}
+
+int
+main(int argc, char** argv)
+{
+    const int count = argc > 1 ? (int)atof(argv[1]) : 1000000;
+    const int iters = argc > 2 ? (int)atof(argv[2]) : 100000;
+    srand(argc > 3 ? atoi(argv[3]) : 1);
+    UnitTest(iters);
+    PerfTest(count);
+    return 0;
+}
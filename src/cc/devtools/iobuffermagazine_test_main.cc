@@ -0,0 +1,470 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief Io buffer magazine allocator unit test.
+//
+//----------------------------------------------------------------------------
+
+#include "kfsio/IOBufferMagazineAllocator.h"
+#include "qcdio/QCIoBufferPool.h"
+#include "qcdio/QCMutex.h"
+#include "qcdio/QCThread.h"
+#include "qcdio/qcstutils.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <vector>
+
+namespace KFS
+{
+using std::cerr;
+using std::vector;
+
+const int kBufferSize     = 4 << 10;
+const int kPartitionCount = 2;
+const int kPartitionBufs  = 256;
+const int kTotalBufs      = kPartitionCount * kPartitionBufs;
+const int kMagazineSize   = 16;
+const int kThreadCount    = 8;
+
+static int
+GetFreeCount(
+    QCIoBufferPool&            inPool,
+    IOBufferMagazineAllocator& inAllocator)
+{
+    return (inPool.GetFreeBufferCount() + inAllocator.GetCachedBufferCount());
+}
+
+// Each thread tags the buffers it owns with its id and buffer sequence number,
+// and verifies the tag before freeing the buffer. A buffer handed out to more
+// than one thread at a time will have its tag overwritten. At the end of the
+// run all threads hold buffers and wait for the main thread to verify that
+// the buffers held, plus the pool and magazines free counts add up to the
+// total.
+class AllocThread : public QCRunnable
+{
+public:
+    AllocThread()
+        : QCRunnable(),
+          mThread(),
+          mId(0),
+          mAllocatorPtr(0),
+          mMutexPtr(0),
+          mCondPtr(0),
+          mHeldCountPtr(0),
+          mDoneCountPtr(0),
+          mReleaseFlagPtr(0),
+          mBufs(),
+          mSeq(0),
+          mRandSeed(0),
+          mErrCnt(0)
+        {}
+    void Start(
+        int                        inId,
+        IOBufferMagazineAllocator& inAllocator,
+        QCMutex&                   inMutex,
+        QCCondVar&                 inCond,
+        int&                       inHeldCount,
+        int&                       inDoneCount,
+        const bool&                inReleaseFlag)
+    {
+        mId             = inId;
+        mRandSeed       = inId + 1;
+        mAllocatorPtr   = &inAllocator;
+        mMutexPtr       = &inMutex;
+        mCondPtr        = &inCond;
+        mHeldCountPtr   = &inHeldCount;
+        mDoneCountPtr   = &inDoneCount;
+        mReleaseFlagPtr = &inReleaseFlag;
+        mThread.Start(this);
+    }
+    void Join()
+        { mThread.Join(); }
+    virtual void Run()
+    {
+        const int kMaxHeld = kTotalBufs / kThreadCount / 2;
+        for (int i = 0; i < 200000; i++) {
+            if (mBufs.empty() ||
+                    ((int)mBufs.size() < kMaxHeld && Rand(2) == 0)) {
+                Allocate();
+            } else {
+                const size_t theIdx = Rand(mBufs.size());
+                Free(theIdx);
+            }
+        }
+        QCStMutexLocker theLocker(*mMutexPtr);
+        *mHeldCountPtr += (int)mBufs.size();
+        (*mDoneCountPtr)++;
+        mCondPtr->NotifyAll();
+        while (! *mReleaseFlagPtr) {
+            mCondPtr->Wait(*mMutexPtr);
+        }
+        theLocker.Unlock();
+        while (! mBufs.empty()) {
+            Free(mBufs.size() - 1);
+        }
+    }
+    int GetErrorCount() const
+        { return mErrCnt; }
+private:
+    struct Tag
+    {
+        int      mId;
+        uint32_t mSeq;
+    };
+    QCThread                   mThread;
+    int                        mId;
+    IOBufferMagazineAllocator* mAllocatorPtr;
+    QCMutex*                   mMutexPtr;
+    QCCondVar*                 mCondPtr;
+    int*                       mHeldCountPtr;
+    int*                       mDoneCountPtr;
+    const bool*                mReleaseFlagPtr;
+    vector<char*>              mBufs;
+    uint32_t                   mSeq;
+    uint32_t                   mRandSeed;
+    int                        mErrCnt;
+
+    uint32_t Rand(
+        uint32_t inMax)
+    {
+        mRandSeed = mRandSeed * 1103515245 + 12345;
+        return ((mRandSeed >> 8) % inMax);
+    }
+    void Allocate()
+    {
+        char* const theBufPtr = mAllocatorPtr->Allocate();
+        if (! theBufPtr) {
+            cerr << "thread: " << mId << " allocation failure\n";
+            mErrCnt++;
+            return;
+        }
+        Tag theTag;
+        theTag.mId  = mId;
+        theTag.mSeq = ++mSeq;
+        memcpy(theBufPtr, &theTag, sizeof(theTag));
+        memcpy(theBufPtr + kBufferSize - sizeof(theTag),
+            &theTag, sizeof(theTag));
+        mBufs.push_back(theBufPtr);
+    }
+    void Free(
+        size_t inIdx)
+    {
+        char* const theBufPtr = mBufs[inIdx];
+        Tag theHead;
+        Tag theTail;
+        memcpy(&theHead, theBufPtr, sizeof(theHead));
+        memcpy(&theTail, theBufPtr + kBufferSize - sizeof(theTail),
+            sizeof(theTail));
+        if (theHead.mId != mId || theTail.mId != mId ||
+                theHead.mSeq != theTail.mSeq) {
+            cerr << "thread: " << mId << " buffer tag mismatch: " <<
+                theHead.mId << "/" << theHead.mSeq << " " <<
+                theTail.mId << "/" << theTail.mSeq << "\n";
+            mErrCnt++;
+        }
+        memset(theBufPtr, 0xFF, sizeof(Tag));
+        mAllocatorPtr->Deallocate(theBufPtr);
+        mBufs[inIdx] = mBufs.back();
+        mBufs.pop_back();
+    }
+private:
+    AllocThread(
+        const AllocThread& inThread);
+    AllocThread& operator=(
+        const AllocThread& inThread);
+};
+
+static int
+TestConcurrentAlloc(
+    QCIoBufferPool&            inPool,
+    IOBufferMagazineAllocator& inAllocator)
+{
+    QCMutex     theMutex;
+    QCCondVar   theCond;
+    int         theHeldCount   = 0;
+    int         theDoneCount   = 0;
+    bool        theReleaseFlag = false;
+    AllocThread theThreads[kThreadCount];
+    for (int i = 0; i < kThreadCount; i++) {
+        theThreads[i].Start(i, inAllocator, theMutex, theCond,
+            theHeldCount, theDoneCount, theReleaseFlag);
+    }
+    // Once all threads reported, the threads are blocked on the condition,
+    // and the free counts must add up exactly.
+    int theErrCnt = 0;
+    QCStMutexLocker theLocker(theMutex);
+    while (theDoneCount < kThreadCount) {
+        theCond.Wait(theMutex);
+    }
+    const int theFreeCount = GetFreeCount(inPool, inAllocator);
+    if (theFreeCount + theHeldCount != kTotalBufs) {
+        cerr << "buffer count mismatch: free: " << theFreeCount <<
+            " pool: " << inPool.GetFreeBufferCount() <<
+            " held: " << theHeldCount << " total: " << kTotalBufs << "\n";
+        theErrCnt++;
+    }
+    IOBufferMagazineAllocator::Counters theCounters;
+    inAllocator.GetCounters(theCounters);
+    if (theCounters.mMagazineCount != kThreadCount ||
+            theCounters.mMagazineAllocCount <= 0 ||
+            theCounters.mCachedBufferCount !=
+                inAllocator.GetCachedBufferCount()) {
+        cerr << "invalid counters: magazines: " <<
+            theCounters.mMagazineCount <<
+            " hits: " << theCounters.mMagazineAllocCount <<
+            " cached: " << theCounters.mCachedBufferCount << "\n";
+        theErrCnt++;
+    }
+    theReleaseFlag = true;
+    theCond.NotifyAll();
+    theLocker.Unlock();
+    for (int i = 0; i < kThreadCount; i++) {
+        theThreads[i].Join();
+        theErrCnt += theThreads[i].GetErrorCount();
+    }
+    // The exiting threads must return the cached buffers to the pool.
+    if (inPool.GetFreeBufferCount() != kTotalBufs ||
+            inAllocator.GetCachedBufferCount() != 0) {
+        cerr << "buffers leaked after thread exit: pool free: " <<
+            inPool.GetFreeBufferCount() <<
+            " cached: " << inAllocator.GetCachedBufferCount() << "\n";
+        theErrCnt++;
+    }
+    inAllocator.GetCounters(theCounters);
+    if (theCounters.mMagazineCount != 0) {
+        cerr << "owned magazines after thread exit: " <<
+            theCounters.mMagazineCount << "\n";
+        theErrCnt++;
+    }
+    return theErrCnt;
+}
+
+// The magazine cached buffers are returned to the pool by the owner thread on
+// its next allocation or de-allocation after flush request.
+class FlushThread : public QCRunnable
+{
+public:
+    FlushThread(
+        IOBufferMagazineAllocator& inAllocator)
+        : QCRunnable(),
+          mAllocator(inAllocator),
+          mThread(),
+          mMutex(),
+          mCond(),
+          mStep(0),
+          mDoneStep(0)
+        {}
+    void Start()
+        { mThread.Start(this); }
+    void Join()
+        { mThread.Join(); }
+    void RunStep()
+    {
+        QCStMutexLocker theLocker(mMutex);
+        mStep++;
+        mCond.NotifyAll();
+        while (mDoneStep < mStep) {
+            mCond.Wait(mMutex);
+        }
+    }
+    virtual void Run()
+    {
+        vector<char*> theBufs;
+        for (int theStep = 1; theStep <= 3; theStep++) {
+            QCStMutexLocker theLocker(mMutex);
+            while (mStep < theStep) {
+                mCond.Wait(mMutex);
+            }
+            theLocker.Unlock();
+            switch (theStep) {
+                case 1:
+                    // Fill up the magazine, and keep one buffer.
+                    for (int i = 0; i < kMagazineSize; i++) {
+                        theBufs.push_back(mAllocator.Allocate());
+                    }
+                    while (1 < theBufs.size()) {
+                        mAllocator.Deallocate(theBufs.back());
+                        theBufs.pop_back();
+                    }
+                    break;
+                case 2:
+                    // Flush request must be processed prior to de-allocation.
+                    mAllocator.Deallocate(theBufs.back());
+                    theBufs.pop_back();
+                    break;
+                default:
+                    break;
+            }
+            QCStMutexLocker theDoneLocker(mMutex);
+            mDoneStep = theStep;
+            mCond.NotifyAll();
+        }
+    }
+private:
+    IOBufferMagazineAllocator& mAllocator;
+    QCThread                   mThread;
+    QCMutex                    mMutex;
+    QCCondVar                  mCond;
+    int                        mStep;
+    int                        mDoneStep;
+private:
+    FlushThread(
+        const FlushThread& inThread);
+    FlushThread& operator=(
+        const FlushThread& inThread);
+};
+
+static int
+TestFlush(
+    QCIoBufferPool&            inPool,
+    IOBufferMagazineAllocator& inAllocator)
+{
+    int         theErrCnt = 0;
+    FlushThread theThread(inAllocator);
+    theThread.Start();
+    theThread.RunStep();
+    const int theCachedCount = inAllocator.GetCachedBufferCount();
+    if (theCachedCount <= 0 ||
+            theCachedCount + 1 + inPool.GetFreeBufferCount() != kTotalBufs) {
+        cerr << "unexpected cached count: " << theCachedCount <<
+            " pool free: " << inPool.GetFreeBufferCount() << "\n";
+        theErrCnt++;
+    }
+    inAllocator.Flush();
+    if (inAllocator.GetCachedBufferCount() != theCachedCount) {
+        cerr << "other thread's magazine flushed by the caller\n";
+        theErrCnt++;
+    }
+    theThread.RunStep();
+    if (inAllocator.GetCachedBufferCount() != 1 ||
+            inPool.GetFreeBufferCount() != kTotalBufs - 1) {
+        cerr << "flush request ignored: cached: " <<
+            inAllocator.GetCachedBufferCount() <<
+            " pool free: " << inPool.GetFreeBufferCount() << "\n";
+        theErrCnt++;
+    }
+    theThread.RunStep();
+    theThread.Join();
+    if (inPool.GetFreeBufferCount() != kTotalBufs) {
+        cerr << "buffers leaked after flush thread exit: " <<
+            inPool.GetFreeBufferCount() << "\n";
+        theErrCnt++;
+    }
+    return theErrCnt;
+}
+
+// Allocation must succeed until all buffers are in use, and fail once the
+// pool is exhausted. Free buffers cached by other threads must be reclaimed.
+static int
+TestExhaustion(
+    QCIoBufferPool&            inPool,
+    IOBufferMagazineAllocator& inAllocator)
+{
+    int         theErrCnt = 0;
+    FlushThread theThread(inAllocator);
+    theThread.Start();
+    theThread.RunStep();
+    // The flush thread holds one buffer, and has the rest of its magazine
+    // cached. The cached buffers are reclaimed by the "flush" thread
+    // de-allocation in the step 2, therefore run it concurrently.
+    vector<char*> theBufs;
+    QCThread      theStepThread;
+    class StepRunner : public QCRunnable
+    {
+    public:
+        StepRunner(
+            FlushThread& inThread)
+            : mThread(inThread)
+            {}
+        virtual void Run()
+        {
+            usleep(10000);
+            mThread.RunStep();
+        }
+    private:
+        FlushThread& mThread;
+    };
+    StepRunner theRunner(theThread);
+    theStepThread.Start(&theRunner);
+    char* thePtr;
+    while ((thePtr = inAllocator.Allocate())) {
+        theBufs.push_back(thePtr);
+    }
+    theStepThread.Join();
+    if ((int)theBufs.size() != kTotalBufs - 1) {
+        cerr << "allocated: " << theBufs.size() <<
+            " expected: " << (kTotalBufs - 1) << "\n";
+        theErrCnt++;
+    }
+    IOBufferMagazineAllocator::Counters theCounters;
+    inAllocator.GetCounters(theCounters);
+    if (theCounters.mAllocFailureCount <= 0) {
+        cerr << "no allocation failures reported\n";
+        theErrCnt++;
+    }
+    for (size_t i = 0; i < theBufs.size(); i++) {
+        inAllocator.Deallocate(theBufs[i]);
+    }
+    theThread.RunStep();
+    theThread.Join();
+    inAllocator.Flush();
+    if (inPool.GetFreeBufferCount() != kTotalBufs) {
+        cerr << "buffers leaked: " << inPool.GetFreeBufferCount() << "\n";
+        theErrCnt++;
+    }
+    return theErrCnt;
+}
+
+} // namespace KFS
+
+int
+main(
+    int    /* inArgCount */,
+    char** /* inArgsPtr */)
+{
+    QCIoBufferPool thePool;
+    const int theErr = thePool.Create(
+        KFS::kPartitionCount, KFS::kPartitionBufs, KFS::kBufferSize, false);
+    if (theErr) {
+        std::cerr << "buffer pool create failure: " << theErr << "\n";
+        return 1;
+    }
+    int theErrCnt;
+    {
+        KFS::IOBufferMagazineAllocator theAllocator(
+            thePool, KFS::kMagazineSize);
+        theErrCnt =
+            KFS::TestConcurrentAlloc(thePool, theAllocator) +
+            KFS::TestFlush(thePool, theAllocator) +
+            KFS::TestExhaustion(thePool, theAllocator);
+    }
+    thePool.Destroy();
+    if (theErrCnt != 0) {
+        std::cerr << "FAILED: " << theErrCnt << " errors\n";
+        return 1;
+    }
+    std::cerr << "PASSED\n";
+    return 0;
+}
@@ -25,13 +25,18 @@
 
 #include "common/BufferInputStream.h"
 #include "common/RequestParser.h"
+#include "common/ReqOstream.h"
 #include "common/Properties.h"
 
 #include <stdint.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace KFS;
 
@@ -219,6 +224,228 @@ static const ReqHandler& MakeRequestHandler()
 }
 static const ReqHandler& sReqHandler = MakeRequestHandler();
 
+/*
+    Text format parse / format, and perfect hash vs binary search field lookup
+    benchmark:
+    src/cc/devtools/requestparser_test b 1e6
+*/
+
+typedef ReqOstreamT<std::ostringstream> TestReqOstream;
+
+class TextOstream
+{
+public:
+    TextOstream(
+        TestReqOstream& inStream)
+        : mStream(inStream)
+        {}
+    template<typename T>
+    TextOstream& WriteKeyVal(
+        const char* inKeyPtr,
+        size_t      inKeyLen,
+        const T&    inVal,
+        char        inSeparator,
+        char        inDelimiter)
+    {
+        mStream.write(inKeyPtr, inKeyLen);
+        mStream.put(inSeparator);
+        mStream << inVal;
+        mStream.put(inDelimiter);
+        return *this;
+    }
+    TextOstream& WriteName(
+        const char* inPtr,
+        size_t      inLen,
+        char        inDelimiter)
+    {
+        mStream.write(inPtr, inLen);
+        mStream.put(inDelimiter);
+        return *this;
+    }
+private:
+    TestReqOstream& mStream;
+};
+
+template <typename SUPER, typename OBJ>
+class TextTestParser : public RequestParser<
+    SUPER,
+    OBJ,
+    ValueParser,
+    false,
+    PropertiesTokenizer,
+    TextOstream
+> {};
+typedef RequestHandler<
+    AbstractTest,
+    TextTestParser,
+    ParserDefinitionMethod,
+    TextOstream
+> TextReqHandler;
+
+// Binary search dictionary, used to compare with the default perfect hash
+// dictionary.
+template <typename TOKEN, typename VALUE>
+class SortedLongNamesDictionary : public RequestParserDictionaryT<
+    TOKEN, VALUE, NameToDictionaryKey<TOKEN>, false>
+{};
+
+template <typename SUPER, typename OBJ>
+class SortedTextTestParser : public RequestParser<
+    SUPER,
+    OBJ,
+    ValueParser,
+    false,
+    PropertiesTokenizer,
+    TextOstream,
+    true,
+    RequestDeleter,
+    SortedLongNamesDictionary
+> {};
+typedef RequestHandler<
+    AbstractTest,
+    SortedTextTestParser,
+    ParserDefinitionMethod,
+    TextOstream,
+    '\n',
+    PropertiesTokenizer::Token,
+    SortedLongNamesDictionary,
+    SortedLongNamesDictionary
+> SortedTextReqHandler;
+
+const int kAllocateId = 1;
+
+template<typename T>
+static const T& MakeTestHandler()
+{
+    static T sHandler;
+    return sHandler.template MakeParser<Test>("ALLOCATE", kAllocateId);
+}
+static const TextReqHandler&   sTextReqHandler =
+    MakeTestHandler<TextReqHandler>();
+static const SortedTextReqHandler& sSortedTextReqHandler =
+    MakeTestHandler<SortedTextReqHandler>();
+
+template<typename T>
+static int64_t
+LookupTest(const T& dict, const std::vector<PropertiesTokenizer::Token>& keys,
+    int count)
+{
+    int64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        for (size_t k = 0; k < keys.size(); k++) {
+            typename T::const_iterator const it = dict.find(keys[k]);
+            if (it != dict.end()) {
+                sum += it->second;
+            }
+        }
+    }
+    return sum;
+}
+
+static void
+Report(const char* name, clock_t start, int count, size_t size)
+{
+    const double t = double(clock() - start) / CLOCKS_PER_SEC;
+    std::cout << name << ": " << t << " sec " <<
+        (t > 0 ? count / t : 0.) << " ops/sec " <<
+        size << " bytes\n";
+}
+
+static std::string
+ToString(AbstractTest& req)
+{
+    std::ostringstream os;
+    req.Show(os);
+    return os.str();
+}
+
+static int
+Benchmark(int count)
+{
+    Test req;
+    req.seq          = 1234567;
+    req.vers         = 114;
+    req.host         = "somehostname";
+    req.path         = "/sort/job/1/fanout/27/file.27";
+    req.fid          = 12345678901LL;
+    req.offset       = 0;
+    req.append       = true;
+    req.reserve      = 0;
+    req.maxAppenders = 640000000;
+    req.doubleTest   = 0.5;
+
+    std::ostringstream os;
+    TestReqOstream     ros(os);
+    clock_t            start = clock();
+    std::string        text;
+    for (int i = 0; i < count; i++) {
+        os.str(std::string());
+        TextOstream stream(ros);
+        sTextReqHandler.Write(stream, &req, kAllocateId);
+        text = os.str();
+    }
+    Report("text format", start, count, text.size());
+
+    // Field name lookup only, all request header keys plus the same number of
+    // unknown keys.
+    typedef PropertiesTokenizer::Token Token;
+    std::vector<Token>  keys;
+    std::vector<std::string> unknown;
+    RequestParserLongNamesDictionary<Token, int> hashDict;
+    SortedLongNamesDictionary<Token, int>        sortedDict;
+    PropertiesTokenizer tokenizer(text.data(), text.size());
+    while (tokenizer.Next()) {
+        const Token& key = tokenizer.GetKey();
+        hashDict.insert(std::make_pair(key, (int)keys.size()));
+        sortedDict.insert(std::make_pair(key, (int)keys.size()));
+        keys.push_back(key);
+        unknown.push_back(key.ToString() + "x");
+    }
+    for (size_t k = 0; k < unknown.size(); k++) {
+        keys.push_back(Token(unknown[k].data(), unknown[k].size()));
+    }
+    start = clock();
+    const int64_t hashSum = LookupTest(hashDict, keys, count);
+    Report("field lookup perfect hash", start, count, keys.size());
+    start = clock();
+    const int64_t sortedSum = LookupTest(sortedDict, keys, count);
+    Report("field lookup binary search", start, count, keys.size());
+    if (hashSum != sortedSum) {
+        std::cout << "lookup mismatch: " << hashSum << " " << sortedSum <<
+            "\n";
+        return 1;
+    }
+
+    const std::string expected = ToString(req);
+    int               errors   = 0;
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        AbstractTest* const tst =
+            sTextReqHandler.Handle(text.data(), text.size());
+        if (! tst || (i == 0 && ToString(*tst) != expected)) {
+            errors++;
+        }
+        delete tst;
+    }
+    Report("text parse", start, count, text.size());
+
+    start = clock();
+    for (int i = 0; i < count; i++) {
+        AbstractTest* const tst =
+            sSortedTextReqHandler.Handle(text.data(), text.size());
+        if (! tst || (i == 0 && ToString(*tst) != expected)) {
+            errors++;
+        }
+        delete tst;
+    }
+    Report("text parse binary search", start, count, text.size());
+    if (errors) {
+        std::cout << "parse errors: " << errors << "\n";
+        return 1;
+    }
+    return 0;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -226,6 +453,10 @@ main(int argc, char** argv)
         return 0;
     }
 
+    if (strchr(argv[1], 'b')) {
+        return Benchmark(argc > 2 ? (int)atof(argv[2]) : 1000000);
+    }
+
     static char buf[1 << 20];
     char* ptr = buf;
     char* end = buf + sizeof(buf);
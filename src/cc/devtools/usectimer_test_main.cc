@@ -0,0 +1,270 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief Timer wheel next expiration time and net manager sub-second timer
+// unit tests.
+//
+//----------------------------------------------------------------------------
+
+#include "common/TimerWheel.h"
+#include "kfsio/NetManager.h"
+#include "kfsio/KfsCallbackObj.h"
+#include "kfsio/event.h"
+#include "qcdio/QCDLList.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <vector>
+
+namespace KFS
+{
+using std::cerr;
+using std::vector;
+
+static uint32_t sRandSeed = 1;
+
+static uint32_t
+Rand(
+    uint32_t inMax)
+{
+    sRandSeed = sRandSeed * 1103515245 + 12345;
+    return ((sRandSeed >> 8) % inMax);
+}
+
+class WheelEntry
+{
+public:
+    typedef QCDLListOp<WheelEntry> List;
+
+    WheelEntry()
+        : mExpires(-1)
+        { List::Init(*this); }
+    int64_t     mExpires;
+private:
+    WheelEntry* mPrevPtr[1];
+    WheelEntry* mNextPtr[1];
+
+    friend class QCDLListOp<WheelEntry>;
+};
+
+class WheelRun
+{
+public:
+    WheelRun(
+        int64_t& inNow)
+        : mNow(inNow)
+        {}
+    void operator()(
+        WheelEntry& inEntry) const
+    {
+        WheelEntry::List::Remove(inEntry);
+        if (mNow < inEntry.mExpires) {
+            cerr << "wheel entry expired early: " << inEntry.mExpires <<
+                " now: " << mNow << "\n";
+            abort();
+        }
+    }
+private:
+    const int64_t& mNow;
+};
+
+// With 1 unit resolution the bucket traversal time is equal to the entry
+// expiration time, or the next run time if the expiration time is in the
+// past. Compare the wheel result with the brute force minimum.
+static int
+TestTimerWheel()
+{
+    const size_t kBucketCount = 300;
+    const int    kEntryCount  = 1000;
+    typedef TimerWheel<
+        WheelEntry, WheelEntry::List, int64_t, kBucketCount, 1> Wheel;
+
+    int64_t            theNow = 1000;
+    Wheel              theWheel(theNow);
+    WheelEntry         theEntries[kEntryCount];
+    WheelRun           theRun(theNow);
+    int                theErrCnt = 0;
+    for (int k = 0; k < 20000; k++) {
+        WheelEntry& theEntry = theEntries[Rand(kEntryCount)];
+        switch (Rand(3)) {
+            case 0:
+                WheelEntry::List::Remove(theEntry);
+                break;
+            case 1:
+                if (! WheelEntry::List::IsInList(theEntry)) {
+                    theEntry.mExpires = theNow + Rand(kBucketCount - 1);
+                    theWheel.Schedule(theEntry, theEntry.mExpires);
+                }
+                break;
+            default:
+                theNow += Rand(4);
+                theWheel.Run(theNow, theRun);
+                break;
+        }
+        const int64_t kMaxTime = theNow + int64_t(kBucketCount) * 2;
+        int64_t       theMin   = kMaxTime;
+        for (int i = 0; i < kEntryCount; i++) {
+            if (WheelEntry::List::IsInList(theEntries[i]) &&
+                    theEntries[i].mExpires < theMin) {
+                theMin = theEntries[i].mExpires;
+            }
+        }
+        if (theMin < theWheel.GetNextRunTime()) {
+            theMin = theWheel.GetNextRunTime();
+        }
+        const int64_t theNext = theWheel.GetNextExpirationTime(kMaxTime);
+        if (theNext != theMin) {
+            cerr << "next expiration time mismatch: " << theNext <<
+                " expected: " << theMin << " now: " << theNow << "\n";
+            theErrCnt++;
+        }
+    }
+    for (int i = 0; i < kEntryCount; i++) {
+        WheelEntry::List::Remove(theEntries[i]);
+    }
+    return theErrCnt;
+}
+
+class UsecTimerTest : public KfsCallbackObj
+{
+public:
+    enum { kTimerCount = 2000 };
+
+    UsecTimerTest(
+        NetManager& inNetManager)
+        : KfsCallbackObj(),
+          mNetManager(inNetManager),
+          mTimer(inNetManager, *this),
+          mExpiration(-1),
+          mFiredCount(0),
+          mRescheduleCount(Rand(3)),
+          mMaxLateUsec(0),
+          mErrorFlag(false)
+        { SET_HANDLER(this, &UsecTimerTest::Timeout); }
+    void Schedule(
+        int64_t inUsec)
+    {
+        mTimer.ScheduleIn(inUsec);
+        mExpiration = mTimer.GetExpirationTime();
+    }
+    void Cancel()
+        { mTimer.Cancel(); }
+    int Timeout(
+        int   inCode,
+        void* /* inDataPtr */)
+    {
+        const int64_t theNow = mNetManager.NowUsec();
+        if (EVENT_INACTIVITY_TIMEOUT != inCode || mTimer.IsScheduled() ||
+                theNow < mExpiration) {
+            cerr << "invalid timer event: " << inCode <<
+                " expires: " << mExpiration << " now: " << theNow << "\n";
+            mErrorFlag = true;
+        }
+        if (mMaxLateUsec < theNow - mExpiration) {
+            mMaxLateUsec = theNow - mExpiration;
+        }
+        mFiredCount++;
+        if (0 < mRescheduleCount) {
+            mRescheduleCount--;
+            Schedule(Rand(300) * 1000);
+        } else if (--sPendingCount <= 0) {
+            mNetManager.Shutdown();
+        }
+        return 0;
+    }
+    bool IsScheduled() const
+        { return mTimer.IsScheduled(); }
+    static int sPendingCount;
+
+    NetManager&           mNetManager;
+    NetManager::UsecTimer mTimer;
+    int64_t               mExpiration;
+    int                   mFiredCount;
+    int                   mRescheduleCount;
+    int64_t               mMaxLateUsec;
+    bool                  mErrorFlag;
+};
+int UsecTimerTest::sPendingCount = 0;
+
+// Schedule timers spanning both wheel levels, cancel some of them, and
+// re-schedule some from the expiration handler. Cancelled timers must never
+// fire, and the remaining ones must fire after, and close to their expiration
+// time.
+static int
+TestUsecTimers()
+{
+    NetManager              theNetManager;
+    vector<UsecTimerTest*>  theTimers;
+    for (int i = 0; i < UsecTimerTest::kTimerCount; i++) {
+        UsecTimerTest* const theTimerPtr = new UsecTimerTest(theNetManager);
+        theTimerPtr->Schedule(Rand(4) == 0 ?
+            Rand(3000) * 1000 : Rand(1000000));
+        theTimers.push_back(theTimerPtr);
+    }
+    const int theCancelCount = UsecTimerTest::kTimerCount / 4;
+    for (int i = 0; i < theCancelCount; i++) {
+        theTimers[i]->Cancel();
+    }
+    UsecTimerTest::sPendingCount = UsecTimerTest::kTimerCount - theCancelCount;
+    theNetManager.MainLoop();
+    int     theErrCnt  = 0;
+    int64_t theMaxLate = 0;
+    for (int i = 0; i < UsecTimerTest::kTimerCount; i++) {
+        const UsecTimerTest& theTimer = *theTimers[i];
+        if (theTimer.mErrorFlag || theTimer.IsScheduled() ||
+                (i < theCancelCount ?
+                    theTimer.mFiredCount != 0 :
+                    theTimer.mFiredCount <= 0 ||
+                        0 < theTimer.mRescheduleCount)) {
+            cerr << "timer: " << i << " fired: " << theTimer.mFiredCount <<
+                " reschedule: " << theTimer.mRescheduleCount << "\n";
+            theErrCnt++;
+        }
+        if (theMaxLate < theTimer.mMaxLateUsec) {
+            theMaxLate = theTimer.mMaxLateUsec;
+        }
+        delete theTimers[i];
+    }
+    if (0 != theNetManager.GetUsecTimerCount()) {
+        cerr << "timer count: " << theNetManager.GetUsecTimerCount() << "\n";
+        theErrCnt++;
+    }
+    cerr << "max timer dispatch delay: " << theMaxLate << " usec\n";
+    return theErrCnt;
+}
+
+} // namespace KFS
+
+int
+main(
+    int    /* inArgCount */,
+    char** /* inArgsPtr */)
+{
+    const int theErrCnt = KFS::TestTimerWheel() + KFS::TestUsecTimers();
+    if (theErrCnt != 0) {
+        std::cerr << "FAILED: " << theErrCnt << " errors\n";
+        return 1;
+    }
+    std::cerr << "PASSED\n";
+    return 0;
+}
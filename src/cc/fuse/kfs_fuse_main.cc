@@ -25,6 +25,9 @@
 // Default is to mount read only, as non sequential write isn't supported with
 // files created with Reed-Solomon recovery, as well as simultaneous read and
 // write (O_RDWR) into the same file by a single writer.
+// The high level, path based, fuse api is used. The low level, inode based,
+// api, readdirplus, and splice reads and writes (read_buf / write_buf) are not
+// implemented.
 //
 //----------------------------------------------------------------------------
 
@@ -36,6 +39,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdint.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -43,12 +47,14 @@
 #include <errno.h>
 
 #include <iomanip>
+#include <algorithm>
 
 using std::string;
 using std::vector;
 using std::hex;
 using std::dec;
 using std::oct;
+using std::max;
 using KFS::KfsClient;
 using KFS::KfsFileAttr;
 using KFS::kfsMode_t;
@@ -79,6 +85,14 @@ static struct
 
 static bool sReadOnlyFlag;
 
+// Kernel and fuse library io size, and attribute caching parameters.
+// Large io size reduces the number of requests, and the number of client
+// library calls per byte transferred. Attribute and directory entry timeouts
+// default to the client's file attribute revalidate time, as the client's
+// attribute cache is already allowed to return attributes that old.
+static int    sMaxIoSize = 4 << 20;
+static string sFsOptions;
+
 static inline kfsMode_t
 mode2kfs_mode(mode_t mode)
 {
@@ -105,9 +119,21 @@ fuse_getattr(const char* path, struct stat* s)
 
 static int
 fuse_fgetattr(const char* path, struct stat* s,
-        struct fuse_file_info* /* finfo */)
+        struct fuse_file_info* finfo)
 {
-    return fuse_getattr(path, s);
+    // Use path while it is available: file descriptor stat might return
+    // stale size while the file is open for write. Path can be null with
+    // flag_nullpath_ok, if the file was unlinked while open.
+    if (path || ! finfo) {
+        return fuse_getattr(path, s);
+    }
+    KfsFileAttr attr;
+    int status = client->Stat((int)finfo->fh, attr);
+    if (status < 0) {
+        return status;
+    }
+    attr.ToStat(*s);
+    return 0;
 }
 
 static int
@@ -335,19 +361,29 @@ fuse_fsync(const char* path, int /* flags */,
 }
 
 static int
-fuse_opendir(const char* path, struct fuse_file_info* /* finfo */)
+fuse_opendir(const char* path, struct fuse_file_info* finfo)
 {
     if (!client->IsDirectory(path)) {
         return -ENOTDIR;
     }
+    // Save the path, as with flag_nullpath_ok the fuse library might pass
+    // null path to readdir.
+    finfo->fh = (uint64_t)(uintptr_t)new string(path);
     return 0;
 }
 
 static int
 fuse_readdir(const char* path, void* buf,
              fuse_fill_dir_t filler, off_t /* offset */,
-             struct fuse_file_info* /* finfo */)
+             struct fuse_file_info* finfo)
 {
+    if (! path) {
+        if (! finfo || ! finfo->fh) {
+            return -EBADF;
+        }
+        path = reinterpret_cast<const string*>(
+            (uintptr_t)finfo->fh)->c_str();
+    }
     vector <KfsFileAttr> contents;
     int status = client->ReaddirPlus(path, contents);
     if (status < 0) {
@@ -365,8 +401,12 @@ fuse_readdir(const char* path, void* buf,
 }
 
 static int
-fuse_releasedir(const char* /* path */, struct fuse_file_info* /* finfo */)
+fuse_releasedir(const char* /* path */, struct fuse_file_info* finfo)
 {
+    if (finfo && finfo->fh) {
+        delete reinterpret_cast<string*>((uintptr_t)finfo->fh);
+        finfo->fh = 0;
+    }
     return 0;
 }
 
@@ -504,7 +544,7 @@ struct fuse_operations ops_readonly = {
         NULL,                   /* removexattr */
         fuse_opendir,
         fuse_readdir,
-        NULL,                   /* releasedir */
+        fuse_releasedir,
         NULL,                   /* fsyncdir */
         NULL,                   /* init */
         NULL,                   /* destroy */
@@ -595,15 +635,26 @@ get_fs_args(struct fuse_args* args)
     if (! args) {
         return 0;
     }
-    args->argc = 1;
-    args->argv = (char**)calloc(sizeof(char*), args->argc + 1);
+    const int timeout = max(0, client->GetFileAttributeRevalidateTime());
+    char      buf[256];
+    snprintf(buf, sizeof(buf),
+        "-ouse_ino,readdir_ino,auto_cache"
+        ",attr_timeout=%d,entry_timeout=%d"
+        ",max_write=%d,max_readahead=%d",
+        timeout, timeout, sMaxIoSize, sMaxIoSize);
+    args->argc = 2;
+    args->argv = (char**)calloc(sizeof(char*), args->argc + 3);
     args->argv[0] = strdup("qfs_fuse");
+    args->argv[1] = strdup(buf);
 #if defined(FUSE_MAJOR_VERSION)
 #if FUSE_MAJOR_VERSION < 3
-    args->argc++;
-    args->argv[1] = strdup("-obig_writes");
+    args->argv[args->argc++] = strdup("-obig_writes");
 #endif
 #endif
+    if (! sFsOptions.empty()) {
+        // Specified last in order to override the defaults above.
+        args->argv[args->argc++] = strdup(("-o" + sFsOptions).c_str());
+    }
     args->allocated = 1;
     return args;
 }
@@ -623,6 +674,19 @@ get_mount_args(struct fuse_args* args, const char* options)
     return args;
 }
 
+static bool
+is_fs_option(const char* const* fs_opts, const string& token)
+{
+    for (const char* const* p = fs_opts; *p; ++p) {
+        const size_t len = strlen(*p);
+        if (0 < len && '=' == (*p)[len - 1] ?
+                0 == token.compare(0, len, *p) : token == *p) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
  * Run through the -o OPTIONS and interpret it as writable only if 'rrw' is
  * explicitly specified. We use 'rrw' instead of 'rw' because a 'default'
@@ -646,6 +710,21 @@ massage_options(
     vector<string> opts;
     const string delim = " ,";
     const string create("create=");
+    const string max_io("max_io=");
+    // Fuse library, as opposed to mount, options.
+    const char* const fs_opts[] = {
+        "attr_timeout=",
+        "entry_timeout=",
+        "negative_timeout=",
+        "max_write=",
+        "max_readahead=",
+        "kernel_cache",
+        "auto_cache",
+        "noauto_cache",
+        "use_ino",
+        "readdir_ino",
+        0
+    };
     for(size_t start = 0; ;) {
         start = cmdline.find_first_not_of(delim, start);
         if (start == string::npos){
@@ -670,6 +749,17 @@ massage_options(
                 printf("invalid file create parameters: %s", token.c_str());
                 return -1;
             }
+        } else if (0 == token.compare(0, max_io.size(), max_io)) {
+            sMaxIoSize = atoi(token.c_str() + max_io.size());
+            if (sMaxIoSize < (4 << 10)) {
+                printf("invalid max io size: %s", token.c_str());
+                return -1;
+            }
+        } else if (is_fs_option(fs_opts, token)) {
+            if (! sFsOptions.empty()) {
+                sFsOptions += ",";
+            }
+            sFsOptions += token;
         } else if ("rw" != token) {
             opts.push_back(token);
         }
@@ -753,10 +843,18 @@ initfuse(char* kfs_host_address, const char* mountpoint,
             fatal(err, "fuse_mount: %s:", mountpoint);
         }
 
+        struct fuse_operations& fops = readonly ? ops_readonly : ops;
+#if defined(FUSE_MAJOR_VERSION) && FUSE_MAJOR_VERSION == 2
+#if 8 <= FUSE_MINOR_VERSION
+        // All file handle methods can work without path: the file
+        // descriptor and the directory path are saved in the file handle.
+        // flag_nopath is not set, as getattr uses path when available.
+        fops.flag_nullpath_ok = 1;
+#endif
+#endif
         struct fuse* fuse = NULL;
         fuse = fuse_new(ch, get_fs_args(&fs_args),
-                        (readonly ? &ops_readonly : &ops),
-                        (readonly ? sizeof(ops_readonly) : sizeof(ops)),
+                        &fops, sizeof(fops),
                         NULL);
         if (fuse == NULL) {
             const int err = errno;
@@ -765,14 +863,14 @@ initfuse(char* kfs_host_address, const char* mountpoint,
             fatal(err, "fuse_new:");
         }
         sReadOnlyFlag = readonly;
+        // Client library is thread safe, and reads and writes of different
+        // files, as well as non overlapping reads of the same file proceed
+        // in parallel, therefore use multi threaded dispatch in both modes.
 #ifndef KFS_OS_NAME_SUNOS
-        if (! readonly) {
-            fuse_loop_mt(fuse);
-        } else
+        fuse_loop_mt(fuse);
+#else
+        fuse_loop(fuse);
 #endif
-        {
-            fuse_loop(fuse);
-        }
         fuse_unmount(mountpoint, ch);
         fuse_destroy(fuse);
         delete client;
@@ -791,10 +889,16 @@ usage(const char* name)
         "       rrw option can be used to enable read write mode, however, this"
         " mode has *very* limited support: only replicated files write"
         " is supported, file append is not supported.\n"
-        "       File system IO in read write mode is serialized.\n"
+        "       max_io=<bytes> option sets fuse max write and max read ahead"
+        " size, default %d.\n"
+        "       Fuse library options attr_timeout, entry_timeout,"
+        " negative_timeout, max_write, max_readahead, kernel_cache,"
+        " auto_cache, noauto_cache, use_ino, readdir_ino are passed to the"
+        " fuse library. Attribute and entry"
+        " timeouts default to the client attribute revalidate time.\n"
         " -f -- do not fork, remain foreground process (debugging).\n"
         " -g -- help, emit this message and exit.\n"
-        , name, name
+        , name, name, sMaxIoSize
     );
 }
 
@@ -44,6 +44,8 @@ Acceptor::Acceptor(
     bool                  bindOnlyFlag)
     : mLocation(location),
       mIpV6OnlyFlag(ipV6OnlyFlag),
+      mSharedFlag(false),
+      mAcceptCount(0),
       mAcceptorOwner(owner),
       mConn(),
       mNetManager(netManager)
@@ -62,6 +64,8 @@ Acceptor::Acceptor(
     bool            bindOnlyFlag /* = false */)
     : mLocation(string(), port),
       mIpV6OnlyFlag(false),
+      mSharedFlag(false),
+      mAcceptCount(0),
       mAcceptorOwner(owner),
       mConn(),
       mNetManager(netManager)
@@ -73,6 +77,49 @@ Acceptor::Acceptor(
     }
 }
 
+Acceptor::Acceptor(
+    NetManager&           netManager,
+    const ServerLocation& location,
+    TcpSocket*            listener,
+    IAcceptorOwner*       owner)
+    : mLocation(location),
+      mIpV6OnlyFlag(false),
+      mSharedFlag(true),
+      mAcceptCount(0),
+      mAcceptorOwner(owner),
+      mConn(),
+      mNetManager(netManager)
+{
+    SET_HANDLER(this, &Acceptor::RecvConnection);
+    if (! listener) {
+        return;
+    }
+    if (! mNetManager.IsRunning()) {
+        delete listener;
+        return;
+    }
+    const bool kListenOnlyFlag = true;
+    mConn.reset(new NetConnection(listener, this, kListenOnlyFlag));
+    Acceptor::StartListening();
+}
+
+TcpSocket*
+Acceptor::DupListener() const
+{
+    if (! IsAcceptorStarted()) {
+        return 0;
+    }
+    int              err  = 0;
+    TcpSocket* const sock = mConn->DupSocket(&err);
+    if (! sock) {
+        KFS_LOG_STREAM_ERROR <<
+            "failed to duplicate listener: " << mLocation <<
+            " error: " << QCUtils::SysError(err) <<
+        KFS_LOG_EOM;
+    }
+    return sock;
+}
+
 Acceptor::~Acceptor()
 {
     if (mConn) {
@@ -157,12 +204,18 @@ Acceptor::RecvConnection(int code, void* data)
                 "acceptor on: " << mLocation <<
                 " error: " <<
                     QCUtils::SysError(mConn ? mConn->GetSocketError() : 0) <<
-                (mNetManager.IsRunning() ? ", restarting" : ", exiting") <<
+                (mSharedFlag ? ", closing" :
+                    (mNetManager.IsRunning() ? ", restarting" : ", exiting")) <<
             KFS_LOG_EOM;
             if (mConn) {
                 mConn->Close();
                 mConn.reset();
             }
+            if (mSharedFlag) {
+                // The owner of the listening socket continues to accept
+                // connections.
+                return 0;
+            }
             if (mNetManager.IsRunning()) {
                 Bind();
                 StartListening();
@@ -195,6 +248,7 @@ Acceptor::RecvConnection(int code, void* data)
         MsgLogger::Stop();
         abort();
     }
+    mAcceptCount++;
     NetConnectionPtr& conn = *reinterpret_cast<NetConnectionPtr*>(data);
     KfsCallbackObj* const obj = mAcceptorOwner->CreateKfsCallbackObj(conn);
     if (conn) {
@@ -93,7 +93,18 @@ public:
         bool                  ipV6OnlyFlag,
         IAcceptorOwner*       owner,
         bool                  bindOnlyFlag);
+    /// Listen on the socket obtained with DupListener() from the acceptor
+    /// running in different net manager / thread. Both acceptors accept
+    /// connections from the same kernel queue. The acceptor takes the
+    /// ownership of the socket.
+    Acceptor(
+        NetManager&           netManager,
+        const ServerLocation& location,
+        TcpSocket*            listener,
+        IAcceptorOwner*       owner);
     ~Acceptor();
+    /// Return duplicate of the listening socket, or null on failure.
+    TcpSocket* DupListener() const;
     void StartListening();
 
     /// Return true if we were able to bind to the acceptor port
@@ -114,6 +125,8 @@ public:
         { return mLocation; }
     NetManager& GetNetManager()
         { return mNetManager; }
+    int64_t GetAcceptCount() const
+        { return mAcceptCount; }
 private:
     ///
     /// The encapsulated connection object that corresponds to the TCP
@@ -121,6 +134,8 @@ private:
     ///
     ServerLocation        mLocation;
     bool                  mIpV6OnlyFlag;
+    bool                  mSharedFlag;
+    int64_t               mAcceptCount;
     IAcceptorOwner* const mAcceptorOwner;
     NetConnectionPtr      mConn;
     NetManager&           mNetManager;
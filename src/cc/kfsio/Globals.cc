@@ -40,6 +40,11 @@ Globals_t::Globals_t()
       ctrOpenDiskFds      ("Open disk fds"),
       ctrNetBytesRead     ("Bytes read from network"),
       ctrNetBytesWritten  ("Bytes written to network"),
+      ctrNetKtlsSendSessions("Kernel TLS send sessions"),
+      ctrNetKtlsRecvSessions("Kernel TLS receive sessions"),
+      ctrNetKtlsFallbacks ("Kernel TLS fallbacks"),
+      ctrNetKtlsBytesRead ("Kernel TLS bytes read from network"),
+      ctrNetKtlsBytesWritten("Kernel TLS bytes written to network"),
       ctrDiskBytesRead    ("Bytes read from disk"),
       ctrDiskBytesWritten ("Bytes written to disk"),
       ctrDiskIOErrors     ("Disk I/O errors"),
@@ -53,6 +58,11 @@ Globals_t::Globals_t()
     counterManager.AddCounter(&ctrOpenDiskFds);
     counterManager.AddCounter(&ctrNetBytesRead);
     counterManager.AddCounter(&ctrNetBytesWritten);
+    counterManager.AddCounter(&ctrNetKtlsSendSessions);
+    counterManager.AddCounter(&ctrNetKtlsRecvSessions);
+    counterManager.AddCounter(&ctrNetKtlsFallbacks);
+    counterManager.AddCounter(&ctrNetKtlsBytesRead);
+    counterManager.AddCounter(&ctrNetKtlsBytesWritten);
     counterManager.AddCounter(&ctrDiskBytesRead);
     counterManager.AddCounter(&ctrDiskBytesWritten);
     counterManager.AddCounter(&ctrDiskIOErrors);
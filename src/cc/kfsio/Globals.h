@@ -44,6 +44,14 @@ struct Globals_t
     Counter ctrOpenDiskFds;
     Counter ctrNetBytesRead;
     Counter ctrNetBytesWritten;
+    // Kernel TLS offload: number of sessions with kernel send / receive
+    // enabled, sessions where it was requested but not available, and the
+    // number of bytes sent / received.
+    Counter ctrNetKtlsSendSessions;
+    Counter ctrNetKtlsRecvSessions;
+    Counter ctrNetKtlsFallbacks;
+    Counter ctrNetKtlsBytesRead;
+    Counter ctrNetKtlsBytesWritten;
     Counter ctrDiskBytesRead;
     Counter ctrDiskBytesWritten;
     // track the # of failed read/writes
@@ -31,6 +31,7 @@
 #ifndef _LIBIO_IOBUFFER_H
 #define _LIBIO_IOBUFFER_H
 
+#include "IOBufferList.h"
 #include "common/DisplayData.h"
 #include "common/StdAllocator.h"
 
@@ -224,6 +225,28 @@ public:
     /// should not be called if and object was created with IOBufferData(const
     ///g IOBufferBlockPtr& data, ...) constructor.
     char* DetachBuffer(bool consumerAtBufferStartFlag);
+    /// Empty object without data buffer. Used by IOBufferList to move buffers
+    /// between lists without reference count updates.
+    struct NoBuffer {};
+    explicit IOBufferData(NoBuffer)
+        : mData(),
+          mEnd(0),
+          mProducer(0),
+          mConsumer(0)
+        {}
+    void Swap(IOBufferData& other)
+    {
+        mData.swap(other.mData);
+        char* const end      = mEnd;
+        char* const producer = mProducer;
+        char* const consumer = mConsumer;
+        mEnd            = other.mEnd;
+        mProducer       = other.mProducer;
+        mConsumer       = other.mConsumer;
+        other.mEnd      = end;
+        other.mProducer = producer;
+        other.mConsumer = consumer;
+    }
 private:
     IOBufferBlockPtr mData;
     /// Pointers that correspond to the start/end of the buffer
@@ -253,10 +276,8 @@ private:
 class IOBuffer
 {
 private:
-    typedef list<
-        IOBufferData,
-        StdFastAllocator<IOBufferData>
-    > BList;
+    // Typical rpc message has 1 to 3 buffers.
+    typedef IOBufferList<IOBufferData, 3> BList;
 public:
     typedef IOBufferData::BufPos BufPos;
     typedef BList::const_iterator iterator;
@@ -0,0 +1,388 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief IOBuffer segment list with inline storage for the first few nodes.
+//
+//----------------------------------------------------------------------------
+
+#ifndef _LIBIO_IOBUFFER_LIST_H
+#define _LIBIO_IOBUFFER_LIST_H
+
+#include "common/StdAllocator.h"
+
+#include <stddef.h>
+#include <assert.h>
+#include <new>
+#include <iterator>
+
+namespace KFS
+{
+
+// Doubly linked list with std::list like interface -- the subset that
+// IOBuffer uses. The first InlineCountT nodes are allocated from the storage
+// embedded into the list object, the remaining nodes from the pool allocator,
+// which allocates nodes in contiguous chunks. Small lists, the common case
+// with rpc messages, do not require any allocation.
+// The differences from std::list:
+// - the list object must not be copied or moved;
+// - splice() moves the element value into a new node if the source node is
+// inline, in which case the iterator to the spliced element becomes invalid;
+// - range splice() from a different list is O(range length), unless the source
+// list has no inline nodes in use;
+// - T must have T(T::NoBuffer) constructor that creates cheap empty value, and
+// Swap(T&) method.
+template<typename T, size_t InlineCountT>
+class IOBufferList
+{
+private:
+    struct NodeBase
+    {
+        NodeBase* mPrevPtr;
+        NodeBase* mNextPtr;
+    };
+    struct Node : public NodeBase
+    {
+        Node(
+            const T& inValue)
+            : NodeBase(),
+              mValue(inValue)
+            {}
+        T mValue;
+    };
+    typedef StdFastAllocator<Node> Allocator;
+    typedef unsigned int           InlineMask;
+    typedef char InlineCountCheck[
+        InlineCountT < sizeof(InlineMask) * 8 ? 1 : -1];
+public:
+    typedef T         value_type;
+    typedef T&        reference;
+    typedef const T&  const_reference;
+    typedef size_t    size_type;
+    typedef ptrdiff_t difference_type;
+
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef ptrdiff_t                       difference_type;
+        typedef const T*                        pointer;
+        typedef const T&                        reference;
+
+        const_iterator()
+            : mPtr(0)
+            {}
+        const T& operator*() const
+            { return static_cast<const Node*>(mPtr)->mValue; }
+        const T* operator->() const
+            { return &static_cast<const Node*>(mPtr)->mValue; }
+        const_iterator& operator++()
+        {
+            mPtr = mPtr->mNextPtr;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator const theRet(*this);
+            mPtr = mPtr->mNextPtr;
+            return theRet;
+        }
+        const_iterator& operator--()
+        {
+            mPtr = mPtr->mPrevPtr;
+            return *this;
+        }
+        const_iterator operator--(int)
+        {
+            const_iterator const theRet(*this);
+            mPtr = mPtr->mPrevPtr;
+            return theRet;
+        }
+        bool operator==(
+            const const_iterator& inIt) const
+            { return (mPtr == inIt.mPtr); }
+        bool operator!=(
+            const const_iterator& inIt) const
+            { return (mPtr != inIt.mPtr); }
+    protected:
+        NodeBase* mPtr;
+
+        explicit const_iterator(
+            NodeBase* inPtr)
+            : mPtr(inPtr)
+            {}
+        friend class IOBufferList;
+    };
+    // Derived from const_iterator in order to allow mixed comparisons, and
+    // implicit conversion to const_iterator.
+    class iterator : public const_iterator
+    {
+    public:
+        typedef T* pointer;
+        typedef T& reference;
+
+        iterator()
+            : const_iterator()
+            {}
+        T& operator*() const
+            { return static_cast<Node*>(this->mPtr)->mValue; }
+        T* operator->() const
+            { return &static_cast<Node*>(this->mPtr)->mValue; }
+        iterator& operator++()
+        {
+            this->mPtr = this->mPtr->mNextPtr;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator const theRet(*this);
+            this->mPtr = this->mPtr->mNextPtr;
+            return theRet;
+        }
+        iterator& operator--()
+        {
+            this->mPtr = this->mPtr->mPrevPtr;
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            iterator const theRet(*this);
+            this->mPtr = this->mPtr->mPrevPtr;
+            return theRet;
+        }
+    private:
+        explicit iterator(
+            NodeBase* inPtr)
+            : const_iterator(inPtr)
+            {}
+        friend class IOBufferList;
+    };
+
+    IOBufferList()
+        : mInlineMask(0),
+          mAllocator()
+    {
+        mHead.mPrevPtr = &mHead;
+        mHead.mNextPtr = &mHead;
+    }
+    ~IOBufferList()
+        { clear(); }
+    bool empty() const
+        { return (mHead.mNextPtr == &mHead); }
+    iterator begin()
+        { return iterator(mHead.mNextPtr); }
+    iterator end()
+        { return iterator(&mHead); }
+    const_iterator begin() const
+        { return const_iterator(mHead.mNextPtr); }
+    const_iterator end() const
+        { return const_iterator(const_cast<NodeBase*>(&mHead)); }
+    T& front()
+        { return *begin(); }
+    const T& front() const
+        { return *begin(); }
+    T& back()
+        { return static_cast<Node*>(mHead.mPrevPtr)->mValue; }
+    const T& back() const
+        { return static_cast<const Node*>(mHead.mPrevPtr)->mValue; }
+    void push_back(
+        const T& inValue)
+        { Link(&mHead, NewNode(inValue)); }
+    void push_front(
+        const T& inValue)
+        { Link(mHead.mNextPtr, NewNode(inValue)); }
+    void pop_front()
+        { erase(begin()); }
+    void pop_back()
+        { erase(const_iterator(mHead.mPrevPtr)); }
+    iterator insert(
+        const_iterator inPos,
+        const T&       inValue)
+    {
+        Node* const theNodePtr = NewNode(inValue);
+        Link(inPos.mPtr, theNodePtr);
+        return iterator(theNodePtr);
+    }
+    iterator erase(
+        const_iterator inPos)
+    {
+        assert(inPos.mPtr != &mHead);
+        NodeBase* const theNextPtr = inPos.mPtr->mNextPtr;
+        Unlink(inPos.mPtr);
+        DeleteNode(static_cast<Node*>(inPos.mPtr));
+        return iterator(theNextPtr);
+    }
+    iterator erase(
+        const_iterator inFirst,
+        const_iterator inLast)
+    {
+        while (inFirst != inLast) {
+            inFirst = erase(inFirst);
+        }
+        return iterator(inLast.mPtr);
+    }
+    void clear()
+        { erase(begin(), end()); }
+    void splice(
+        const_iterator inPos,
+        IOBufferList&  inList,
+        const_iterator inIt)
+    {
+        NodeBase* thePtr = inIt.mPtr;
+        if (thePtr == inPos.mPtr || thePtr->mNextPtr == inPos.mPtr) {
+            return;
+        }
+        inList.Unlink(thePtr);
+        if (&inList != this && inList.IsInline(thePtr)) {
+            Node* const theNodePtr = NewNode(T(typename T::NoBuffer()));
+            theNodePtr->mValue.Swap(static_cast<Node*>(thePtr)->mValue);
+            inList.DeleteNode(static_cast<Node*>(thePtr));
+            thePtr = theNodePtr;
+        }
+        Link(inPos.mPtr, thePtr);
+    }
+    void splice(
+        const_iterator inPos,
+        IOBufferList&  inList,
+        const_iterator inFirst,
+        const_iterator inLast)
+    {
+        if (inFirst == inLast) {
+            return;
+        }
+        if (&inList == this || inList.mInlineMask == 0) {
+            // Relink the whole range.
+            NodeBase* const theFirstPtr = inFirst.mPtr;
+            NodeBase* const theLastPtr  = inLast.mPtr->mPrevPtr;
+            theFirstPtr->mPrevPtr->mNextPtr = inLast.mPtr;
+            inLast.mPtr->mPrevPtr           = theFirstPtr->mPrevPtr;
+            NodeBase* const thePosPtr = inPos.mPtr;
+            theFirstPtr->mPrevPtr           = thePosPtr->mPrevPtr;
+            thePosPtr->mPrevPtr->mNextPtr   = theFirstPtr;
+            theLastPtr->mNextPtr            = thePosPtr;
+            thePosPtr->mPrevPtr             = theLastPtr;
+            return;
+        }
+        while (inFirst != inLast) {
+            const_iterator const theIt = inFirst++;
+            splice(inPos, inList, theIt);
+        }
+    }
+    void splice(
+        const_iterator inPos,
+        IOBufferList&  inList)
+        { splice(inPos, inList, inList.begin(), inList.end()); }
+    void swap(
+        IOBufferList& inList)
+    {
+        if (&inList == this) {
+            return;
+        }
+        IOBufferList theTmp;
+        theTmp.splice(theTmp.end(), *this);
+        splice(end(), inList);
+        inList.splice(inList.end(), theTmp);
+    }
+    size_type size() const
+    {
+        size_type theRet = 0;
+        for (const_iterator theIt = begin(); theIt != end(); ++theIt) {
+            theRet++;
+        }
+        return theRet;
+    }
+private:
+    union InlineNode
+    {
+        char   mBytes[sizeof(Node)];
+        void*  mPtrAlign;
+        double mDoubleAlign;
+        long   mLongAlign;
+    };
+
+    NodeBase   mHead;
+    InlineMask mInlineMask;
+    Allocator  mAllocator;
+    InlineNode mInlineNodes[InlineCountT];
+
+    bool IsInline(
+        const NodeBase* inPtr) const
+    {
+        const char* const thePtr = reinterpret_cast<const char*>(inPtr);
+        return (
+            reinterpret_cast<const char*>(mInlineNodes) <= thePtr &&
+            thePtr < reinterpret_cast<const char*>(
+                mInlineNodes + InlineCountT)
+        );
+    }
+    Node* NewNode(
+        const T& inValue)
+    {
+        void* theMemPtr = 0;
+        if (mInlineMask != (InlineMask(1) << InlineCountT) - 1) {
+            size_t theIdx = 0;
+            while ((mInlineMask & (InlineMask(1) << theIdx)) != 0) {
+                theIdx++;
+            }
+            mInlineMask |= InlineMask(1) << theIdx;
+            theMemPtr = mInlineNodes + theIdx;
+        } else {
+            theMemPtr = mAllocator.allocate(1);
+        }
+        return new (theMemPtr) Node(inValue);
+    }
+    void DeleteNode(
+        Node* inNodePtr)
+    {
+        inNodePtr->~Node();
+        if (IsInline(inNodePtr)) {
+            const size_t theIdx = reinterpret_cast<InlineNode*>(inNodePtr) -
+                mInlineNodes;
+            mInlineMask &= ~(InlineMask(1) << theIdx);
+        } else {
+            mAllocator.deallocate(inNodePtr, 1);
+        }
+    }
+    static void Link(
+        NodeBase* inPosPtr,
+        NodeBase* inNodePtr)
+    {
+        inNodePtr->mNextPtr          = inPosPtr;
+        inNodePtr->mPrevPtr          = inPosPtr->mPrevPtr;
+        inPosPtr->mPrevPtr->mNextPtr = inNodePtr;
+        inPosPtr->mPrevPtr           = inNodePtr;
+    }
+    static void Unlink(
+        NodeBase* inNodePtr)
+    {
+        inNodePtr->mPrevPtr->mNextPtr = inNodePtr->mNextPtr;
+        inNodePtr->mNextPtr->mPrevPtr = inNodePtr->mPrevPtr;
+    }
+private:
+    IOBufferList(
+        const IOBufferList& inList);
+    IOBufferList& operator=(
+        const IOBufferList& inList);
+};
+
+} // namespace KFS
+
+#endif /* _LIBIO_IOBUFFER_LIST_H */
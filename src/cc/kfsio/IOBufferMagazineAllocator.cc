@@ -0,0 +1,465 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \file IOBufferMagazineAllocator.cc
+// \brief Io buffer allocator with per thread buffer caches.
+//
+//----------------------------------------------------------------------------
+
+#include "IOBufferMagazineAllocator.h"
+
+#include "common/time.h"
+#include "common/kfsatomic.h"
+#include "qcdio/QCIoBufferPool.h"
+#include "qcdio/QCMutex.h"
+#include "qcdio/QCUtils.h"
+#include "qcdio/qcstutils.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace KFS
+{
+using std::max;
+
+class IOBufferMagazineAllocator::Impl
+{
+public:
+    typedef IOBufferMagazineAllocator::Counters Counters;
+
+    Impl(
+        QCIoBufferPool& inPool,
+        int             inMagazineSize)
+        : mPool(inPool),
+          mMagazineSize(max(2, inMagazineSize)),
+          mMutex(),
+          mKey(),
+          mFlushEpoch(0),
+          mMagazineListPtr(0)
+    {
+        const int theErr = pthread_key_create(&mKey, &Impl::ThreadExit);
+        if (theErr) {
+            QCUtils::FatalError("pthread_key_create", theErr);
+        }
+    }
+    ~Impl()
+    {
+        // No allocations or de-allocations must be in flight at this point.
+        pthread_key_delete(mKey);
+        Magazine* thePtr = mMagazineListPtr;
+        while (thePtr) {
+            Magazine* const theNextPtr = thePtr->GetNextPtr();
+            thePtr->Flush();
+            delete thePtr;
+            thePtr = theNextPtr;
+        }
+    }
+    size_t GetBufferSize() const
+        { return mPool.GetBufferSize(); }
+    char* Allocate()
+    {
+        Magazine&   theMagazine = GetMagazine();
+        char* const theBufPtr   = theMagazine.Allocate();
+        if (theBufPtr) {
+            return theBufPtr;
+        }
+        return AllocateSlow(theMagazine);
+    }
+    void Deallocate(
+        char* inBufPtr)
+    {
+        if (inBufPtr) {
+            GetMagazine().Deallocate(inBufPtr);
+        }
+    }
+    void Flush()
+    {
+        SyncAddAndFetch(mFlushEpoch, 1u);
+        GetMagazine().Flush();
+        // Unowned magazines, if any, can be flushed from any thread.
+        QCStMutexLocker theLocker(mMutex);
+        for (Magazine* thePtr = mMagazineListPtr;
+                thePtr;
+                thePtr = thePtr->GetNextPtr()) {
+            if (! thePtr->IsOwned()) {
+                thePtr->Flush();
+            }
+        }
+    }
+    void GetCounters(
+        Counters& outCounters) const
+    {
+        outCounters.Clear();
+        for (const Magazine* thePtr = SyncLoadAcquire(mMagazineListPtr);
+                thePtr;
+                thePtr = thePtr->GetNextPtr()) {
+            thePtr->AddCounters(outCounters);
+        }
+    }
+    int GetCachedBufferCount() const
+    {
+        int theRet = 0;
+        for (const Magazine* thePtr = SyncLoadAcquire(mMagazineListPtr);
+                thePtr;
+                thePtr = thePtr->GetNextPtr()) {
+            theRet += thePtr->GetCount();
+        }
+        return theRet;
+    }
+    int GetMagazineSize() const
+        { return mMagazineSize; }
+private:
+    // The magazine is only accessed by its owner thread, with the exception of
+    // the counters and the cached buffer count, which can be read by any
+    // thread with no synchronization, as these only used for reporting and
+    // heuristics. The magazines are never unlinked from the list or deleted
+    // until the allocator destruction, this allows lock free list traversal.
+    // The magazine of the exiting thread is flushed, and then re-used by the
+    // next thread.
+    class Magazine
+    {
+    public:
+        Magazine(
+            QCIoBufferPool& inPool,
+            Impl&           inImpl,
+            int             inCapacity)
+            : mPool(inPool),
+              mImpl(inImpl),
+              mCapacity(inCapacity),
+              mCount(0),
+              mFlushEpoch(inImpl.mFlushEpoch),
+              mOwnedFlag(true),
+              mBufsPtr(new char*[inCapacity]),
+              mNextPtr(0),
+              mCounters()
+            { mCounters.Clear(); }
+        ~Magazine()
+            { delete [] mBufsPtr; }
+        char* Allocate()
+        {
+            CheckFlushRequest();
+            mCounters.mAllocCount++;
+            if (0 < mCount) {
+                mCounters.mMagazineAllocCount++;
+            } else if (! Refill()) {
+                return 0;
+            }
+            return mBufsPtr[--mCount];
+        }
+        void Deallocate(
+            char* inBufPtr)
+        {
+            CheckFlushRequest();
+            mCounters.mFreeCount++;
+            if (mCapacity <= mCount) {
+                // Return the least recently used half to the pool.
+                FlushSelf(mCapacity / 2);
+            } else {
+                mCounters.mMagazineFreeCount++;
+            }
+            mBufsPtr[mCount++] = inBufPtr;
+        }
+        void Flush()
+            { FlushSelf(mCount); }
+        char* AllocateFromPool()
+        {
+            char* const theBufPtr = mPool.Get();
+            if (theBufPtr) {
+                mCounters.mRefillCount++;
+                mCounters.mRefillBufferCount++;
+            }
+            return theBufPtr;
+        }
+        void AllocFailure()
+            { mCounters.mAllocFailureCount++; }
+        void AddCounters(
+            Counters& ioCounters) const
+        {
+            ioCounters.mAllocCount         += mCounters.mAllocCount;
+            ioCounters.mFreeCount          += mCounters.mFreeCount;
+            ioCounters.mMagazineAllocCount += mCounters.mMagazineAllocCount;
+            ioCounters.mMagazineFreeCount  += mCounters.mMagazineFreeCount;
+            ioCounters.mRefillCount        += mCounters.mRefillCount;
+            ioCounters.mRefillBufferCount  += mCounters.mRefillBufferCount;
+            ioCounters.mFlushCount         += mCounters.mFlushCount;
+            ioCounters.mFlushBufferCount   += mCounters.mFlushBufferCount;
+            ioCounters.mDepotTimeUsec      += mCounters.mDepotTimeUsec;
+            ioCounters.mDepotMaxTimeUsec   = max(
+                ioCounters.mDepotMaxTimeUsec, mCounters.mDepotMaxTimeUsec);
+            ioCounters.mAllocFailureCount  += mCounters.mAllocFailureCount;
+            ioCounters.mCachedBufferCount  += mCount;
+            if (mOwnedFlag) {
+                ioCounters.mMagazineCount++;
+            }
+        }
+        int GetCount() const
+            { return mCount; }
+        Impl& GetImpl() const
+            { return mImpl; }
+        bool IsOwned() const
+            { return mOwnedFlag; }
+        void SetOwned(
+            bool inFlag)
+            { mOwnedFlag = inFlag; }
+        Magazine* GetNextPtr() const
+            { return mNextPtr; }
+        void SetNextPtr(
+            Magazine* inPtr)
+            { mNextPtr = inPtr; }
+    private:
+        class OutputIterator : public QCIoBufferPool::OutputIterator
+        {
+        public:
+            OutputIterator(
+                char** inBufsPtr)
+                : mBufsPtr(inBufsPtr)
+                {}
+            virtual void Put(
+                char* inBufPtr)
+                { *mBufsPtr++ = inBufPtr; }
+        private:
+            char** mBufsPtr;
+        };
+        class InputIterator : public QCIoBufferPool::InputIterator
+        {
+        public:
+            InputIterator(
+                char** inBufsPtr)
+                : mBufsPtr(inBufsPtr)
+                {}
+            virtual char* Get()
+                { return *mBufsPtr++; }
+        private:
+            char** mBufsPtr;
+        };
+
+        QCIoBufferPool&       mPool;
+        Impl&                 mImpl;
+        const int             mCapacity;
+        volatile int          mCount;
+        unsigned int          mFlushEpoch;
+        volatile bool         mOwnedFlag;
+        char** const          mBufsPtr;
+        Magazine*             mNextPtr;
+        Counters              mCounters;
+
+        void CheckFlushRequest()
+        {
+            // Plain volatile read, no memory barrier: observing the epoch
+            // change with a delay only delays the flush.
+            const unsigned int theEpoch = mImpl.mFlushEpoch;
+            if (theEpoch != mFlushEpoch) {
+                mFlushEpoch = theEpoch;
+                Flush();
+            }
+        }
+        bool Refill()
+        {
+            const int64_t theStart = microseconds();
+            // Batch get is all or nothing, fall back to single buffer get if
+            // the pool is low on buffers.
+            const int      theCnt = mCapacity / 2;
+            OutputIterator theIt(mBufsPtr);
+            if (mPool.Get(theIt, theCnt)) {
+                mCount = theCnt;
+            } else if ((mBufsPtr[0] = mPool.Get())) {
+                mCount = 1;
+            }
+            UpdateDepotTime(theStart);
+            if (mCount <= 0) {
+                return false;
+            }
+            mCounters.mRefillCount++;
+            mCounters.mRefillBufferCount += mCount;
+            return true;
+        }
+        void FlushSelf(
+            int inCount)
+        {
+            if (inCount <= 0) {
+                return;
+            }
+            const int64_t theStart = microseconds();
+            InputIterator theIt(mBufsPtr);
+            mPool.Put(theIt, inCount);
+            UpdateDepotTime(theStart);
+            const int theCount = mCount - inCount;
+            if (0 < theCount) {
+                memmove(mBufsPtr, mBufsPtr + inCount,
+                    theCount * sizeof(mBufsPtr[0]));
+            }
+            mCount = theCount;
+            mCounters.mFlushCount++;
+            mCounters.mFlushBufferCount += inCount;
+        }
+        void UpdateDepotTime(
+            int64_t inStart)
+        {
+            const int64_t theTime = microseconds() - inStart;
+            mCounters.mDepotTimeUsec += theTime;
+            if (mCounters.mDepotMaxTimeUsec < theTime) {
+                mCounters.mDepotMaxTimeUsec = theTime;
+            }
+        }
+    private:
+        Magazine(
+            const Magazine& inMagazine);
+        Magazine& operator=(
+            const Magazine& inMagazine);
+    };
+    enum { kFlushWaitMaxUsec = 100 * 1000 };
+
+    QCIoBufferPool&       mPool;
+    const int             mMagazineSize;
+    QCMutex               mMutex;
+    pthread_key_t         mKey;
+    volatile unsigned int mFlushEpoch;
+    Magazine* volatile    mMagazineListPtr;
+
+    Magazine& GetMagazine()
+    {
+        Magazine* const thePtr = reinterpret_cast<Magazine*>(
+            pthread_getspecific(mKey));
+        return (thePtr ? *thePtr : CreateMagazine());
+    }
+    Magazine& CreateMagazine()
+    {
+        QCStMutexLocker theLocker(mMutex);
+        Magazine* thePtr = mMagazineListPtr;
+        while (thePtr && thePtr->IsOwned()) {
+            thePtr = thePtr->GetNextPtr();
+        }
+        if (thePtr) {
+            thePtr->SetOwned(true);
+        } else {
+            thePtr = new Magazine(mPool, *this, mMagazineSize);
+            thePtr->SetNextPtr(mMagazineListPtr);
+            SyncStoreRelease(mMagazineListPtr, thePtr);
+        }
+        theLocker.Unlock();
+        const int theErr = pthread_setspecific(mKey, thePtr);
+        if (theErr) {
+            QCUtils::FatalError("pthread_setspecific", theErr);
+        }
+        return *thePtr;
+    }
+    char* AllocateSlow(
+        Magazine& inMagazine)
+    {
+        // Other threads' magazines might have the remaining free buffers.
+        // Request all magazines to return the cached buffers to the pool on
+        // the next allocation or de-allocation, and wait for the buffers to
+        // become available.
+        Flush();
+        char* theBufPtr = inMagazine.AllocateFromPool();
+        for (int64_t theStart = microseconds();
+                ! theBufPtr &&
+                    microseconds() < theStart + kFlushWaitMaxUsec; ) {
+            usleep(1000);
+            theBufPtr = inMagazine.AllocateFromPool();
+        }
+        if (! theBufPtr) {
+            inMagazine.AllocFailure();
+        }
+        return theBufPtr;
+    }
+    void Retire(
+        Magazine& inMagazine)
+    {
+        inMagazine.Flush();
+        QCStMutexLocker theLocker(mMutex);
+        inMagazine.SetOwned(false);
+    }
+    static void ThreadExit(
+        void* inMagazinePtr)
+    {
+        if (! inMagazinePtr) {
+            return;
+        }
+        Magazine& theMagazine = *reinterpret_cast<Magazine*>(inMagazinePtr);
+        theMagazine.GetImpl().Retire(theMagazine);
+    }
+private:
+    Impl(
+        const Impl& inImpl);
+    Impl& operator=(
+        const Impl& inImpl);
+};
+
+IOBufferMagazineAllocator::IOBufferMagazineAllocator(
+    QCIoBufferPool& inPool,
+    int             inMagazineSize)
+    : libkfsio::IOBufferAllocator(),
+      mImpl(*(new Impl(inPool, inMagazineSize)))
+{}
+
+IOBufferMagazineAllocator::~IOBufferMagazineAllocator()
+{
+    delete &mImpl;
+}
+
+    size_t
+IOBufferMagazineAllocator::GetBufferSize() const
+{
+    return mImpl.GetBufferSize();
+}
+
+    char*
+IOBufferMagazineAllocator::Allocate()
+{
+    return mImpl.Allocate();
+}
+
+    void
+IOBufferMagazineAllocator::Deallocate(
+    char* inBufPtr)
+{
+    mImpl.Deallocate(inBufPtr);
+}
+
+    void
+IOBufferMagazineAllocator::Flush()
+{
+    mImpl.Flush();
+}
+
+    void
+IOBufferMagazineAllocator::GetCounters(
+    IOBufferMagazineAllocator::Counters& outCounters) const
+{
+    mImpl.GetCounters(outCounters);
+}
+
+    int
+IOBufferMagazineAllocator::GetCachedBufferCount() const
+{
+    return mImpl.GetCachedBufferCount();
+}
+
+    int
+IOBufferMagazineAllocator::GetMagazineSize() const
+{
+    return mImpl.GetMagazineSize();
+}
+
+} // namespace KFS
@@ -0,0 +1,120 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \file IOBufferMagazineAllocator.h
+// \brief Io buffer allocator with per thread buffer caches.
+//
+//----------------------------------------------------------------------------
+
+#ifndef IO_BUFFER_MAGAZINE_ALLOCATOR_H
+#define IO_BUFFER_MAGAZINE_ALLOCATOR_H
+
+#include "IOBuffer.h"
+
+#include <inttypes.h>
+
+class QCIoBufferPool;
+
+namespace KFS
+{
+
+// Magazine style io buffer allocator. Each thread that allocates or frees
+// buffers gets its own "magazine" -- a small stack of free buffers. Allocations
+// and de-allocations are served from the magazine with no locks or atomic
+// operations, and the buffer pool, the "depot", is only accessed when the
+// magazine becomes empty or full, in which case half of the magazine capacity
+// is moved to or from the pool with a single pool lock acquisition.
+// The buffers cached in the magazines are free, but not accounted as such by
+// the pool: GetCachedBufferCount() has to be added to the pool free count.
+// The cached buffers are returned to the pool on thread exit, and on the
+// thread's next allocation or de-allocation after Flush() call. If the pool
+// runs out of buffers, the allocation requests all magazines to be flushed,
+// and waits for up to 100 ms for the buffers to be returned to the pool.
+class IOBufferMagazineAllocator : public libkfsio::IOBufferAllocator
+{
+public:
+    struct Counters
+    {
+        typedef int64_t Counter;
+
+        Counter mAllocCount;
+        Counter mFreeCount;
+        Counter mMagazineAllocCount;
+        Counter mMagazineFreeCount;
+        Counter mRefillCount;
+        Counter mRefillBufferCount;
+        Counter mFlushCount;
+        Counter mFlushBufferCount;
+        Counter mDepotTimeUsec;
+        Counter mDepotMaxTimeUsec;
+        Counter mAllocFailureCount;
+        Counter mMagazineCount;
+        Counter mCachedBufferCount;
+
+        void Clear()
+        {
+            mAllocCount         = 0;
+            mFreeCount          = 0;
+            mMagazineAllocCount = 0;
+            mMagazineFreeCount  = 0;
+            mRefillCount        = 0;
+            mRefillBufferCount  = 0;
+            mFlushCount         = 0;
+            mFlushBufferCount   = 0;
+            mDepotTimeUsec      = 0;
+            mDepotMaxTimeUsec   = 0;
+            mAllocFailureCount  = 0;
+            mMagazineCount      = 0;
+            mCachedBufferCount  = 0;
+        }
+    };
+
+    IOBufferMagazineAllocator(
+        QCIoBufferPool& inPool,
+        int             inMagazineSize);
+    virtual ~IOBufferMagazineAllocator();
+    virtual size_t GetBufferSize() const;
+    virtual char* Allocate();
+    virtual void Deallocate(
+        char* inBufPtr);
+    // Return the calling thread's cached buffers to the pool, and request the
+    // other threads to do the same on their next allocation or
+    // de-allocation.
+    void Flush();
+    void GetCounters(
+        Counters& outCounters) const;
+    // Lockless, possibly stale, count of the free buffers cached in the
+    // magazines. Intended for heuristics and reporting only.
+    int GetCachedBufferCount() const;
+    int GetMagazineSize() const;
+private:
+    class Impl;
+    Impl& mImpl;
+private:
+    IOBufferMagazineAllocator(
+        const IOBufferMagazineAllocator& inAllocator);
+    IOBufferMagazineAllocator& operator=(
+        const IOBufferMagazineAllocator& inAllocator);
+};
+
+} // namespace KFS
+
+#endif /* IO_BUFFER_MAGAZINE_ALLOCATOR_H */
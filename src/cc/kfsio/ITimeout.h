@@ -94,6 +94,16 @@ public:
     }
     int64_t GetLastCallTimeMs() const
         { return mLastCall; }
+    /// Returns the time of the next Timeout() invocation, or -1 if the
+    /// handler is disabled or invoked on every net manager poll loop
+    /// iteration. Used by the net manager to compute poll timeout, in order
+    /// to support sub-second intervals.
+    int64_t GetNextCallTimeMs() const {
+        if (mDisabled || mIntervalMs <= 0) {
+            return -1;
+        }
+        return (mLastCall + mIntervalMs);
+    }
     /// This method will be invoked when a timeout occurs.
     virtual void Timeout() = 0;
 protected:
@@ -29,6 +29,7 @@
 #include "NetConnection.h"
 #include "common/kfsdecls.h"
 #include "common/MsgLogger.h"
+#include "common/time.h"
 #include "qcdio/QCUtils.h"
 
 #include <cerrno>
@@ -363,5 +364,11 @@ NetConnection::NetManagerEntry::TimeNow() const
     return (mNetManager ? mNetManager->Now() : time(0));
 }
 
+int64_t
+NetConnection::NetManagerEntry::TimeNowUsec() const
+{
+    return (mNetManager ? mNetManager->NowUsec() : microseconds());
+}
+
 
 }
@@ -352,6 +352,16 @@ public:
         return (mSock ? mSock->GetSocketError() : 0);
     }
 
+    TcpSocket* DupSocket(int* status = 0) const {
+        if (! mSock) {
+            if (status) {
+                *status = EBADF;
+            }
+            return 0;
+        }
+        return mSock->Dup(status);
+    }
+
     /// Close the connection.
     void Close(bool clearOutBufferFlag = true) {
         if (mFilter) {
@@ -448,6 +458,9 @@ public:
     time_t TimeNow() const
         { return mNetManagerEntry.TimeNow(); }
 
+    int64_t TimeNowUsec() const
+        { return mNetManagerEntry.TimeNowUsec(); }
+
     bool IsReadPending() const
         { return (mFilter && IsReadReady() && mFilter->IsReadPending()); }
 
@@ -487,6 +500,7 @@ public:
         bool IsNameResolutionPending() const
             { return mPendingNameResolutionFlag; }
         time_t TimeNow() const;
+        int64_t TimeNowUsec() const;
 
     private:
         bool             mIn:1;
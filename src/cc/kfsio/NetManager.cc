@@ -131,7 +131,10 @@ NetManager::NetManager(int timeoutMs)
       mPendingReadList(),
       mPendingUpdate(),
       mCurTimeoutHandler(0),
-      mEpollError()
+      mEpollError(),
+      mUsecTimerCount(0),
+      mUsecTimerWheel(mNowUsec),
+      mUsecTimerSlowWheel(mNowUsec)
 {
     TimeoutHandlers::Init(mTimeoutHandlers);
     mPendingUpdate.reserve(1 << 10);
@@ -270,6 +273,120 @@ NetManager::UnRegisterTimeoutHandler(ITimeout* handler)
     TimeoutHandlers::Remove(mTimeoutHandlers, *handler);
 }
 
+class NetManager::UsecTimerRun
+{
+public:
+    enum Type
+    {
+        kTypeRun,
+        kTypeCascade,
+        kTypeCancel
+    };
+    UsecTimerRun(NetManager& netManager, Type type)
+        : mNetManager(netManager),
+          mType(type)
+        {}
+    void operator()(UsecTimerEntry& timer) const
+    {
+        if (kTypeCancel == mType) {
+            mNetManager.CancelUsecTimer(timer);
+        } else if (kTypeCascade == mType ||
+                mNetManager.mNowUsec < timer.mExpirationUsec) {
+            mNetManager.ScheduleUsecTimerSelf(timer);
+        } else {
+            mNetManager.UsecTimerExpired(timer);
+        }
+    }
+private:
+    NetManager& mNetManager;
+    const Type  mType;
+};
+
+inline void
+NetManager::ScheduleUsecTimerSelf(UsecTimerEntry& timer)
+{
+    // Wheel schedule is "absolute", i.e. the next run time can be in the past.
+    if (timer.mExpirationUsec <
+            mUsecTimerWheel.GetNextRunTime() + kUsecTimerSpan) {
+        mUsecTimerWheel.Schedule(timer, timer.mExpirationUsec);
+    } else {
+        mUsecTimerSlowWheel.Schedule(timer, timer.mExpirationUsec);
+    }
+}
+
+void
+NetManager::ScheduleUsecTimer(UsecTimerEntry& timer, int64_t expirationUsec)
+{
+    if (mShutdownFlag) {
+        return;
+    }
+    if (! UsecTimerEntry::List::IsInList(timer)) {
+        mUsecTimerCount++;
+    }
+    timer.mExpirationUsec = expirationUsec;
+    ScheduleUsecTimerSelf(timer);
+}
+
+void
+NetManager::CancelUsecTimer(UsecTimerEntry& timer)
+{
+    if (UsecTimerEntry::List::IsInList(timer)) {
+        UsecTimerEntry::List::Remove(timer);
+        mUsecTimerCount--;
+        assert(0 <= mUsecTimerCount);
+    }
+}
+
+void
+NetManager::UsecTimerExpired(UsecTimerEntry& timer)
+{
+    CancelUsecTimer(timer);
+    static_cast<UsecTimer&>(timer).mObj.HandleEvent(
+        EVENT_INACTIVITY_TIMEOUT, 0);
+}
+
+void
+NetManager::RunUsecTimers()
+{
+    if (mUsecTimerCount <= 0) {
+        // Keep the wheels current while empty.
+        mUsecTimerWheel.SetNextRunTime(mNowUsec);
+        mUsecTimerSlowWheel.SetNextRunTime(mNowUsec);
+        return;
+    }
+    UsecTimerRun run(*this, UsecTimerRun::kTypeRun);
+    UsecTimerRun cascade(*this, UsecTimerRun::kTypeCascade);
+    mUsecTimerWheel.Run(mNowUsec, run);
+    mUsecTimerSlowWheel.Run(mNowUsec, cascade);
+    // Dispatch entries that expired while in the slow wheel, if any.
+    mUsecTimerWheel.Run(mNowUsec, run);
+}
+
+int
+NetManager::GetPollTimeout()
+{
+    int64_t nextUsec = mNowUsec + int64_t(mTimeoutMs) * 1000;
+    // Invoked after all handlers and timers ran, therefore the intervals
+    // changed by the handlers, or by the event dispatch are accounted for.
+    ITimeout* const front = TimeoutHandlers::Front(mTimeoutHandlers);
+    ITimeout*       cur   = front;
+    while (cur) {
+        const int64_t nextMs = cur->GetNextCallTimeMs();
+        if (0 <= nextMs && nextMs * 1000 < nextUsec) {
+            nextUsec = nextMs * 1000;
+        }
+        if (front == (cur = &ITimeout::List::GetNext(*cur))) {
+            break;
+        }
+    }
+    if (0 < mUsecTimerCount) {
+        nextUsec = mUsecTimerWheel.GetNextExpirationTime(nextUsec);
+        nextUsec = mUsecTimerSlowWheel.GetNextExpirationTime(nextUsec);
+    }
+    // Round up, poll timeout resolution is 1 ms.
+    return (nextUsec <= mNowUsec ? 0 : int((nextUsec - mNowUsec + 999) / 1000));
+}
+
 inline void
 NetManager::UpdateTimer(NetConnection::NetManagerEntry& entry, int timeOut)
 {
@@ -481,6 +598,24 @@ NetManager::Wakeup()
     mPoll.Wakeup();
 }
 
+void
+NetManager::SetBusyPoll(int usec)
+{
+    mPoll.SetBusyPoll(usec);
+}
+
+int
+NetManager::GetBusyPoll() const
+{
+    return mPoll.GetBusyPoll();
+}
+
+void
+NetManager::GetPollCounters(NetManager::PollCounters& counters) const
+{
+    mPoll.GetCounters(counters);
+}
+
 inline void
 GetCurrentTime(int64_t& sec, int64_t& usec)
 {
@@ -551,7 +686,7 @@ NetManager::MainLoop(
             dispatcher->DispatchEnd();
         }
         const int timeout = PendingReadList::IsInList(mPendingReadList) ?
-            0 : mTimeoutMs;
+            0 : GetPollTimeout();
         const int fdCount = mConnectionsCount + 1;
         assert(mPendingUpdate.empty());
         mPollFlag = true;
@@ -690,6 +825,8 @@ NetManager::MainLoop(
         mTimerRunningFlag = false;
         mLastTimerTime = mNow;
         mTimerWheelBucketItr = mRemove.end();
+        RunUsecTimers();
+        mRemove.clear();
         if (runOnceFlag) {
             break;
         }
@@ -739,6 +876,16 @@ NetManager::CleanUp(bool childAtForkFlag, bool onlyCloseFdFlag)
     while (! TimeoutHandlers::IsEmpty(mTimeoutHandlers)) {
         TimeoutHandlers::PopFront(mTimeoutHandlers);
     }
+    if (0 < mUsecTimerCount) {
+        // Traverse all buckets, and remove all timers with no dispatch.
+        UsecTimerRun cancel(*this, UsecTimerRun::kTypeCancel);
+        mUsecTimerWheel.Run(mUsecTimerWheel.GetNextRunTime() +
+            int64_t(kUsecTimerResolution) * kUsecTimerWheelSize, cancel);
+        mUsecTimerSlowWheel.Run(mUsecTimerSlowWheel.GetNextRunTime() +
+            int64_t(kUsecTimerResolution) * kUsecTimerWheelSize *
+            kUsecTimerSlowWheelSize, cancel);
+        assert(0 == mUsecTimerCount);
+    }
     if (childAtForkFlag) {
         mPoll.Close();
     }
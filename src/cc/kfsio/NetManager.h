@@ -33,11 +33,12 @@
 #include "NetConnection.h"
 #include "ITimeout.h"
 #include "Resolver.h"
+#include "common/TimerWheel.h"
+#include "qcdio/QCFdPoll.h"
 
 #include <list>
 #include <vector>
 
-class QCFdPoll;
 class QCMutex;
 
 namespace KFS
@@ -55,8 +56,9 @@ using std::vector;
 ///
 /// The net manager also provides support for timeout notification, and
 /// connection inactivity timeout.
-/// In the present implemenation the worst case timeout resolution is
-/// mSelectTimeout.
+/// The connection inactivity timeout resolution is 1 sec. The ITimeout
+/// handlers and UsecTimer timers have 1 ms resolution: the poll timeout is
+/// adjusted to the next handler / timer expiration time.
 ///
 //
 
@@ -130,6 +132,12 @@ public:
         { return mMaxAcceptsPerRead; }
     void SetMaxAcceptsPerRead(int maxAcceptsPerRead)
         { mMaxAcceptsPerRead = maxAcceptsPerRead <= 0 ? 1 : maxAcceptsPerRead; }
+    /// Spin polling with no wait for up to the specified number of
+    /// microseconds before blocking, 0 turns busy poll off.
+    void SetBusyPoll(int usec);
+    int GetBusyPoll() const;
+    typedef QCFdPoll::Counters PollCounters;
+    void GetPollCounters(PollCounters& counters) const;
     void ChildAtFork(bool onlyCloseFdFlag = true);
     void UpdateTimeNow() { mNow = time(0); }
     void SetTimeNow(time_t now) { mNow = now; }
@@ -223,6 +231,73 @@ public:
         Timer& operator=(const Timer&);
     };
 
+private:
+    class UsecTimerEntry
+    {
+    public:
+        typedef QCDLListOp<UsecTimerEntry> List;
+
+        UsecTimerEntry()
+            : mExpirationUsec(-1)
+            { List::Init(*this); }
+        ~UsecTimerEntry()
+            { assert(! List::IsInList(*this)); }
+    private:
+        int64_t         mExpirationUsec;
+        UsecTimerEntry* mPrevPtr[1];
+        UsecTimerEntry* mNextPtr[1];
+
+        friend class NetManager;
+        friend class QCDLListOp<UsecTimerEntry>;
+    private:
+        UsecTimerEntry(const UsecTimerEntry&);
+        UsecTimerEntry& operator=(const UsecTimerEntry&);
+    };
+public:
+    // One shot sub-second timer, with no fd/socket. The timers are kept in two
+    // level (hierarchical) timer wheel: 1 ms resolution ~1 sec span first
+    // level, and 0.5 sec resolution second level. Schedule and cancel are
+    // O(1), the expired timers are dispatched in batch after poll events
+    // processing by invoking obj.HandleEvent(EVENT_INACTIVITY_TIMEOUT, 0).
+    // The poll timeout is set to the next timer expiration time, found by
+    // the wheels' non empty bucket bitmaps. Like the rest of the net manager
+    // methods, the timer methods must be invoked from the net manager thread.
+    class UsecTimer : private UsecTimerEntry
+    {
+    public:
+        UsecTimer(NetManager& netManager, KfsCallbackObj& obj)
+            : UsecTimerEntry(),
+              mNetManager(netManager),
+              mObj(obj)
+            {}
+        ~UsecTimer()
+            { UsecTimer::Cancel(); }
+        // Rescheduling already scheduled timer is permitted.
+        void ScheduleIn(int64_t usec)
+        {
+            mNetManager.ScheduleUsecTimer(
+                *this, mNetManager.NowUsec() + (usec < 0 ? int64_t(0) : usec));
+        }
+        void ScheduleAt(int64_t expirationUsec)
+            { mNetManager.ScheduleUsecTimer(*this, expirationUsec); }
+        void Cancel()
+            { mNetManager.CancelUsecTimer(*this); }
+        bool IsScheduled() const
+            { return List::IsInList(*this); }
+        int64_t GetExpirationTime() const
+            { return (IsScheduled() ? mExpirationUsec : int64_t(-1)); }
+    private:
+        NetManager&     mNetManager;
+        KfsCallbackObj& mObj;
+
+        friend class NetManager;
+    private:
+        UsecTimer(const UsecTimer&);
+        UsecTimer& operator=(const UsecTimer&);
+    };
+    int64_t GetUsecTimerCount() const
+        { return mUsecTimerCount; }
+
     /// Method used by NetConnection only.
     static void Update(NetManagerEntry& entry, int fd,
         bool resetTimer);
@@ -233,8 +308,34 @@ private:
     typedef NetManagerEntry::PendingReadList PendingReadList;
     typedef vector<NetConnection*>           PendingUpdate;
     enum { kTimerWheelSize = (1 << 8) };
+    enum
+    {
+        kUsecTimerResolution    = 1000,
+        kUsecTimerWheelSize     = 1 << 10,
+        kUsecTimerSpan          =
+            kUsecTimerResolution * (kUsecTimerWheelSize - 1),
+        kUsecTimerSlowWheelSize = 1 << 10
+    };
+    typedef TimerWheel<
+        UsecTimerEntry,
+        UsecTimerEntry::List,
+        int64_t,
+        kUsecTimerWheelSize,
+        kUsecTimerResolution
+    > UsecTimerWheel;
+    // Slow wheel resolution must be less than the fast wheel span, in order to
+    // cascade entries into the fast wheel before these expire.
+    typedef TimerWheel<
+        UsecTimerEntry,
+        UsecTimerEntry::List,
+        int64_t,
+        kUsecTimerSlowWheelSize,
+        kUsecTimerResolution * kUsecTimerWheelSize / 2
+    > UsecTimerSlowWheel;
     class ResolverRequest;
     friend class ResolverRequest;
+    class UsecTimerRun;
+    friend class UsecTimerRun;
 
     List            mRemove;
     List::iterator  mTimerWheelBucketItr;
@@ -278,6 +379,9 @@ private:
     ITimeout*       mTimeoutHandlers[1];
     List            mEpollError;
     List            mTimerWheel[kTimerWheelSize + 1];
+    int64_t         mUsecTimerCount;
+    UsecTimerWheel  mUsecTimerWheel;
+    UsecTimerSlowWheel mUsecTimerSlowWheel;
 
     void CheckIfOverloaded();
     void CleanUp(bool childAtForkFlag = false, bool onlyCloseFdFlag = false);
@@ -286,6 +390,12 @@ private:
         bool resetTimer, bool epollError);
     void PollRemove(int fd);
     int EnqueueSelf(Resolver::Request& req, int timeout);
+    void ScheduleUsecTimer(UsecTimerEntry& timer, int64_t expirationUsec);
+    void CancelUsecTimer(UsecTimerEntry& timer);
+    inline void ScheduleUsecTimerSelf(UsecTimerEntry& timer);
+    void RunUsecTimers();
+    void UsecTimerExpired(UsecTimerEntry& timer);
+    int GetPollTimeout();
     static inline void NameResolutionDone(const NetConnectionPtr& conn,
         const ServerLocation& loc, int status, const char* errMsg);
 private:
@@ -50,6 +50,11 @@
 #include <string>
 #include <algorithm>
 
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send) && \
+    defined(BIO_get_ktls_recv)
+#   define KFS_SSL_FILTER_KTLS
+#endif
+
 namespace KFS
 {
 using std::string;
@@ -237,6 +242,22 @@ public:
                 | (inPskOnlyFlag ? long(SSL_OP_NO_TICKET) : long(0))
 #endif
         ));
+        if (inParams.getValue(
+                theParamName.Truncate(thePrefLen).Append("ktls"), 0) != 0) {
+#ifdef KFS_SSL_FILTER_KTLS
+            // Request kernel TLS offload. OpenSSL installs the session keys
+            // into the socket after the handshake, if the kernel and the
+            // negotiated cipher support it, otherwise it silently falls back to
+            // the user space record layer.
+            SSL_CTX_set_options(theRetPtr, SSL_OP_ENABLE_KTLS);
+#else
+            KFS_LOG_STREAM_WARN <<
+                "kernel TLS is not supported by the OpenSSL library,"
+                " parameter: " << theParamName <<
+                " is ignored" <<
+            KFS_LOG_EOM;
+#endif
+        }
         SSL_CTX_set_timeout(
                 theRetPtr,
                 inParams.getValue(
@@ -429,7 +450,10 @@ public:
           mSslErrorFlag(false),
           mShutdownCompleteFlag(false),
           mVerifyOrGetPskInvokedFlag(false),
-          mRenegotiationPendingFlag(false)
+          mRenegotiationPendingFlag(false),
+          mKtlsCheckedFlag(false),
+          mKtlsSendFlag(false),
+          mKtlsRecvFlag(false)
     {
         if (! mSslPtr) {
             return;
@@ -555,6 +579,21 @@ public:
         if (inIoBuffer.IsEmpty()) {
             return 0;
         }
+        if (mKtlsSendFlag && mError == 0 && ! mSslEofFlag &&
+                ! mSslErrorFlag && ! SSL_want_write(mSslPtr)) {
+            // The kernel frames and encrypts application data records, write
+            // directly from the io buffer with writev, the same way as with no
+            // filter. Pending ssl writes, if any, are flushed by SSL_write()
+            // below first, in order to preserve the record order. Once the
+            // peer's shutdown or an ssl error is seen, the writes go through
+            // SSL_write() in order to report the error the same way as with
+            // user space tls.
+            const int theWrCnt = inIoBuffer.Write(inSocket.GetFd());
+            if (0 < theWrCnt) {
+                globals().ctrNetKtlsBytesWritten.Update(theWrCnt);
+            }
+            return theWrCnt;
+        }
         ERR_clear_error();
         int theWrCnt = 0;
         for (IOBuffer::iterator theIt = inIoBuffer.begin();
@@ -574,6 +613,9 @@ public:
         }
         if (0 < theWrCnt) {
             globals().ctrNetBytesWritten.Update(theWrCnt);
+            if (mKtlsSendFlag) {
+                globals().ctrNetKtlsBytesWritten.Update(theWrCnt);
+            }
             return theWrCnt;
         }
         return SslRetToErr(theRet);
@@ -706,6 +748,11 @@ public:
             thePtr += theRet;
         }
         if (theStartPtr < thePtr) {
+            if (mKtlsRecvFlag) {
+                // The records are decrypted by the kernel, SSL_read() is still
+                // used in order to handle non application data records.
+                globals().ctrNetKtlsBytesRead.Update(thePtr - theStartPtr);
+            }
             return (int)(thePtr - theStartPtr);
         }
         const int theErr = SslRetToErr(theRet);
@@ -725,7 +772,8 @@ public:
     }
     virtual bool RenewSession()
     {
-        if (! mSslPtr || mError != 0) {
+        if (! mSslPtr || mError != 0 || mKtlsSendFlag || mKtlsRecvFlag) {
+            // Renegotiation is not supported with kernel TLS offload.
             return false;
         }
         mRenegotiationPendingFlag =
@@ -814,6 +862,9 @@ private:
     bool              mShutdownCompleteFlag:1;
     bool              mVerifyOrGetPskInvokedFlag:1;
     bool              mRenegotiationPendingFlag:1;
+    bool              mKtlsCheckedFlag:1;
+    bool              mKtlsSendFlag:1;
+    bool              mKtlsRecvFlag:1;
 
     struct OpenSslInit
     {
@@ -1078,6 +1129,35 @@ private:
             theTimeValidFlag
         );
     }
+    void UpdateKtlsState()
+    {
+        if (mKtlsCheckedFlag) {
+            return;
+        }
+        mKtlsCheckedFlag = true;
+#ifdef KFS_SSL_FILTER_KTLS
+        if ((SSL_get_options(mSslPtr) & SSL_OP_ENABLE_KTLS) == 0) {
+            return;
+        }
+        mKtlsSendFlag = BIO_get_ktls_send(SSL_get_wbio(mSslPtr)) != 0;
+        mKtlsRecvFlag = BIO_get_ktls_recv(SSL_get_rbio(mSslPtr)) != 0;
+        if (mKtlsSendFlag) {
+            globals().ctrNetKtlsSendSessions.Update(1);
+        }
+        if (mKtlsRecvFlag) {
+            globals().ctrNetKtlsRecvSessions.Update(1);
+        }
+        if (! mKtlsSendFlag || ! mKtlsRecvFlag) {
+            globals().ctrNetKtlsFallbacks.Update(1);
+        }
+        KFS_LOG_STREAM_DEBUG <<
+            "kernel tls:"
+            " send: "    << mKtlsSendFlag <<
+            " receive: " << mKtlsRecvFlag <<
+            " cipher: "  << SSL_get_cipher_name(mSslPtr) <<
+        KFS_LOG_EOM;
+#endif
+    }
     int DoHandshake()
     {
         if (SSL_is_init_finished(mSslPtr)) {
@@ -1087,6 +1167,7 @@ private:
             if (! mServerFlag && ! mSessionStoredFlag) {
                 StoreClientSession();
             }
+            UpdateKtlsState();
             return 0;
         }
         if (mRenegotiationPendingFlag) {
@@ -1101,6 +1182,7 @@ private:
             }
             // Try to update in case of renegotiation.
             StoreClientSession();
+            UpdateKtlsState();
             return 0;
         }
         const int theErr = SslRetToErr(theRet);
@@ -1245,10 +1327,24 @@ private:
             return -EFAULT;
         }
         if (! SSL_is_init_finished(mSslPtr)) {
+#ifdef KFS_SSL_FILTER_KTLS
+            // The connection continues in clear text after shutdown, do not
+            // let the handshake install the session keys into the socket.
+            SSL_clear_options(mSslPtr, SSL_OP_ENABLE_KTLS);
+#endif
             // Always run full handshake.
             // Wait for handshake to complete, then issue shutdown.
             return 0;
         }
+        UpdateKtlsState();
+        if (mKtlsSendFlag || mKtlsRecvFlag) {
+            // Kernel tls stays attached to the socket after ssl shutdown,
+            // therefore clear text communication is not possible.
+            KFS_LOG_STREAM_ERROR <<
+                "ssl shutdown is not supported with kernel tls offload" <<
+            KFS_LOG_EOM;
+            return -EOPNOTSUPP;
+        }
         ERR_clear_error();
         int theRet = SSL_shutdown(mSslPtr);
         if (theRet == 0) {
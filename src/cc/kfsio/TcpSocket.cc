@@ -89,6 +89,7 @@ SetSockOpt(int fd, int level, int name, const T& val)
 int TcpSocket::sRecvBufSize    = 64 << 10;
 int TcpSocket::sSendBufSize    = 64 << 10;
 int TcpSocket::sMaxOpenSockets =  1 << (sizeof(int) * 8 - 2);
+int TcpSocket::sBusyPollUsec    = 0;
 
 struct TcpSocket::Address
 {
@@ -426,6 +427,29 @@ TcpSocket::Accept(int* status /* = 0 */)
     return accSock;
 }
 
+TcpSocket*
+TcpSocket::Dup(int* status /* = 0 */)
+{
+    int err = 0;
+    int fd  = -1;
+    if (mSockFd < 0) {
+        err = EBADF;
+    } else if (sMaxOpenSockets <= globals().ctrOpenNetFds.GetValue()) {
+        err = ENFILE;
+    } else if ((fd = fcntl(mSockFd, F_DUPFD_CLOEXEC, 0)) < 0) {
+        err = errno;
+        Perror("dup", err);
+    }
+    if (status) {
+        *status = err;
+    }
+    if (fd < 0) {
+        return 0;
+    }
+    UpdateSocketCount(1);
+    return new TcpSocket(fd, mType);
+}
+
 int
 TcpSocket::Connect(
     const TcpSocket::Address& remoteAddr, bool nonblockingConnect)
@@ -508,6 +532,13 @@ TcpSocket::SetupSocket()
     if (SetSockOpt(mSockFd, IPPROTO_TCP, TCP_NODELAY, flag)) {
         Perror("setsockopt TCP_NODELAY");
     }
+#ifdef SO_BUSY_POLL
+    const int busyPollUsec = sBusyPollUsec;
+    if (0 < busyPollUsec &&
+            SetSockOpt(mSockFd, SOL_SOCKET, SO_BUSY_POLL, busyPollUsec)) {
+        Perror("setsockopt SO_BUSY_POLL");
+    }
+#endif
 
 }
 
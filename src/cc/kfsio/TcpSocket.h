@@ -74,6 +74,11 @@ public:
     ///
     TcpSocket* Accept(int* status = 0);
 
+    /// Duplicate the socket descriptor, presumably the listening socket,
+    /// in order to accept connections on the same socket from more than one
+    /// net manager / thread. The caller owns the returned socket.
+    TcpSocket* Dup(int* status = 0);
+
     /// Connect to the remote address.  If non-blocking connect is
     /// set, the socket is first marked non-blocking and then we do
     /// the connect call.  Then, you use select() to check for connect()
@@ -123,6 +128,9 @@ public:
     static void SetDefaultRecvBufSize(int size) { sRecvBufSize = size; }
     static void SetDefaultSendBufSize(int size) { sSendBufSize = size; }
     static void SetOpenLimit(int limit) { sMaxOpenSockets = limit; }
+    /// SO_BUSY_POLL socket option value in microseconds, 0 -- not set.
+    static int GetDefaultBusyPollUsec() { return sBusyPollUsec; }
+    static void SetDefaultBusyPollUsec(int usec) { sBusyPollUsec = usec; }
 
 private:
     int  mSockFd;
@@ -143,6 +151,7 @@ private:
     static int sRecvBufSize;
     static int sSendBufSize;
     static int sMaxOpenSockets;
+    static int sBusyPollUsec;
 };
 
 typedef boost::shared_ptr<TcpSocket> TcpSocketPtr;
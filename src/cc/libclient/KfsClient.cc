@@ -695,6 +695,41 @@ KfsClient::Read(int fd, char *buf, size_t numBytes)
     return mImpl->Read(fd, buf, numBytes);
 }
 
+KfsClient::AsyncIoQueue*
+KfsClient::CreateAsyncIoQueue()
+{
+    return mImpl->CreateAsyncIoQueue();
+}
+
+void
+KfsClient::DisposeAsyncIoQueue(KfsClient::AsyncIoQueue* queue)
+{
+    mImpl->DisposeAsyncIoQueue(queue);
+}
+
+int
+KfsClient::AsyncPRead(KfsClient::AsyncIoQueue* queue, int fd, chunkOff_t pos,
+    char* buf, size_t numBytes, void* userData)
+{
+    return mImpl->AsyncPRead(queue, fd, pos, buf, numBytes, userData);
+}
+
+int
+KfsClient::GetAsyncIoCompletions(KfsClient::AsyncIoQueue* queue,
+    KfsClient::AsyncIoCompletion* completions, int maxCount,
+    int minCount, int timeoutMs)
+{
+    return mImpl->GetAsyncIoCompletions(
+        queue, completions, maxCount, minCount, timeoutMs);
+}
+
+int
+KfsClient::PReadV(int fd, KfsClient::ReadRange* ranges, int count,
+    size_t coalesceGap)
+{
+    return mImpl->PReadV(fd, ranges, count, coalesceGap);
+}
+
 ssize_t
 KfsClient::Write(int fd, const char *buf, size_t numBytes)
 {
@@ -951,6 +986,12 @@ KfsClient::SetFileAttributeRevalidateTime(int secs)
     mImpl->SetFileAttributeRevalidateTime(secs);
 }
 
+int
+KfsClient::GetFileAttributeRevalidateTime() const
+{
+    return mImpl->GetFileAttributeRevalidateTime();
+}
+
 int
 KfsClient::Chmod(int fd, kfsMode_t mode)
 {
@@ -1059,6 +1100,12 @@ KfsClient::SetCloseWriteOnRead(bool inFlag)
     mImpl->SetCloseWriteOnRead(inFlag);
 }
 
+int
+KfsClient::FlushWriteBack()
+{
+    return mImpl->FlushWriteBack();
+}
+
 static int
 LoadConfig(const char* configEnvName, const char* cfg, Properties& props)
 {
@@ -1445,6 +1492,506 @@ KfsClientImpl::ClientsList::Instance()
 KfsClientImpl::ClientsList* KfsClientImpl::ClientsList::sInstance =
     &KfsClientImpl::ClientsList::Instance();
 
+// Process wide pool of meta server connections. The clients with the same
+// meta server location, configuration, and rpc headers share single protocol
+// worker, and its meta server connection. The meta ops issued by different
+// clients are pipelined over the shared connection, and the responses are
+// matched to the ops by the op sequence number, therefore the ops can complete
+// in any order. The worker is stopped and deleted when the last client
+// releases it.
+class KfsClientImpl::MetaConnectionPool
+{
+public:
+    static KfsProtocolWorker* Acquire(KfsClientImpl& client)
+        { return Instance().AcquireSelf(client); }
+    static void Release(KfsProtocolWorker* worker)
+        { Instance().ReleaseSelf(worker); }
+private:
+    class Entry
+    {
+    public:
+        Entry()
+            : mWorker(0),
+              mAuthCtx(),
+              mRefCount(0)
+            {}
+        ~Entry()
+        {
+            if (mWorker) {
+                mWorker->Stop();
+                delete mWorker;
+            }
+            mAuthCtx.Clear();
+        }
+        KfsProtocolWorker* mWorker;
+        ClientAuthContext  mAuthCtx;
+        int                mRefCount;
+    private:
+        Entry(const Entry&);
+        Entry& operator=(const Entry&);
+    };
+    typedef map<string, Entry*> Entries;
+
+    QCMutex mMutex;
+    Entries mEntries;
+
+    static MetaConnectionPool* sInstance;
+
+    MetaConnectionPool()
+        : mMutex(),
+          mEntries()
+        {}
+    ~MetaConnectionPool()
+        { assert(! "unexpected invocation"); }
+    KfsProtocolWorker* AcquireSelf(KfsClientImpl& client)
+    {
+        assert(client.mMutex.IsOwned());
+        string key;
+        GetKey(client, key);
+        QCStMutexLocker locker(mMutex);
+        Entries::iterator const it = mEntries.find(key);
+        if (it != mEntries.end()) {
+            it->second->mRefCount++;
+            return it->second->mWorker;
+        }
+        Entry* const entry = new Entry();
+        const char* const kAuthParamPrefix =
+            KfsClient::GetClientAuthParamsPrefix();
+        string            errMsg;
+        const bool        kVerifyFlag = true;
+        const int         err         = entry->mAuthCtx.SetParameters(
+            kAuthParamPrefix, client.mConfig, 0, &errMsg, kVerifyFlag);
+        if (err != 0) {
+            KFS_LOG_STREAM_ERROR <<
+                "meta server connection pool:"
+                " authentication context initialization error: " <<
+                errMsg <<
+                " using dedicated connection" <<
+            KFS_LOG_EOM;
+            delete entry;
+            return 0;
+        }
+        entry->mWorker = client.CreateProtocolWorker(
+            entry->mAuthCtx.IsEnabled() ? &entry->mAuthCtx : 0);
+        entry->mRefCount = 1;
+        mEntries.insert(make_pair(key, entry));
+        return entry->mWorker;
+    }
+    void ReleaseSelf(KfsProtocolWorker* worker)
+    {
+        if (! worker) {
+            return;
+        }
+        Entry* entry = 0;
+        {
+            QCStMutexLocker locker(mMutex);
+            for (Entries::iterator it = mEntries.begin();
+                    it != mEntries.end();
+                    ++it) {
+                if (it->second->mWorker != worker) {
+                    continue;
+                }
+                if (--(it->second->mRefCount) <= 0) {
+                    entry = it->second;
+                    mEntries.erase(it);
+                }
+                break;
+            }
+        }
+        // Stop the worker thread with no mutex held.
+        delete entry;
+    }
+    static void GetKey(const KfsClientImpl& client, string& key)
+    {
+        ostringstream os;
+        os <<
+            client.mMetaServerLoc.hostname << ":" <<
+                client.mMetaServerLoc.port << "\n" <<
+            client.mDefaultMetaOpTimeout   << " " <<
+            client.mMaxNumRetriesPerOp     << " " <<
+            client.mRetryDelaySec          << "\n" <<
+            client.mCommonRpcHdrs          << "\n" <<
+            client.mShortCommonRpcHdrs     << "\n"
+        ;
+        key = os.str();
+        client.mConfig.getList(key, string(), "\n");
+    }
+    static MetaConnectionPool& Instance();
+};
+
+KfsClientImpl::MetaConnectionPool&
+KfsClientImpl::MetaConnectionPool::Instance()
+{
+    static bool sOnce = true;
+    if (sOnce) {
+        sOnce = false;
+        static struct { char alloc[sizeof(MetaConnectionPool)]; } sStorage;
+        sInstance = new (&sStorage) MetaConnectionPool();
+    }
+    return *sInstance;
+}
+KfsClientImpl::MetaConnectionPool*
+    KfsClientImpl::MetaConnectionPool::sInstance =
+    &KfsClientImpl::MetaConnectionPool::Instance();
+
+// Concurrent snapshot of the attribute cache entries with absolute path names,
+// used by Stat() to avoid acquiring the client mutex, and waiting for the meta
+// server ops issued by other threads to complete.
+// The entry is valid until the attribute cache entry it was created from
+// expires, and the "epoch" remains the same. The epoch is incremented, with
+// the client mutex held, every time the attribute cache, or the meta server
+// name space might be modified by the client.
+class KfsClientImpl::StatCache
+{
+public:
+    typedef int64_t Epoch;
+
+    StatCache()
+        : mEpoch(1)
+        {}
+    void Invalidate()
+        { SyncAddAndFetch(mEpoch, Epoch(1)); }
+    Epoch GetEpoch() const
+        { return SyncLoadAcquire(mEpoch); }
+    bool Get(const char* path, bool computeFilesizeFlag, time_t now,
+        KfsFileAttr& attr)
+    {
+        const size_t   len    = strlen(path);
+        Stripe&        stripe = GetStripe(path, len);
+        const string   key(path, len);
+        QCStMutexLocker locker(stripe.mMutex);
+        Entries::const_iterator const it = stripe.mEntries.find(key);
+        if (it == stripe.mEntries.end()) {
+            return false;
+        }
+        const Entry& entry = it->second;
+        if (entry.mEpoch != GetEpoch() || entry.mExpirationTime < now ||
+                (computeFilesizeFlag && ! entry.mAttr.isDirectory &&
+                    entry.mAttr.fileSize < 0)) {
+            return false;
+        }
+        attr = entry.mAttr;
+        return true;
+    }
+    void Put(const string& path, const KfsFileAttr& attr,
+        time_t expirationTime, Epoch epoch)
+    {
+        if (epoch != GetEpoch()) {
+            return; // Invalidated while the attributes were being looked up.
+        }
+        Stripe& stripe = GetStripe(path.data(), path.size());
+        QCStMutexLocker locker(stripe.mMutex);
+        if (kMaxStripeSize <= stripe.mEntries.size()) {
+            for (Entries::iterator it = stripe.mEntries.begin();
+                    it != stripe.mEntries.end(); ) {
+                if (it->second.mEpoch != epoch) {
+                    stripe.mEntries.erase(it++);
+                } else {
+                    ++it;
+                }
+            }
+            if (kMaxStripeSize <= stripe.mEntries.size()) {
+                stripe.mEntries.clear();
+            }
+        }
+        Entry& entry = stripe.mEntries[path];
+        entry.mAttr           = attr;
+        entry.mExpirationTime = expirationTime;
+        entry.mEpoch          = epoch;
+    }
+private:
+    enum { kStripeCount   = 64 };
+    enum { kMaxStripeSize = 256 };
+    struct Entry
+    {
+        Entry()
+            : mAttr(),
+              mExpirationTime(0),
+              mEpoch(0)
+            {}
+        KfsFileAttr mAttr;
+        time_t      mExpirationTime;
+        Epoch       mEpoch;
+    };
+    typedef map<string, Entry> Entries;
+    struct Stripe
+    {
+        Stripe()
+            : mMutex(),
+              mEntries()
+            {}
+        QCMutex mMutex;
+        Entries mEntries;
+    };
+
+    volatile Epoch mEpoch;
+    Stripe         mStripes[kStripeCount];
+
+    Stripe& GetStripe(const char* path, size_t len)
+        { return mStripes[HsiehHash(path, len) % kStripeCount]; }
+private:
+    StatCache(const StatCache&);
+    StatCache& operator=(const StatCache&);
+};
+
+static inline bool
+IsReadOnlyMetaOp(const KfsOp& op)
+{
+    switch (op.op) {
+        case CMD_GETALLOC:
+        case CMD_GETLAYOUT:
+        case CMD_LOOKUP:
+        case CMD_READDIR:
+        case CMD_READDIRPLUS:
+        case CMD_GETDIRSUMMARY:
+        case CMD_GETPATHNAME:
+        case CMD_LEASE_ACQUIRE:
+        case CMD_LEASE_RENEW:
+        case CMD_LEASE_RELINQUISH:
+        case CMD_AUTHENTICATE:
+        case CMD_META_PING:
+        case CMD_META_STATS:
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+inline void
+KfsClientImpl::InvalidateStatCache()
+{
+    assert(mMutex.IsOwned());
+    mStatCache->Invalidate();
+}
+
+// Sub directory and file counts of the directory are about to change, or
+// have changed: the stat cache entries might have stale counts.
+inline void
+KfsClientImpl::SetStaleSubCounts(KfsClientImpl::FAttr& fa)
+{
+    fa.staleSubCountsFlag = true;
+    InvalidateStatCache();
+}
+
+// The epoch must be obtained prior to the attribute lookup, in order to
+// discard the entry if the cache was invalidated while the lookup was in
+// flight, including the invalidation by the write back completion that runs
+// without the client mutex held.
+void
+KfsClientImpl::PublishStat(const char* pathname, const KfsClientImpl::FAttr& fa,
+    const KfsFileAttr& attr, int64_t epoch)
+{
+    assert(mMutex.IsOwned());
+    if (! mUseStatCacheFlag || ! pathname || pathname[0] != '/' ||
+            fa.staleSubCountsFlag || fa.nameIt == mPathCacheNone ||
+            fa.nameIt->first != pathname ||
+            fa.generation != mFAttrCacheGeneration ||
+            mFileAttributeRevalidateTime <= 0) {
+        return;
+    }
+    mStatCache->Put(fa.nameIt->first, attr,
+        fa.validatedTime + mFileAttributeRevalidateTime, epoch);
+}
+
+// Write back close of the files opened for write. The write close requests
+// are queued to the protocol worker, and their completion is tracked here, in
+// order to allow close to return without waiting for the pending writes, chunk
+// allocation, chunk close, and the file size update to complete.
+// The number of closes in flight is limited in order to bound the amount of
+// memory used by the pending writes.
+// The close completion invalidates the stat cache, as the file size and
+// modification time change when the close completes.
+class KfsClientImpl::WriteBack
+{
+public:
+    WriteBack(StatCache& statCache)
+        : mStatCache(statCache),
+          mMutex(),
+          mCondVar(),
+          mPaths(),
+          mStatus(0),
+          mInFlightCount(0),
+          mCloseCount(0),
+          mErrorCount(0)
+        {}
+    ~WriteBack()
+        { assert(0 == mInFlightCount); }
+    void Close(
+        KfsProtocolWorker&              worker,
+        KfsProtocolWorker::RequestType  type,
+        KfsProtocolWorker::FileInstance instance,
+        KfsProtocolWorker::FileId       fileId,
+        const string&                   path,
+        int                             maxInFlight)
+    {
+        Request& req = *(new Request(*this, type, instance, fileId, path));
+        {
+            QCStMutexLocker lock(mMutex);
+            while (maxInFlight <= mInFlightCount) {
+                mCondVar.Wait(mMutex);
+            }
+            mInFlightCount++;
+            mCloseCount++;
+            mPaths[path]++;
+        }
+        KFS_LOG_STREAM_DEBUG <<
+            "write back close:"
+            " fileId: "   << fileId <<
+            " instance: " << instance <<
+            " path: "     << path <<
+        KFS_LOG_EOM;
+        worker.Enqueue(req);
+    }
+    // Wait for all closes in flight, or for the closes of the specified path
+    // and the paths under it, if the path is a directory, to complete.
+    void Wait(const string* path)
+    {
+        QCStMutexLocker lock(mMutex);
+        while (IsInFlightSelf(path)) {
+            mCondVar.Wait(mMutex);
+        }
+    }
+    bool IsInFlight(const string* path)
+    {
+        QCStMutexLocker lock(mMutex);
+        return IsInFlightSelf(path);
+    }
+    int GetAndClearStatus()
+    {
+        QCStMutexLocker lock(mMutex);
+        const int ret = mStatus;
+        mStatus = 0;
+        return ret;
+    }
+    void GetStats(Properties& stats)
+    {
+        QCStMutexLocker lock(mMutex);
+        SetStat(stats, "WriteBack.Closes",   mCloseCount);
+        SetStat(stats, "WriteBack.Errors",   mErrorCount);
+        SetStat(stats, "WriteBack.InFlight", mInFlightCount);
+    }
+private:
+    typedef map<string, int> Paths;
+
+    class Request : public KfsProtocolWorker::Request
+    {
+    public:
+        Request(
+            WriteBack&                      outer,
+            KfsProtocolWorker::RequestType  type,
+            KfsProtocolWorker::FileInstance instance,
+            KfsProtocolWorker::FileId       fileId,
+            const string&                   path)
+            : KfsProtocolWorker::Request(type, instance, fileId),
+              mOuter(outer),
+              mPath(path)
+            {}
+        virtual void Done(int64_t status)
+        {
+            mOuter.Done(mPath, status);
+            delete this;
+        }
+    private:
+        WriteBack&   mOuter;
+        string const mPath;
+
+        virtual ~Request()
+            {}
+    };
+    friend class Request;
+
+    StatCache& mStatCache;
+    QCMutex    mMutex;
+    QCCondVar  mCondVar;
+    Paths      mPaths;
+    int        mStatus;
+    int        mInFlightCount;
+    int64_t    mCloseCount;
+    int64_t    mErrorCount;
+
+    bool IsInFlightSelf(const string* path) const
+    {
+        if (! path) {
+            return (0 < mInFlightCount);
+        }
+        if (mPaths.find(*path) != mPaths.end()) {
+            return true;
+        }
+        string prefix(*path);
+        if (prefix.empty() || prefix[prefix.size() - 1] != '/') {
+            prefix += '/';
+        }
+        Paths::const_iterator const it = mPaths.lower_bound(prefix);
+        return (it != mPaths.end() &&
+            it->first.compare(0, prefix.size(), prefix) == 0);
+    }
+    static void SetStat(Properties& stats, const char* name, int64_t val)
+    {
+        string str;
+        AppendDecIntToString(str, val);
+        stats.setValue(name, str);
+    }
+    void Done(const string& path, int64_t status)
+    {
+        if (status < 0) {
+            KFS_LOG_STREAM_ERROR <<
+                "write back close: " << path <<
+                " error: " << ErrorCodeToStr((int)status) <<
+            KFS_LOG_EOM;
+        }
+        mStatCache.Invalidate();
+        QCStMutexLocker lock(mMutex);
+        if (status < 0) {
+            mErrorCount++;
+            if (0 == mStatus) {
+                mStatus = (int)status;
+            }
+        }
+        Paths::iterator const it = mPaths.find(path);
+        if (it != mPaths.end() && --(it->second) <= 0) {
+            mPaths.erase(it);
+        }
+        mInFlightCount--;
+        mCondVar.NotifyAll();
+    }
+private:
+    WriteBack(const WriteBack&);
+    WriteBack& operator=(const WriteBack&);
+};
+
+void
+KfsClientImpl::WaitForWriteBack(const char* pathname)
+{
+    assert(mMutex.IsOwned());
+    if (! pathname || ! *pathname || ! mWriteBack->IsInFlight(0)) {
+        return;
+    }
+    string abspath;
+    if (pathname[0] != '/') {
+        abspath.assign(mCwd.data(), mCwd.length());
+        abspath.append("/", 1);
+    }
+    abspath.append(pathname);
+    Path path;
+    if (! path.Set(abspath.data(), abspath.size())) {
+        return;
+    }
+    abspath = path.NormPath();
+    if (! mWriteBack->IsInFlight(&abspath)) {
+        return;
+    }
+    QCStMutexUnlocker unlock(mMutex);
+    mWriteBack->Wait(&abspath);
+}
+
+int
+KfsClientImpl::FlushWriteBack()
+{
+    mWriteBack->Wait(0);
+    return mWriteBack->GetAndClearStatus();
+}
+
 inline static int
 GetOpTimeout(int nsecs)
 {
@@ -1523,6 +2070,8 @@ KfsClientImpl::KfsClientImpl(
       mFailShortReadsFlag(true),
       mFileInstance(0),
       mProtocolWorker(0),
+      mSharedMetaWorker(0),
+      mUseMetaConnectionPoolFlag(false),
       mMaxNumRetriesPerOp(DEFAULT_NUM_RETRIES_PER_OP),
       mRetryDelaySec(RETRY_DELAY_SECS),
       mDefaultOpTimeout(30),
@@ -1564,7 +2113,12 @@ KfsClientImpl::KfsClientImpl(
       mShortCommonRpcHdrs(),
       mCloseWriteOnReadFlag(false),
       mIsMonitored(false),
-      mClientId(0)
+      mClientId(0),
+      mStatCache(new StatCache()),
+      mUseStatCacheFlag(false),
+      mWriteBack(new WriteBack(*mStatCache)),
+      mWriteBackMaxCloses(0),
+      mOpLatencyStats()
 {
     if (mMetaServer) {
         mMetaServerLoc = mMetaServer->GetServerLocation();
@@ -1580,6 +2134,7 @@ KfsClientImpl::KfsClientImpl(
     mChunkServer.SetMaxContentLength(64 << 20);
     UpdateEUserAndEGroup();
     mChunkServer.SetAuthContext(&mAuthCtx);
+    mChunkServer.SetOpLatencyStats(&mOpLatencyStats, false);
 }
 
 KfsClientImpl::~KfsClientImpl()
@@ -1600,6 +2155,8 @@ KfsClientImpl::~KfsClientImpl()
         delete *it++;
     }
     delete [] mNameBuf;
+    delete mStatCache;
+    delete mWriteBack;
 }
 
 void
@@ -1621,8 +2178,10 @@ KfsClientImpl::ShutdownSelf()
             "client with id " << mClientId << " is removed from monitoring." <<
         KFS_LOG_EOM;
     }
+    ReleaseSharedMetaWorker();
     if (mProtocolWorker) {
         QCStMutexUnlocker unlock(mMutex);
+        mWriteBack->Wait(0);
         mProtocolWorker->Stop();
     }
     mAuthCtx.Clear();
@@ -1748,6 +2307,15 @@ int KfsClientImpl::Init(const string& metaServerHost, int metaServerPort,
                 mNetManager.GetResolverCacheExpiration())
         );
         properties->copyWithPrefix("client.", mConfig);
+        mUseMetaConnectionPoolFlag = properties->getValue(
+            "client.metaServerConnectionPool",
+            mUseMetaConnectionPoolFlag ? 1 : 0) != 0;
+        mUseStatCacheFlag = properties->getValue(
+            "client.statCache", mUseStatCacheFlag ? 1 : 0) != 0;
+        mWriteBackMaxCloses = properties->getValue(
+            "client.writeBackMaxCloses", mWriteBackMaxCloses);
+        mOpLatencyStats.SetTraceSampleInterval(properties->getValue(
+            "client.opTraceSampleInterval", 0));
     }
     KFS_LOG_STREAM_DEBUG <<
         "will use metaserver at: " <<
@@ -1986,7 +2554,7 @@ KfsClientImpl::Mkdirs(const char *pathname, kfsMode_t mode)
             }
             // Invalidate the counts, assuming that in most cases case a new sub
             // directory will be created.
-            fa->staleSubCountsFlag = true;
+            SetStaleSubCounts(*fa);
             mTmpPath.push_back(make_pair(fa->fileId, i));
             continue;
         }
@@ -2005,7 +2573,7 @@ KfsClientImpl::Mkdirs(const char *pathname, kfsMode_t mode)
         if ((res = op.status) == 0) {
             mTmpPath.push_back(make_pair(op.fileId, i));
             if (! createdFlag && (fa = LookupFAttr(ROOTFID, mSlash))) {
-                fa->staleSubCountsFlag = true;
+                SetStaleSubCounts(*fa);
             }
             createdFlag = true;
             if (i + 1 == sz) {
@@ -2032,7 +2600,7 @@ KfsClientImpl::Mkdirs(const char *pathname, kfsMode_t mode)
             res = -ENOTDIR;
             break;
         }
-        fa->staleSubCountsFlag = true;
+        SetStaleSubCounts(*fa);
         mTmpPath.push_back(make_pair(fa->fileId, i));
     }
     mTmpAbsPath.Clear();
@@ -2093,6 +2661,7 @@ int
 KfsClientImpl::Rmdir(const char *pathname)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     string      dirname;
     string      path;
@@ -2130,6 +2699,7 @@ KfsClientImpl::RmdirsFast(const char *pathname,
     KfsClientImpl::ErrorHandler* errHandler)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     if (! pathname || ! *pathname) {
         return -EINVAL;
@@ -2173,6 +2743,7 @@ KfsClientImpl::InvalidateAllCachedAttrs()
 {
     // Invalidate cached attributes.
     mFAttrCacheGeneration++;
+    InvalidateStatCache();
 }
 
 int
@@ -2445,6 +3016,7 @@ int
 KfsClientImpl::Readdir(const char* pathname, vector<string>& result)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     result.clear();
     KfsFileAttr attr;
@@ -2555,6 +3127,7 @@ KfsClientImpl::ReaddirPlus(const char* pathname, vector<KfsFileAttr>& result,
     bool computeFilesize, bool updateClientCache, bool fileIdAndTypeOnly)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     result.clear();
     KfsFileAttr attr;
@@ -3188,10 +3761,21 @@ KfsClientImpl::ReaddirPlus(const string& pathname, kfsFileId_t dirFid,
 int
 KfsClientImpl::Stat(const char *pathname, KfsFileAttr& kfsattr, bool computeFilesize)
 {
+    if (mUseStatCacheFlag && pathname && pathname[0] == '/' &&
+            mStatCache->Get(pathname, computeFilesize, time(0), kfsattr)) {
+        return 0;
+    }
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
+    const StatCache::Epoch epoch = mStatCache->GetEpoch();
     const bool kValidSubCountsRequiredFlag = true;
-    return StatSelf(pathname, kfsattr, computeFilesize, 0, 0,
-        kValidSubCountsRequiredFlag);
+    FAttr*     fa                          = 0;
+    const int  ret                         = StatSelf(pathname, kfsattr,
+        computeFilesize, 0, &fa, kValidSubCountsRequiredFlag);
+    if (0 == ret && fa) {
+        PublishStat(pathname, *fa, kfsattr, epoch);
+    }
+    return ret;
 }
 
 int
@@ -3270,6 +3854,7 @@ int
 KfsClientImpl::GetNumChunks(const char *pathname)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     string      path;
@@ -3351,6 +3936,7 @@ KfsClientImpl::Create(const char *pathname, int numReplicas, bool exclusive,
     bool forceTypeFlag, kfsMode_t mode, kfsSTier_t minSTier, kfsSTier_t maxSTier)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
     return CreateSelf(pathname, numReplicas, exclusive,
         numStripes, numRecoveryStripes, stripeSize, stripedType, forceTypeFlag,
         mode, minSTier, maxSTier);
@@ -3496,6 +4082,7 @@ KfsClientImpl::Remove(const char* pathname)
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     kfsFileId_t parentFid;
     string      filename;
@@ -3551,6 +4138,7 @@ KfsClientImpl::InvalidateCachedAttrsWithPathPrefix(
         if (fa == faDoNotDelete) {
             if (fa->generation == mFAttrCacheGeneration) {
                 fa->generation--;
+                InvalidateStatCache();
             }
         } else {
             Delete(fa);
@@ -3567,6 +4155,8 @@ KfsClientImpl::Rename(const char* src, const char* dst, bool overwrite)
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(src);
+    WaitForWriteBack(dst);
 
     kfsFileId_t srcParentFid;
     string      srcFileName;
@@ -3650,6 +4240,7 @@ KfsClientImpl::UpdateFattr(
         }
         UpdatePath(fa, path, copyPathFlag);
         FAttrLru::PushBack(mFAttrLru, *fa);
+        InvalidateStatCache();
     } else if (! (fa = NewFAttr(parentFid, name,
             copyPathFlag ? path : string(path.data(), path.size())))) {
         return -ENOMEM;
@@ -3693,7 +4284,7 @@ KfsClientImpl::InvalidateAttribute(const string& pathname,
             if (deleteFlag) {
                 Delete(it->second);
             } else {
-                it->second->staleSubCountsFlag = true;
+                SetStaleSubCounts(*it->second);
             }
             continue;
         }
@@ -3707,7 +4298,7 @@ KfsClientImpl::InvalidateAttribute(const string& pathname,
         if (deleteFlag) {
             Delete(fa);
         } else {
-            fa->staleSubCountsFlag = true;
+            SetStaleSubCounts(*fa);
         }
     }
 }
@@ -3720,6 +4311,8 @@ KfsClientImpl::CoalesceBlocks(const char* src, const char* dst, chunkOff_t *dstS
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(src);
+    WaitForWriteBack(dst);
 
     kfsFileId_t srcParentFid;
     string      srcFileName;
@@ -3766,6 +4359,7 @@ KfsClientImpl::SetUtimes(const char* pathname, const struct timeval& mtime,
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     kfsFileId_t parentFid;
     string      fileName;
@@ -3788,6 +4382,7 @@ KfsClientImpl::OpenDirectory(const char *pathname)
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     string path;
     const bool kCacheAttributesFlag = false;
@@ -3941,6 +4536,7 @@ KfsClientImpl::Open(const char *pathname, int openMode, int numReplicas,
     kfsMode_t mode, kfsSTier_t minSTier, kfsSTier_t maxSTier)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
     const bool kCacheAttributesFlag = false;
     return OpenSelf(pathname, openMode, numReplicas,
         numStripes, numRecoveryStripes, stripeSize, stripedType,
@@ -4129,6 +4725,7 @@ KfsClientImpl::OpenSelf(const char *pathname, int openMode, int numReplicas,
         // Update attribute cache file size.
         if (fa && entry.openMode == O_RDONLY) {
             fa->fileSize = entry.fattr.fileSize;
+            InvalidateStatCache();
         }
     }
     if (! entry.fattr.isDirectory) {
@@ -4157,7 +4754,9 @@ KfsClientImpl::Close(int fd)
     KfsProtocolWorker::RequestType  closeType;
     bool                            readCloseFlag;
     bool                            writeCloseFlag;
-    int                             status = 0;
+    int                             status             = 0;
+    int                             writeBackMaxCloses = 0;
+    string                          writeBackPath;
     {
         QCStMutexLocker l(mMutex);
 
@@ -4185,10 +4784,18 @@ KfsClientImpl::Close(int fd)
             // Invalidate the corresponding attribute if any.
             InvalidateAttributeAndCounts(entry.pathname);
             Delete(LookupFAttr(entry.parentFid, entry.name));
+            InvalidateStatCache();
+            if (0 < mWriteBackMaxCloses) {
+                writeBackMaxCloses = mWriteBackMaxCloses;
+                writeBackPath      = entry.pathname;
+            }
         }
         ReleaseFileTableEntry(fd);
     }
-    if (writeCloseFlag) {
+    if (writeCloseFlag && 0 < writeBackMaxCloses) {
+        mWriteBack->Close(*mProtocolWorker, closeType, fileInstance, fileId,
+            writeBackPath, writeBackMaxCloses);
+    } else if (writeCloseFlag) {
         const int ret = (int)mProtocolWorker->Execute(
             closeType,
             fileInstance,
@@ -4284,6 +4891,7 @@ int
 KfsClientImpl::Truncate(const char* pathname, chunkOff_t offset)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     string      path;
@@ -4380,6 +4988,7 @@ KfsClientImpl::GetDataLocation(
     chunkOff_t*                outBlkSize)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     // Open the file and cache the attributes
     const int fd = CacheAttributes(pathname);
@@ -4556,6 +5165,7 @@ int
 KfsClientImpl::SetReplicationFactor(const char *pathname, int16_t numReplicas)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     string      path;
@@ -4581,6 +5191,7 @@ KfsClientImpl::SetStorageTierRange(
         return -EINVAL;
     }
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     string      path;
@@ -4627,6 +5238,7 @@ KfsClientImpl::SetDefaultMetaOpTimeout(int nsecs)
         return;
     }
     mDefaultMetaOpTimeout = timeout;
+    ReleaseSharedMetaWorker();
     if (mProtocolWorker) {
         mProtocolWorker->SetMetaOpTimeoutSec(mDefaultMetaOpTimeout);
     }
@@ -4647,6 +5259,7 @@ KfsClientImpl::SetRetryDelay(int nsecs)
         return;
     }
     mRetryDelaySec = nsecs;
+    ReleaseSharedMetaWorker();
     if (mProtocolWorker) {
         mProtocolWorker->SetTimeSecBetweenRetries(mRetryDelaySec);
         mProtocolWorker->SetMetaTimeSecBetweenRetries(mRetryDelaySec);
@@ -4668,6 +5281,7 @@ KfsClientImpl::SetMaxRetryPerOp(int retryCount)
         return;
     }
     mMaxNumRetriesPerOp = retryCount;
+    ReleaseSharedMetaWorker();
     if (mProtocolWorker) {
         mProtocolWorker->SetMaxRetryCount(mMaxNumRetriesPerOp);
         mProtocolWorker->SetMetaMaxRetryCount(mMaxNumRetriesPerOp);
@@ -4681,10 +5295,18 @@ KfsClientImpl::StartProtocolWorker()
     if (mProtocolWorker) {
         return;
     }
+    mProtocolWorker = CreateProtocolWorker(
+        mProtocolWorkerAuthCtx.IsEnabled() ? &mProtocolWorkerAuthCtx : 0,
+        &mOpLatencyStats);
+}
+
+KfsProtocolWorker*
+KfsClientImpl::CreateProtocolWorker(ClientAuthContext* authCtx,
+    OpLatencyStats* opLatencyStats)
+{
     KfsProtocolWorker::Parameters params;
-    if (mProtocolWorkerAuthCtx.IsEnabled()) {
-        params.mAuthContextPtr = &mProtocolWorkerAuthCtx;
-    }
+    params.mAuthContextPtr    = authCtx;
+    params.mOpLatencyStatsPtr = opLatencyStats;
     // Make content length limit large enough to ensure backward compatibility
     // with the previous versions of the meta server that don't support
     // partial readdir and getalloc.
@@ -4719,22 +5341,42 @@ KfsClientImpl::StartProtocolWorker()
         KfsClient::GetMetaServerNodesParamName(), params.mMetaServerNodes);
     params.mClientRackId    = mConfig.getValue(
         "client.rackId", -1);
+    params.mWriteMaxChunksInFlight = mConfig.getValue(
+        "client.writeMaxChunksInFlight", params.mWriteMaxChunksInFlight);
+    params.mReadLayoutPrefetchChunks = mConfig.getValue(
+        "client.readLayoutPrefetchChunks", params.mReadLayoutPrefetchChunks);
+    params.mReadLayoutCacheTimeout   = mConfig.getValue(
+        "client.readLayoutCacheTimeout", params.mReadLayoutCacheTimeout);
     params.mResolverUseOsResolverFlag = mNetManager.GetResolverOsFlag();
     params.mResolverCacheSize         = mNetManager.GetResolverCacheSize();
     params.mResolverCacheExpiration   = mNetManager.GetResolverCacheExpiration();
-    mProtocolWorker = new KfsProtocolWorker(
+    KfsProtocolWorker* const worker = new KfsProtocolWorker(
         mMetaServerLoc.hostname,
         mMetaServerLoc.port,
         &params
     );
-    mProtocolWorker->SetOpTimeoutSec(mDefaultOpTimeout);
-    mProtocolWorker->SetMetaOpTimeoutSec(mDefaultMetaOpTimeout);
-    mProtocolWorker->SetMaxRetryCount(mMaxNumRetriesPerOp);
-    mProtocolWorker->SetMetaMaxRetryCount(mMaxNumRetriesPerOp);
-    mProtocolWorker->SetTimeSecBetweenRetries(mRetryDelaySec);
-    mProtocolWorker->SetMetaTimeSecBetweenRetries(mRetryDelaySec);
-    mProtocolWorker->SetCommonRpcHeaders(mCommonRpcHdrs, mShortCommonRpcHdrs);
-    mProtocolWorker->Start();
+    worker->SetOpTimeoutSec(mDefaultOpTimeout);
+    worker->SetMetaOpTimeoutSec(mDefaultMetaOpTimeout);
+    worker->SetMaxRetryCount(mMaxNumRetriesPerOp);
+    worker->SetMetaMaxRetryCount(mMaxNumRetriesPerOp);
+    worker->SetTimeSecBetweenRetries(mRetryDelaySec);
+    worker->SetMetaTimeSecBetweenRetries(mRetryDelaySec);
+    worker->SetCommonRpcHeaders(mCommonRpcHdrs, mShortCommonRpcHdrs);
+    worker->Start();
+    return worker;
+}
+
+void
+KfsClientImpl::ReleaseSharedMetaWorker()
+{
+    assert(mMutex.IsOwned());
+    if (! mSharedMetaWorker) {
+        return;
+    }
+    KfsProtocolWorker* const worker = mSharedMetaWorker;
+    mSharedMetaWorker = 0;
+    QCStMutexUnlocker unlock(mMutex);
+    MetaConnectionPool::Release(worker);
 }
 
 int
@@ -4954,6 +5596,14 @@ KfsClientImpl::SetFileAttributeRevalidateTime(int secs)
 {
     QCStMutexLocker lock(mMutex);
     mFileAttributeRevalidateTime = secs;
+    InvalidateStatCache();
+}
+
+int
+KfsClientImpl::GetFileAttributeRevalidateTime() const
+{
+    QCStMutexLocker lock(const_cast<KfsClientImpl*>(this)->mMutex);
+    return mFileAttributeRevalidateTime;
 }
 
 ///
@@ -5061,6 +5711,7 @@ KfsClientImpl::UpdateFilesize(int fd)
     FdAttr(fd)->fileSize = res;
     if (fa) {
         fa->fileSize = res;
+        InvalidateStatCache();
     }
     return 0;
 }
@@ -5404,8 +6055,15 @@ KfsClientImpl::ExecuteMeta(KfsOp& op)
         mMetaServer->GetNetManager().MainLoop(
             kNullMutexPtr, kWakeupAndCleanupFlag);
     } else {
-        StartProtocolWorker();
-        mProtocolWorker->ExecuteMeta(op);
+        if (mUseMetaConnectionPoolFlag && ! mSharedMetaWorker) {
+            mSharedMetaWorker = MetaConnectionPool::Acquire(*this);
+        }
+        if (mSharedMetaWorker) {
+            mSharedMetaWorker->ExecuteMeta(op);
+        } else {
+            StartProtocolWorker();
+            mProtocolWorker->ExecuteMeta(op);
+        }
     }
     KFS_LOG_STREAM_DEBUG <<
         "meta op done:" <<
@@ -5415,6 +6073,9 @@ KfsClientImpl::ExecuteMeta(KfsOp& op)
         " last status: "  << op.lastError <<
         " "               << op.Show() <<
     KFS_LOG_EOM;
+    if (! IsReadOnlyMetaOp(op)) {
+        InvalidateStatCache();
+    }
 }
 
 void
@@ -5782,7 +6443,7 @@ KfsClientImpl::GetPathComponents(const char* pathname, kfsFileId_t* parentFid,
     name       = mSlash;
     FAttr* fa;
     if (invalidateSubCountsFlag && (fa = LookupFAttr(*parentFid, name))) {
-        fa->staleSubCountsFlag = true;
+        SetStaleSubCounts(*fa);
     }
     const Path::Token kThisDir(".",    1);
     const Path::Token kParentDir("..", 2);
@@ -5831,7 +6492,7 @@ KfsClientImpl::GetPathComponents(const char* pathname, kfsFileId_t* parentFid,
             break;
         }
         if (invalidateSubCountsFlag) {
-            fa->staleSubCountsFlag = true;
+            SetStaleSubCounts(*fa);
         }
         if (lastFlag) {
             break;
@@ -5859,6 +6520,7 @@ KfsClientImpl::GetReplication(const char* pathname,
     KfsFileAttr& attr, int& minChunkReplication, int& maxChunkReplication)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     int ret;
     if ((ret = StatSelf(pathname, attr, false))  < 0) {
@@ -6088,6 +6750,7 @@ KfsClientImpl::EnumerateBlocks(
     const char* pathname, KfsClient::BlockInfos& res, bool getChunkSizesFlag)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     int ret;
@@ -6209,6 +6872,7 @@ KfsClientImpl::VerifyDataChecksums(const char* pathname)
     int         res;
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     if ((res = StatSelf(pathname, attr, false))  < 0) {
         return res;
@@ -6330,6 +6994,7 @@ KfsClientImpl::Chmod(const char* pathname, kfsMode_t mode)
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     int         res;
@@ -6518,6 +7183,7 @@ KfsClientImpl::ChmodR(const char* pathname, kfsMode_t mode,
     KfsClientImpl::ErrorHandler* errHandler)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     DefaultErrHandler errorHandler;
     ChmodFunc funct(*this, mode, errHandler ? *errHandler : errorHandler);
@@ -6685,6 +7351,7 @@ KfsClientImpl::ChownSelf(const char* pathname,
     }
 
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     int         res;
@@ -6809,6 +7476,7 @@ KfsClientImpl::ChownRSelf(
     KfsClientImpl::ErrorHandler* errHandler)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     kfsUid_t    uid    = user;
     kfsGid_t    gid    = group;
@@ -6869,6 +7537,7 @@ KfsClientImpl::SetReplicationFactorR(const char *pathname, int16_t numReplicas,
     KfsClientImpl::ErrorHandler* errHandler)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     // Even though meta server supports recursive set replication, do it one
     // file at a time, in order to prevent "DoS".
@@ -6919,6 +7588,7 @@ KfsClientImpl::SetEUserAndEGroup(kfsUid_t user, kfsGid_t group,
 int
 KfsClientImpl::UpdateEUserAndEGroup()
 {
+    InvalidateStatCache();
     const bool kShortRpcFmtFlag = false;
     mCommonRpcHdrs.clear();
     KfsOp::AddDefaultRequestHeaders(
@@ -6927,6 +7597,8 @@ KfsClientImpl::UpdateEUserAndEGroup()
     mShortCommonRpcHdrs.clear();
     KfsOp::AddDefaultRequestHeaders(
         ! kShortRpcFmtFlag, mShortCommonRpcHdrs, mEUser, mEGroup);
+    // The shared meta connection is keyed by the rpc headers.
+    ReleaseSharedMetaWorker();
     if (mProtocolWorker) {
         mProtocolWorker->SetCommonRpcHeaders(
             mCommonRpcHdrs, mShortCommonRpcHdrs);
@@ -6942,6 +7614,7 @@ int
 KfsClientImpl::CompareChunkReplicas(const char* pathname, string& md5sum)
 {
     QCStMutexLocker l(mMutex);
+    WaitForWriteBack(pathname);
 
     KfsFileAttr attr;
     int         res;
@@ -7612,12 +8285,52 @@ KfsClientImpl::GetUserAndGroupNames(kfsUid_t user, kfsGid_t group,
     return 0;
 }
 
+class KfsClientImpl::OpLatencyStatsSetter
+{
+public:
+    OpLatencyStatsSetter(Properties& stats)
+        : mStats(stats),
+          mValue()
+        {}
+    void operator()(const char* name, int64_t value)
+    {
+        mValue.clear();
+        AppendDecIntToString(mValue, value);
+        mStats.setValue(name, mValue);
+    }
+private:
+    Properties& mStats;
+    string      mValue;
+};
+
 Properties*
 KfsClientImpl::GetStats()
 {
     QCStMutexLocker l(mMutex);
     StartProtocolWorker();
     Properties stats = mProtocolWorker->GetStats();
+    mWriteBack->GetStats(stats);
+    OpLatencyStatsSetter setter(stats);
+    mOpLatencyStats.Enumerate(setter);
+    if (mSharedMetaWorker) {
+        // Report shared meta server connection counters, including pipeline
+        // depth, with "Shared" prefix.
+        const Properties shared = mSharedMetaWorker->GetStats();
+        const string     kMetaPrefix("MetaServer.");
+        string           key;
+        for (Properties::iterator it = shared.begin();
+                it != shared.end();
+                ++it) {
+            if (it->first.size() < kMetaPrefix.size() ||
+                    kMetaPrefix.compare(0, kMetaPrefix.size(),
+                        it->first.data(), kMetaPrefix.size()) != 0) {
+                continue;
+            }
+            key.assign("Shared");
+            key.append(it->first.data(), it->first.size());
+            stats.setValue(Properties::String(key), it->second);
+        }
+    }
     if (stats.empty()) {
         return 0;
     }
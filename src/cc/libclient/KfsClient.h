@@ -43,6 +43,7 @@ using std::vector;
 namespace client {
 class KfsClientImpl;
 class KfsNetClient;
+class AsyncIoQueue;
 }
 
 class Properties;
@@ -595,6 +596,64 @@ public:
     ssize_t PRead(int fd, chunkOff_t pos, char* buf, size_t numBytes);
     ssize_t PWrite(int fd, chunkOff_t pos, const char* buf, size_t numBytes);
 
+    ///
+    /// Asynchronous read with completion queue. Allows to have large number
+    /// of reads in flight, possibly on different files, without dedicating a
+    /// thread to every request in flight.
+    /// The read buffer must not be accessed until the corresponding request
+    /// completion is retrieved from the queue. Close of the file cancels
+    /// reads in flight, in which case the reads complete with an error.
+    /// Asynchronous write is not supported: PWrite() with the write behind
+    /// already returns once the data is copied into the write behind buffer.
+    /// The parameter errors are returned by AsyncPRead(), in this case no
+    /// completion is queued.
+    /// With SkipHolesInFile() the asynchronous read does not cross chunk
+    /// boundary, and returns short read at the chunk end.
+    ///
+    typedef client::AsyncIoQueue AsyncIoQueue;
+    struct AsyncIoCompletion
+    {
+        int     fd;
+        ssize_t status;   // Number of bytes read or written, or -errno.
+        void*   userData; // As passed to AsyncPRead().
+    };
+    AsyncIoQueue* CreateAsyncIoQueue();
+    /// Waits for all requests in flight to complete.
+    void DisposeAsyncIoQueue(AsyncIoQueue* queue);
+    int AsyncPRead(AsyncIoQueue* queue, int fd, chunkOff_t pos,
+        char* buf, size_t numBytes, void* userData);
+    ///
+    /// Retrieve up to maxCount completions, waiting up to timeoutMs
+    /// milliseconds, or indefinitely if timeoutMs is negative, for at least
+    /// minCount completions, or for all requests in flight, whichever is less.
+    /// @retval the number of completions retrieved.
+    ///
+    int GetAsyncIoCompletions(AsyncIoQueue* queue,
+        AsyncIoCompletion* completions, int maxCount,
+        int minCount, int timeoutMs);
+
+    ///
+    /// Vectored read: read all ranges concurrently, and return when all
+    /// reads complete. The ranges within the same chunk that are no more
+    /// than coalesceGap bytes apart are read with a single request.
+    /// The ranges can be specified in any order, and can overlap.
+    /// @retval 0 on success, or the first range error; the number of bytes
+    /// read or error code for each range is returned in the range status.
+    /// The time from the call start to the completion of the read the range
+    /// was part of is returned in the range completion time; the coalesced
+    /// ranges have the same completion time.
+    ///
+    struct ReadRange
+    {
+        chunkOff_t offset;
+        size_t     size;
+        char*      buf;
+        ssize_t    status;         // Output: number of bytes read or -errno.
+        int64_t    completionUsec; // Output: microseconds since the call start.
+    };
+    int PReadV(int fd, ReadRange* ranges, int count,
+        size_t coalesceGap = 64 << 10);
+
     /// If there are any holes in a file, such as those at the end of
     /// a chunk, skip over them.
     void SkipHolesInFile(int fd);
@@ -777,6 +836,7 @@ public:
     // Must be invoked before issuing the first read.
     int SetFullSparseFileSupport(int fd, bool flag);
     void SetFileAttributeRevalidateTime(int secs);
+    int GetFileAttributeRevalidateTime() const;
     int Chmod(const char* pathname, kfsMode_t mode);
     int Chmod(int fd, kfsMode_t mode);
     int Chown(const char* pathname, kfsUid_t user, kfsGid_t group);
@@ -844,6 +904,15 @@ public:
         uint32_t&   outValidForSec);
     Properties* GetStats(); // DisposeProperties() must be invoked to cleanup.
     void SetCloseWriteOnRead(bool inFlag);
+    ///
+    /// With write back enabled (client.writeBackMaxCloses > 0) Close() of a
+    /// file opened for write returns without waiting for the pending writes,
+    /// chunk allocation, and close to complete. Wait for all such "background"
+    /// closes to complete.
+    /// @retval 0 on success; -errno of the first background close failure
+    /// since the last call.
+    ///
+    int FlushWriteBack();
     static Properties* CreateProperties();
     static void DisposeProperties(
         Properties* props);
@@ -39,6 +39,7 @@
 #include "qcdio/QCMutex.h"
 
 #include "KfsNetClient.h"
+#include "OpLatencyStats.h"
 #include "KfsAttr.h"
 #include "KfsOps.h"
 #include "KfsClient.h"
@@ -461,6 +462,17 @@ public:
     int WriteAsync(int fd, const char *buf, size_t numBytes);
     int WriteAsyncCompletionHandler(int fd);
 
+    /// See the comments in KfsClient.h
+    AsyncIoQueue* CreateAsyncIoQueue();
+    void DisposeAsyncIoQueue(AsyncIoQueue* queue);
+    int AsyncPRead(AsyncIoQueue* queue, int fd, chunkOff_t pos,
+        char* buf, size_t numBytes, void* userData);
+    int GetAsyncIoCompletions(AsyncIoQueue* queue,
+        KfsClient::AsyncIoCompletion* completions, int maxCount,
+        int minCount, int timeoutMs);
+    int PReadV(int fd, KfsClient::ReadRange* ranges, int count,
+        size_t coalesceGap);
+
     ///
     /// Read/write the desired # of bytes to the file, starting at the
     /// "current" position of the file.
@@ -590,6 +602,7 @@ public:
     // Must be invoked before issuing the first read.
     int SetFullSparseFileSupport(int fd, bool flag);
     void SetFileAttributeRevalidateTime(int secs);
+    int GetFileAttributeRevalidateTime() const;
     int Chmod(const char* pathname, kfsMode_t mode);
     int Chmod(int fd, kfsMode_t mode);
     int Chown(const char* pathname, kfsUid_t user, kfsGid_t group);
@@ -646,6 +659,7 @@ public:
         uint32_t&   outValidForSec);
     Properties* GetStats();
     void SetCloseWriteOnRead(bool inFlag);
+    int FlushWriteBack();
 
 private:
      /// Maximum # of files a client can have open minus 1.
@@ -785,6 +799,8 @@ private:
     bool                           mFailShortReadsFlag;
     unsigned int                   mFileInstance;
     KfsProtocolWorker*             mProtocolWorker;
+    KfsProtocolWorker*             mSharedMetaWorker;
+    bool                           mUseMetaConnectionPoolFlag;
     int                            mMaxNumRetriesPerOp;
     int                            mRetryDelaySec;
     int                            mDefaultOpTimeout;
@@ -829,6 +845,18 @@ private:
     friend class QCDLListOp<KfsClientImpl, 0>;
     class ClientsList;
     friend class ClientsList;
+    class MetaConnectionPool;
+    friend class MetaConnectionPool;
+    class StatCache;
+    StatCache* const               mStatCache;
+    bool                           mUseStatCacheFlag;
+    class WriteBack;
+    class OpLatencyStatsSetter;
+    WriteBack* const               mWriteBack;
+    int                            mWriteBackMaxCloses;
+    // Rpc latency histograms of this client's protocol worker and chunk
+    // server connections, reported by GetStats().
+    OpLatencyStats                 mOpLatencyStats;
 
     // Kfs client presently always allocated with new / malloc. Allocating large
     // buffer as part of the object should present no problem.
@@ -1004,7 +1032,15 @@ private:
         kfsFileId_t parentFid, kfsFileId_t dirFid, ErrorHandler& errHandler,
         bool idempotentFlag);
     void StartProtocolWorker();
+    KfsProtocolWorker* CreateProtocolWorker(ClientAuthContext* authCtx,
+        OpLatencyStats* opLatencyStats = 0);
+    void ReleaseSharedMetaWorker();
     void InvalidateAllCachedAttrs();
+    inline void InvalidateStatCache();
+    inline void SetStaleSubCounts(FAttr& fa);
+    void PublishStat(const char* pathname, const FAttr& fa,
+        const KfsFileAttr& attr, int64_t epoch);
+    void WaitForWriteBack(const char* pathname);
     int GetUserAndGroup(const char* user, const char* group, kfsUid_t& uid, kfsGid_t& gid);
     template<typename T> int RecursivelyApply(
         string& path, const KfsFileAttr& attr, T& functor, bool fileIdAndTypeOnly = false);
@@ -35,12 +35,14 @@
 #include "common/kfstypes.h"
 #include "common/kfsdecls.h"
 #include "common/MsgLogger.h"
+#include "common/time.h"
 #include "common/StdAllocator.h"
 #include "qcdio/QCUtils.h"
 #include "qcdio/qcstutils.h"
 #include "qcdio/QCDLList.h"
 #include "qcdio/QCThread.h"
 #include "KfsOps.h"
+#include "OpLatencyStats.h"
 
 #include <sstream>
 #include <algorithm>
@@ -210,6 +212,8 @@ public:
           mStats(),
           mDisconnectCount(0),
           mEventObserverPtr(0),
+          mOpLatencyStatsPtr(0),
+          mOpLatencyMetaServerFlag(false),
           mLogPrefix((inLogPrefixPtr && inLogPrefixPtr[0]) ?
                 (inLogPrefixPtr + string(" ")) : string()),
           mNetManagerPtr(&inNetManager),
@@ -490,7 +494,10 @@ public:
         { mRetryConnectOnlyFlag = inFlag; }
     void GetStats(
         Stats& outStats) const
-        { outStats = mStats; }
+    {
+        outStats = mStats;
+        outStats.mOpsInFlightCount = (Stats::Counter)mPendingOpQueue.size();
+    }
     const ServerLocation& GetServerLocation() const
         { return mServerLocation; }
     bool Enqueue(
@@ -774,6 +781,15 @@ public:
     void SetEventObserver(
         EventObserver* inEventObserverPtr)
         { mEventObserverPtr = inEventObserverPtr; }
+    void SetOpLatencyStats(
+        OpLatencyStats* inStatsPtr,
+        bool            inMetaServerFlag)
+    {
+        mOpLatencyStatsPtr       = inStatsPtr;
+        mOpLatencyMetaServerFlag = inMetaServerFlag;
+    }
+    OpLatencyStats* GetOpLatencyStats() const
+        { return mOpLatencyStatsPtr; }
     time_t Now() const
         { return mNetManagerPtr->Now(); }
     NetManager& GetNetManager() const
@@ -1133,11 +1149,13 @@ private:
             KfsOp*    inOpPtr        = 0,
             OpOwner*  inOwnerPtr     = 0,
             IOBuffer* inBufferPtr    = 0,
-            int       inExtraTimeout = 0)
+            int       inExtraTimeout = 0,
+            int64_t   inStartTime    = 0)
             : mOpPtr(inOpPtr),
               mOwnerPtr(inOwnerPtr),
               mBufferPtr(inBufferPtr),
               mTime(0),
+              mStartTime(inStartTime),
               mRetryCount(0),
               mExtraTimeout(max(0, inExtraTimeout)),
               mVrConnectPendingFlag(false)
@@ -1172,6 +1190,7 @@ private:
         OpOwner*  mOwnerPtr;
         IOBuffer* mBufferPtr;
         time_t    mTime;
+        int64_t   mStartTime; // Enqueue time, microseconds, for latency stats.
         int       mRetryCount;
         uint32_t  mExtraTimeout:31;
         bool      mVrConnectPendingFlag:1;
@@ -1648,6 +1667,8 @@ private:
     Stats                 mStats;
     int64_t               mDisconnectCount;
     EventObserver*        mEventObserverPtr;
+    OpLatencyStats*       mOpLatencyStatsPtr;
+    bool                  mOpLatencyMetaServerFlag;
     const string          mLogPrefix;
     NetManager*           mNetManagerPtr;
     ClientAuthContext*    mAuthContextPtr;
@@ -1893,7 +1914,8 @@ private:
         OpOwner*  inOwnerPtr,
         IOBuffer* inBufferPtr,
         int       inRetryCount,
-        int       inExtraTimeout)
+        int       inExtraTimeout,
+        int64_t   inStartTime = 0)
     {
         if (! inOpPtr) {
             return false;
@@ -1905,8 +1927,15 @@ private:
         pair<OpQueue::iterator, bool> const theRes =
             mPendingOpQueue.insert(make_pair(
                 inOpPtr->seq,
-                OpQueueEntry(inOpPtr, inOwnerPtr, inBufferPtr, inExtraTimeout)
+                OpQueueEntry(inOpPtr, inOwnerPtr, inBufferPtr, inExtraTimeout,
+                    (0 < inStartTime || ! mOpLatencyStatsPtr) ?
+                        inStartTime : microseconds())
             ));
+        const Stats::Counter theInFlightCount =
+            (Stats::Counter)mPendingOpQueue.size();
+        if (mStats.mOpsInFlightMaxCount < theInFlightCount) {
+            mStats.mOpsInFlightMaxCount = theInFlightCount;
+        }
         if (! theRes.second || ! IsConnected() || IsAuthInFlight()) {
             return theRes.second;
         }
@@ -2449,7 +2478,7 @@ private:
                 }
                 EnqueueSelf(theEntry.mOpPtr, theEntry.mOwnerPtr,
                     theEntry.mBufferPtr, theEntry.mRetryCount,
-                    (int)theEntry.mExtraTimeout);
+                    (int)theEntry.mExtraTimeout, theEntry.mStartTime);
                 theEntry.Clear();
             }
         }
@@ -2519,6 +2548,10 @@ private:
         }
         OpQueueEntry theOpEntry = inIt->second;
         mPendingOpQueue.erase(inIt);
+        if (! inCanceledFlag && mOpLatencyStatsPtr &&
+                0 < theOpEntry.mStartTime && theOpEntry.mOpPtr) {
+            RecordLatency(theOpEntry);
+        }
         const int thePrevRefCount = GetRefCount();
         theOpEntry.OpDone(inCanceledFlag);
         if (! mOutstandingOpPtr &&
@@ -2530,6 +2563,46 @@ private:
                 mOutstandingOpPtr->mRetryCount);
         }
     }
+    void RecordLatency(
+        const OpQueueEntry& inEntry)
+    {
+        const KfsOp&                   theOp       = *inEntry.mOpPtr;
+        const OpLatencyStats::Category theCategory =
+            mOpLatencyMetaServerFlag ? OpLatencyStats::kCategoryMeta :
+            GetChunkServerOpCategory(theOp.op);
+        const int64_t theUsec = microseconds() - inEntry.mStartTime;
+        if (! mOpLatencyStatsPtr->Record(
+                theCategory, theUsec, inEntry.mRetryCount)) {
+            return;
+        }
+        KFS_LOG_STREAM_INFO << mLogPrefix << mServerLocation <<
+            " trace: "   << OpLatencyStats::GetCategoryName(theCategory) <<
+            " usec: "    << theUsec <<
+            " retries: " << inEntry.mRetryCount <<
+            " status: "  << theOp.status <<
+            " "          << theOp.Show() <<
+        KFS_LOG_EOM;
+    }
+    static OpLatencyStats::Category GetChunkServerOpCategory(
+        KfsOp_t inOp)
+    {
+        switch (inOp) {
+            case CMD_READ:
+                return OpLatencyStats::kCategoryChunkRead;
+            case CMD_WRITE:
+            case CMD_WRITE_ID_ALLOC:
+            case CMD_WRITE_PREPARE:
+            case CMD_WRITE_SYNC:
+            case CMD_RECORD_APPEND:
+            case CMD_GET_RECORD_APPEND_STATUS:
+            case CMD_CHUNK_SPACE_RESERVE:
+            case CMD_CHUNK_SPACE_RELEASE:
+                return OpLatencyStats::kCategoryChunkWrite;
+            default:
+                break;
+        }
+        return OpLatencyStats::kCategoryChunkOther;
+    }
     void Cancel(
         OpQueue::iterator inIt)
         { HandleOp(inIt, true); }
@@ -2764,7 +2837,7 @@ private:
                 theEntry.Clear();
                 EnqueueSelf(theTmp.mOpPtr, theTmp.mOwnerPtr,
                     theTmp.mBufferPtr, theTmp.mRetryCount + theRetryIncrement,
-                    theTmp.mExtraTimeout);
+                    theTmp.mExtraTimeout, theTmp.mStartTime);
             }
         }
         mQueueStack.erase(theStIt);
@@ -3144,6 +3217,21 @@ KfsNetClient::SetEventObserver(
     mImpl.SetEventObserver(inEventObserverPtr);
 }
 
+    void
+KfsNetClient::SetOpLatencyStats(
+    OpLatencyStats* inStatsPtr,
+    bool            inMetaServerFlag)
+{
+    Impl::StRef theRef(mImpl);
+    mImpl.SetOpLatencyStats(inStatsPtr, inMetaServerFlag);
+}
+
+    OpLatencyStats*
+KfsNetClient::GetOpLatencyStats() const
+{
+    return mImpl.GetOpLatencyStats();
+}
+
     NetManager&
 KfsNetClient::GetNetManager() const
 {
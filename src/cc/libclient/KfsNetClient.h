@@ -43,6 +43,7 @@ class ClientAuthContext;
 
 namespace client
 {
+class OpLatencyStats;
 struct KfsOp;
 
 using std::string;
@@ -79,7 +80,9 @@ public:
               mOpsCancelledCount(0),
               mSleepTimeSec(0),
               mBytesReceivedCount(0),
-              mBytesSentCount(0)
+              mBytesSentCount(0),
+              mOpsInFlightCount(0),
+              mOpsInFlightMaxCount(0)
             {}
         void Clear()
             { *this = Stats(); }
@@ -98,6 +101,10 @@ public:
             mSleepTimeSec               += inStats.mSleepTimeSec;
             mBytesReceivedCount         += inStats.mBytesReceivedCount;
             mBytesSentCount             += inStats.mBytesSentCount;
+            mOpsInFlightCount           += inStats.mOpsInFlightCount;
+            if (mOpsInFlightMaxCount < inStats.mOpsInFlightMaxCount) {
+                mOpsInFlightMaxCount = inStats.mOpsInFlightMaxCount;
+            }
             return *this;
         }
         template<typename T>
@@ -116,6 +123,8 @@ public:
             inFunctor("SleepTimeSec",          mSleepTimeSec);
             inFunctor("BytesReceived",         mBytesReceivedCount);
             inFunctor("BytesSent",             mBytesSentCount);
+            inFunctor("OpsInFlight",           mOpsInFlightCount);
+            inFunctor("OpsInFlightMax",        mOpsInFlightMaxCount);
         }
         Counter mConnectCount;
         Counter mConnectFailureCount;
@@ -129,6 +138,10 @@ public:
         Counter mSleepTimeSec;
         Counter mBytesReceivedCount;
         Counter mBytesSentCount;
+        // Pipeline depth: the number of ops sent or queued for sending, and
+        // awaiting response.
+        Counter mOpsInFlightCount;
+        Counter mOpsInFlightMaxCount;
     };
     enum {
         kErrorMaxRetryReached = -(10000 + ETIMEDOUT),
@@ -259,6 +272,12 @@ public:
     NetManager& GetNetManager() const;
     void SetEventObserver(
         EventObserver* inEventObserverPtr); // Debug hook
+    // Op latency is recorded from enqueue to completion, including retries,
+    // meta server flag selects the histogram category.
+    void SetOpLatencyStats(
+        OpLatencyStats* inStatsPtr,
+        bool            inMetaServerFlag);
+    OpLatencyStats* GetOpLatencyStats() const;
     void SetMaxContentLength(
         int inMax);
     void ClearMaxOneOutstandingOpFlag();
@@ -127,9 +127,12 @@ public:
           mPreAllocateFlag(inParameters.mPreAllocateFlag),
           mMaxWriteSize(inParameters.mMaxWriteSize),
           mRandomWriteThreshold(inParameters.mRandomWriteThreshold),
+          mWriteMaxChunksInFlight(inParameters.mWriteMaxChunksInFlight),
           mMaxReadSize(inParameters.mMaxReadSize),
           mReadLeaseRetryTimeout(inParameters.mReadLeaseRetryTimeout),
           mLeaseWaitTimeout(inParameters.mLeaseWaitTimeout),
+          mReadLayoutPrefetchChunks(inParameters.mReadLayoutPrefetchChunks),
+          mReadLayoutCacheTimeout(inParameters.mReadLayoutCacheTimeout),
           mChunkServerInitialSeqNum(
             inParameters.mChunkServerInitialSeqNum > 0 ?
                 inParameters.mChunkServerInitialSeqNum :
@@ -171,6 +174,7 @@ public:
             inParameters.mResolverCacheExpiration);
         mMetaServer.SetMaxMetaLogWriteRetryCount(mMetaMaxRetryCount);
         mMetaServer.SetRackId(inParameters.mClientRackId);
+        mMetaServer.SetOpLatencyStats(inParameters.mOpLatencyStatsPtr, true);
         const bool kHexFormatFlag       = false;
         const bool kAllowDuplicatesFlag = true;
         mMetaServer.SetMetaServerLocations(
@@ -1148,7 +1152,8 @@ private:
                 min(max(4 << 20, inOwner.mMaxWriteSize),
                     max(inOwner.mMaxWriteSize, inMaxWriteSize)),
                 inLogPrefixPtr,
-                inOwner.mChunkServerInitialSeqNum
+                inOwner.mChunkServerInitialSeqNum,
+                inOwner.mWriteMaxChunksInFlight
               ),
               mCurRequestPtr(0),
               mAsyncStatus(0)
@@ -1208,7 +1213,8 @@ private:
                     if (inRequest.mSize <= 0 &&
                             (inRequest.mMaxPendingOrEndPos < 0 ||
                                 mWriter.GetPendingSize() <=
-                                    inRequest.mMaxPendingOrEndPos)) {
+                                    mWriter.GetMaxPendingSize(
+                                        inRequest.mMaxPendingOrEndPos))) {
                         const int theStatus = mWriter.GetErrorCode();
                         Impl::Done(inRequest, theStatus == 0 ?
                             mWriter.GetPendingSize() : int64_t(theStatus));
@@ -1314,7 +1320,8 @@ private:
             const int64_t thePendingSize = mWriter.GetPendingSize();
             if ((theReq.mRequestType == kRequestTypeWriteThrottle ?
                         (theReq.mMaxPendingOrEndPos >= 0 &&
-                            thePendingSize > theReq.mMaxPendingOrEndPos) :
+                            thePendingSize > mWriter.GetMaxPendingSize(
+                                theReq.mMaxPendingOrEndPos)) :
                         (thePendingSize > 0)) ||
                     theReq.mRequestType == kRequestTypeWriteClose) {
                 mWorkQueue[0] = theWorkQueue[0];
@@ -1352,7 +1359,8 @@ private:
                     (theThrottleFlag && (
                         inRequest.mMaxPendingOrEndPos < 0 || (
                         inRequest.mMaxPendingOrEndPos > 0 &&
-                        inRequest.mMaxPendingOrEndPos +
+                        mWriter.GetMaxPendingSize(
+                            inRequest.mMaxPendingOrEndPos) +
                             max(0, mOwner.mRandomWriteThreshold) >
                         max(inRequest.mSize, 0) +
                             mWriter.GetPendingSize())))) {
@@ -1464,7 +1472,9 @@ private:
                 inOwner.mLeaseWaitTimeout,
                 inLogPrefixPtr,
                 inOwner.mChunkServerInitialSeqNum,
-                inOwner.mClientPoolPtr),
+                inOwner.mClientPoolPtr,
+                inOwner.mReadLayoutPrefetchChunks,
+                inOwner.mReadLayoutCacheTimeout),
               mCurRequestPtr(0),
               mAsyncReadStatus(0),
               mAsyncReadDoneCount(0)
@@ -1707,9 +1717,12 @@ private:
     const bool           mPreAllocateFlag;
     const int            mMaxWriteSize;
     const int            mRandomWriteThreshold;
+    const int            mWriteMaxChunksInFlight;
     const int            mMaxReadSize;
     const int            mReadLeaseRetryTimeout;
     const int            mLeaseWaitTimeout;
+    const int            mReadLayoutPrefetchChunks;
+    const int            mReadLayoutCacheTimeout;
     int64_t              mChunkServerInitialSeqNum;
     DoNotDeallocate      mDoNotDeallocate;
     StopRequest          mStopRequest;
@@ -43,6 +43,7 @@ namespace client
 using std::string;
 
 struct KfsOp;
+class OpLatencyStats;
 // KFS client side protocol worker thread runs client side network io state
 // machines.
 class KfsProtocolWorker
@@ -213,7 +214,11 @@ public:
             int                inClientRackId                = -1,
             bool               inResolverUseOsResolverFlag   = false,
             int                inResolverCacheSize           = 8 << 10,
-            int                inResolverCacheExpiration     = -1)
+            int                inResolverCacheExpiration     = -1,
+            int                inWriteMaxChunksInFlight      = 1,
+            int                inReadLayoutPrefetchChunks    = 0,
+            int                inReadLayoutCacheTimeout      = 60,
+            OpLatencyStats*    inOpLatencyStatsPtr           = 0)
             : mMetaMaxRetryCount(inMetaMaxRetryCount),
               mMetaTimeSecBetweenRetries(inMetaTimeSecBetweenRetries),
               mMetaOpTimeoutSec(inMetaOpTimeoutSec),
@@ -242,7 +247,11 @@ public:
               mClientRackId(inClientRackId),
               mResolverUseOsResolverFlag(inResolverUseOsResolverFlag),
               mResolverCacheSize(inResolverCacheSize),
-              mResolverCacheExpiration(inResolverCacheExpiration)
+              mResolverCacheExpiration(inResolverCacheExpiration),
+              mWriteMaxChunksInFlight(inWriteMaxChunksInFlight),
+              mReadLayoutPrefetchChunks(inReadLayoutPrefetchChunks),
+              mReadLayoutCacheTimeout(inReadLayoutCacheTimeout),
+              mOpLatencyStatsPtr(inOpLatencyStatsPtr)
             {}
             int                 mMetaMaxRetryCount;
             int                 mMetaTimeSecBetweenRetries;
@@ -273,6 +282,10 @@ public:
             bool                mResolverUseOsResolverFlag;
             int                 mResolverCacheSize;
             int                 mResolverCacheExpiration;
+            int                 mWriteMaxChunksInFlight;
+            int                 mReadLayoutPrefetchChunks;
+            int                 mReadLayoutCacheTimeout;
+            OpLatencyStats*     mOpLatencyStatsPtr;
     };
     KfsProtocolWorker(
         std::string       inMetaHost,
@@ -27,13 +27,18 @@
 #include "KfsClientInt.h"
 #include "KfsProtocolWorker.h"
 #include "common/MsgLogger.h"
+#include "common/time.h"
 #include "qcdio/qcstutils.h"
 #include "qcdio/QCDLList.h"
 #include "qcdio/qcdebug.h"
 #include "qcdio/QCUtils.h"
 
 #include <cerrno>
+#include <cstring>
+#include <deque>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <limits>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -45,6 +50,9 @@ namespace client
 {
 
 using std::string;
+using std::deque;
+using std::vector;
+using std::sort;
 using std::max;
 using std::min;
 using std::numeric_limits;
@@ -474,6 +482,158 @@ private:
         const ReadRequest& inReq);
 };
 
+// Asynchronous I/O completion queue.
+class AsyncIoQueue
+{
+public:
+    typedef KfsClient::AsyncIoCompletion Completion;
+
+    AsyncIoQueue()
+        : mMutex(),
+          mCondVar(),
+          mCompletions(),
+          mInFlightCount(0)
+        {}
+    ~AsyncIoQueue()
+    {
+        QCStMutexLocker theLocker(mMutex);
+        while (0 < mInFlightCount) {
+            mCondVar.Wait(mMutex);
+        }
+    }
+    void Start()
+    {
+        QCStMutexLocker theLocker(mMutex);
+        mInFlightCount++;
+    }
+    void Done(
+        int     inFd,
+        int64_t inStatus,
+        void*   inUserDataPtr)
+    {
+        Completion theCompletion;
+        theCompletion.fd       = inFd;
+        theCompletion.status   = (ssize_t)inStatus;
+        theCompletion.userData = inUserDataPtr;
+        QCStMutexLocker theLocker(mMutex);
+        QCASSERT(0 < mInFlightCount);
+        mInFlightCount--;
+        mCompletions.push_back(theCompletion);
+        mCondVar.NotifyAll();
+    }
+    int Get(
+        Completion* inCompletionsPtr,
+        int         inMaxCount,
+        int         inMinCount,
+        int         inTimeoutMs)
+    {
+        if (! inCompletionsPtr || inMaxCount <= 0) {
+            return -EINVAL;
+        }
+        const int64_t theDeadline = inTimeoutMs < 0 ? int64_t(-1) :
+            microseconds() + int64_t(inTimeoutMs) * 1000;
+        QCStMutexLocker theLocker(mMutex);
+        for (; ;) {
+            const int theMinCount = min(min(inMinCount, inMaxCount),
+                (int)mCompletions.size() + mInFlightCount);
+            if (theMinCount <= (int)mCompletions.size()) {
+                break;
+            }
+            if (theDeadline < 0) {
+                mCondVar.Wait(mMutex);
+                continue;
+            }
+            const int64_t theWait = theDeadline - microseconds();
+            if (theWait <= 0 ||
+                    ! mCondVar.Wait(mMutex, QCMutex::Time(theWait) * 1000)) {
+                break;
+            }
+        }
+        const int theCount = min(inMaxCount, (int)mCompletions.size());
+        for (int i = 0; i < theCount; i++) {
+            inCompletionsPtr[i] = mCompletions.front();
+            mCompletions.pop_front();
+        }
+        return theCount;
+    }
+private:
+    typedef deque<Completion> Completions;
+
+    QCMutex     mMutex;
+    QCCondVar   mCondVar;
+    Completions mCompletions;
+    int         mInFlightCount;
+private:
+    AsyncIoQueue(
+        const AsyncIoQueue& inQueue);
+    AsyncIoQueue& operator=(
+        const AsyncIoQueue& inQueue);
+};
+
+// Non-blocking read request that posts its completion into the asynchronous
+// I/O completion queue.
+class AsyncReadRequest : public KfsProtocolWorker::Request
+{
+public:
+    AsyncReadRequest(
+        AsyncIoQueue&   inQueue,
+        int             inFd,
+        void*           inUserDataPtr,
+        FileTableEntry& inEntry,
+        void*           inBufPtr,
+        int             inSize,
+        int64_t         inOffset)
+        : Request(),
+          mOpenParams(),
+          mQueue(inQueue),
+          mFd(inFd),
+          mUserDataPtr(inUserDataPtr),
+          mSkipHolesFlag(inEntry.skipHoles)
+    {
+        mOpenParams.mPathName            = inEntry.pathname;
+        mOpenParams.mFileSize            = inEntry.fattr.fileSize;
+        mOpenParams.mStriperType         = inEntry.fattr.striperType;
+        mOpenParams.mStripeSize          = inEntry.fattr.stripeSize;
+        mOpenParams.mStripeCount         = inEntry.fattr.numStripes;
+        mOpenParams.mRecoveryStripeCount = inEntry.fattr.numRecoveryStripes;
+        mOpenParams.mReplicaCount        = inEntry.fattr.numReplicas;
+        mOpenParams.mSkipHolesFlag       = inEntry.skipHoles;
+        mOpenParams.mFailShortReadsFlag  = inEntry.failShortReadsFlag;
+        mOpenParams.mMsgLogId            = inFd;
+        Reset(
+            KfsProtocolWorker::kRequestTypeReadAsync,
+            inEntry.instance + 1,
+            inEntry.fattr.fileId,
+            &mOpenParams,
+            inBufPtr,
+            inSize,
+            0, // inMaxPending,
+            inOffset
+        );
+    }
+    virtual void Done(
+        int64_t inStatus)
+    {
+        mQueue.Done(mFd, (inStatus == -ENOENT && mSkipHolesFlag) ?
+            int64_t(0) : inStatus, mUserDataPtr);
+        delete this;
+    }
+private:
+    Params        mOpenParams;
+    AsyncIoQueue& mQueue;
+    const int     mFd;
+    void* const   mUserDataPtr;
+    const bool    mSkipHolesFlag;
+
+    virtual ~AsyncReadRequest()
+        {}
+private:
+    AsyncReadRequest(
+        const AsyncReadRequest& inReq);
+    AsyncReadRequest& operator=(
+        const AsyncReadRequest& inReq);
+};
+
 void
 KfsClientImpl::InitPendingRead(
     FileTableEntry& inEntry)
@@ -932,4 +1092,241 @@ KfsClientImpl::GetReadAheadSize(
     return mFileTable[inFd]->buffer.GetBufSize();
 }
 
+AsyncIoQueue*
+KfsClientImpl::CreateAsyncIoQueue()
+{
+    return new AsyncIoQueue();
+}
+
+void
+KfsClientImpl::DisposeAsyncIoQueue(
+    AsyncIoQueue* inQueuePtr)
+{
+    delete inQueuePtr;
+}
+
+int
+KfsClientImpl::AsyncPRead(
+    AsyncIoQueue* inQueuePtr,
+    int           inFd,
+    chunkOff_t    inPos,
+    char*         inBufPtr,
+    size_t        inSize,
+    void*         inUserDataPtr)
+{
+    if (! inQueuePtr || ! inBufPtr || inPos < 0) {
+        return -EINVAL;
+    }
+
+    QCStMutexLocker theLocker(mMutex);
+
+    if (! valid_fd(inFd)) {
+        KFS_LOG_STREAM_ERROR <<
+            "async read error invalid fd: " << inFd <<
+        KFS_LOG_EOM;
+        return -EBADF;
+    }
+    FileTableEntry& theEntry = *mFileTable[inFd];
+    if (theEntry.openMode == O_WRONLY || theEntry.cachedAttrFlag) {
+        return -EINVAL;
+    }
+    if (theEntry.fattr.isDirectory) {
+        return -EISDIR;
+    }
+    const int theSize = ReadRequest::MaxRequestSize(
+        theEntry, (int)min(inSize, kMaxReadSize), inPos);
+    inQueuePtr->Start();
+    if (theSize <= 0) {
+        theLocker.Unlock();
+        inQueuePtr->Done(inFd, 0, inUserDataPtr);
+        return 0;
+    }
+    StartProtocolWorker();
+    theEntry.readUsedProtocolWorkerFlag = true;
+    AsyncReadRequest& theReq = *(new AsyncReadRequest(
+        *inQueuePtr,
+        inFd,
+        inUserDataPtr,
+        theEntry,
+        inBufPtr,
+        theSize,
+        inPos
+    ));
+    theLocker.Unlock();
+    QCASSERT(! mMutex.IsOwned());
+
+    mProtocolWorker->Enqueue(theReq);
+    return 0;
+}
+
+int
+KfsClientImpl::GetAsyncIoCompletions(
+    AsyncIoQueue*                 inQueuePtr,
+    KfsClient::AsyncIoCompletion* inCompletionsPtr,
+    int                           inMaxCount,
+    int                           inMinCount,
+    int                           inTimeoutMs)
+{
+    if (! inQueuePtr) {
+        return -EINVAL;
+    }
+    return inQueuePtr->Get(
+        inCompletionsPtr, inMaxCount, inMinCount, inTimeoutMs);
+}
+
+class ReadRangeOffsetLess
+{
+public:
+    ReadRangeOffsetLess(
+        const KfsClient::ReadRange* inRangesPtr)
+        : mRangesPtr(inRangesPtr)
+        {}
+    bool operator()(
+        int inLeft,
+        int inRight) const
+    {
+        return (mRangesPtr[inLeft].offset < mRangesPtr[inRight].offset ||
+            (mRangesPtr[inLeft].offset == mRangesPtr[inRight].offset &&
+            inLeft < inRight));
+    }
+private:
+    const KfsClient::ReadRange* const mRangesPtr;
+};
+
+// Coalesced vectored read ranges.
+struct ReadRangeGroup
+{
+    chunkOff_t mOffset;
+    chunkOff_t mEnd;
+    size_t     mFirst;
+    size_t     mLast;
+    char*      mBufPtr;
+    ssize_t    mStatus;
+    int64_t    mCompletionUsec;
+};
+
+int
+KfsClientImpl::PReadV(
+    int                   inFd,
+    KfsClient::ReadRange* inRangesPtr,
+    int                   inCount,
+    size_t                inCoalesceGap)
+{
+    if (inCount <= 0) {
+        return 0;
+    }
+    if (! inRangesPtr) {
+        return -EINVAL;
+    }
+    const int64_t theStart = microseconds();
+    // Sort ranges by offset, and coalesce ranges within the same chunk that
+    // are no more than coalesce gap apart into a single read, in order to
+    // reduce the number of chunk server round trips. Coalesced ranges are
+    // read into temporary buffer, and then copied into the range buffers.
+    vector<int> theIdxs;
+    theIdxs.reserve(inCount);
+    int theRet = 0;
+    for (int i = 0; i < inCount; i++) {
+        KfsClient::ReadRange& theRange = inRangesPtr[i];
+        theRange.status         = 0;
+        theRange.completionUsec = 0;
+        if (theRange.offset < 0 || (! theRange.buf && 0 < theRange.size)) {
+            theRange.status = -EINVAL;
+            if (0 <= theRet) {
+                theRet = -EINVAL;
+            }
+        } else if (0 < theRange.size) {
+            theIdxs.push_back(i);
+        }
+    }
+    sort(theIdxs.begin(), theIdxs.end(), ReadRangeOffsetLess(inRangesPtr));
+    typedef ReadRangeGroup Group;
+    vector<Group> theGroups;
+    for (size_t i = 0; i < theIdxs.size(); i++) {
+        const KfsClient::ReadRange& theRange  = inRangesPtr[theIdxs[i]];
+        const chunkOff_t            theEnd    =
+            theRange.offset + (chunkOff_t)theRange.size;
+        if (! theGroups.empty()) {
+            Group& theGroup = theGroups.back();
+            const chunkOff_t theChunkStart =
+                theGroup.mOffset / (chunkOff_t)CHUNKSIZE;
+            if (theRange.offset <=
+                        theGroup.mEnd + (chunkOff_t)inCoalesceGap &&
+                    theChunkStart ==
+                        (theEnd - 1) / (chunkOff_t)CHUNKSIZE) {
+                theGroup.mEnd  = max(theGroup.mEnd, theEnd);
+                theGroup.mLast = i;
+                continue;
+            }
+        }
+        Group theGroup;
+        theGroup.mOffset = theRange.offset;
+        theGroup.mEnd    = theEnd;
+        theGroup.mFirst  = i;
+        theGroup.mLast   = i;
+        theGroup.mBufPtr = theRange.buf;
+        theGroup.mStatus = 0;
+        theGroup.mCompletionUsec = 0;
+        theGroups.push_back(theGroup);
+    }
+    AsyncIoQueue theQueue;
+    int          theInFlightCount = 0;
+    for (size_t i = 0; i < theGroups.size(); i++) {
+        Group& theGroup = theGroups[i];
+        if (theGroup.mFirst != theGroup.mLast) {
+            theGroup.mBufPtr = new char[theGroup.mEnd - theGroup.mOffset];
+        }
+        const int theStatus = AsyncPRead(&theQueue, inFd, theGroup.mOffset,
+            theGroup.mBufPtr, (size_t)(theGroup.mEnd - theGroup.mOffset),
+            reinterpret_cast<void*>(i));
+        if (theStatus < 0) {
+            theGroup.mStatus         = theStatus;
+            theGroup.mCompletionUsec = microseconds() - theStart;
+        } else {
+            theInFlightCount++;
+        }
+    }
+    const int                    kMaxCompletions = 64;
+    KfsClient::AsyncIoCompletion theCompletions[kMaxCompletions];
+    while (0 < theInFlightCount) {
+        // Retrieve completions as soon as these become available, in order to
+        // record each read completion time.
+        const int     theCnt  = theQueue.Get(
+            theCompletions, kMaxCompletions, 1, -1);
+        const int64_t theTime = microseconds() - theStart;
+        for (int k = 0; k < theCnt; k++) {
+            Group& theGroup = theGroups[reinterpret_cast<size_t>(
+                theCompletions[k].userData)];
+            theGroup.mStatus         = theCompletions[k].status;
+            theGroup.mCompletionUsec = theTime;
+        }
+        theInFlightCount -= max(0, theCnt);
+    }
+    for (size_t i = 0; i < theGroups.size(); i++) {
+        Group& theGroup = theGroups[i];
+        for (size_t k = theGroup.mFirst; k <= theGroup.mLast; k++) {
+            KfsClient::ReadRange& theRange = inRangesPtr[theIdxs[k]];
+            theRange.completionUsec = theGroup.mCompletionUsec;
+            if (theGroup.mStatus < 0) {
+                theRange.status = theGroup.mStatus;
+                if (0 <= theRet) {
+                    theRet = (int)theGroup.mStatus;
+                }
+                continue;
+            }
+            const chunkOff_t thePos = theRange.offset - theGroup.mOffset;
+            theRange.status = (ssize_t)max(chunkOff_t(0), min(
+                (chunkOff_t)theRange.size, theGroup.mStatus - thePos));
+            if (theGroup.mFirst != theGroup.mLast && 0 < theRange.status) {
+                memcpy(theRange.buf, theGroup.mBufPtr + thePos,
+                    (size_t)theRange.status);
+            }
+        }
+        if (theGroup.mFirst != theGroup.mLast) {
+            delete [] theGroup.mBufPtr;
+        }
+    }
+    return theRet;
+}
+
 }}
@@ -29,6 +29,7 @@
 #include "KfsClientInt.h"
 #include "KfsOps.h"
 #include "MonitorCommon.h"
+#include "OpLatencyStats.h"
 
 #include "common/DynamicArray.h"
 #include "common/kfsdecls.h"
@@ -63,6 +64,7 @@ using std::pair;
 using std::string;
 using std::swap;
 using std::vector;
+using client::OpLatencyStats;
 
 class Monitor::Impl: public QCRunnable {
 
@@ -380,6 +382,8 @@ private:
                         }
                         diffOfCounters.insert(make_pair(counterName, reportVal));
                     }
+                    // Report the latency quantiles of this interval.
+                    OpLatencyStats::BucketsToQuantiles(diffOfCounters);
                     mPluginReportFuncHandle(fsLoc.hostname, fsLoc.port,
                             diffOfCounters, fsMetrics.errorCountersMap);
                 }
@@ -387,8 +391,10 @@ private:
                     // Since this is the first time that a report is sent to
                     // plugin, there are no counters in current sum. Use values
                     // in new sum directly.
+                    ClientCounters reportCounters(newSumOfClientCounters);
+                    OpLatencyStats::BucketsToQuantiles(reportCounters);
                     mPluginReportFuncHandle(fsLoc.hostname, fsLoc.port,
-                            newSumOfClientCounters, fsMetrics.errorCountersMap);
+                            reportCounters, fsMetrics.errorCountersMap);
                 }
                 // Save new sum of client counters as current for next report.
                 swap(fsMetrics.currSumOfClientCounters, newSumOfClientCounters);
@@ -0,0 +1,277 @@
+//---------------------------------------------------------- -*- Mode: C++ -*-
+// $Id$
+//
+// Created 2026/10/19
+//
+// Copyright 2026 Quantcast Corporation. All rights reserved.
+//
+// This file is part of Kosmos File System (KFS).
+//
+// Licensed under the Apache License, Version 2.0
+// (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+// implied. See the License for the specific language governing
+// permissions and limitations under the License.
+//
+// \brief Client rpc latency histograms.
+//
+//----------------------------------------------------------------------------
+
+#ifndef OP_LATENCY_STATS_H
+#define OP_LATENCY_STATS_H
+
+#include "common/kfsatomic.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace KFS
+{
+namespace client
+{
+
+// Rpc latency histograms by op category. The histogram bucket boundaries are
+// log linear, similarly to HDR histogram: each power of 2 microseconds
+// interval is split into 2^kSubBucketBits buckets of equal width.
+// Record() uses only atomic increments, and can be invoked concurrently
+// by the client and the protocol worker threads.
+// All counters are cumulative, including the histogram buckets, in order to
+// allow summing the counters of multiple clients, and computing the interval
+// counters as the difference. Only non empty buckets are reported.
+// BucketsToQuantiles() converts the bucket counters into the quantiles
+// "Latency.<category>.P<quantile>Usec", where each quantile is the upper bound
+// of the bucket that contains it, i.e. accurate to within 1/2^kSubBucketBits.
+class OpLatencyStats
+{
+public:
+    typedef int64_t Counter;
+    enum Category
+    {
+        kCategoryMeta       = 0,
+        kCategoryChunkRead  = 1,
+        kCategoryChunkWrite = 2,
+        kCategoryChunkOther = 3,
+        kCategoryCount
+    };
+    enum
+    {
+        kSubBucketBits = 3,
+        kMinBucketBits = 7,  // 128 usec
+        kMaxBucketBits = 25, // 33.5 sec
+        // Plus underflow and overflow buckets.
+        kBucketCount = ((kMaxBucketBits - kMinBucketBits) << kSubBucketBits) + 2
+    };
+
+    OpLatencyStats(
+        int inTraceSampleInterval = 0)
+        : mTraceSeq(0),
+          mTraceSampleInterval(inTraceSampleInterval)
+        { Clear(); }
+    void Clear()
+    {
+        memset(const_cast<Counter*>(mCount),     0, sizeof(mCount));
+        memset(const_cast<Counter*>(mTotalUsec), 0, sizeof(mTotalUsec));
+        memset(const_cast<Counter*>(mRetried),   0, sizeof(mRetried));
+        memset(const_cast<Counter*>(&mBuckets[0][0]), 0, sizeof(mBuckets));
+    }
+    void SetTraceSampleInterval(
+        int inInterval)
+        { mTraceSampleInterval = inInterval; }
+    // Returns true if the op should be traced.
+    bool Record(
+        Category inCategory,
+        int64_t  inUsec,
+        int      inRetryCount)
+    {
+        if (inCategory < 0 || kCategoryCount <= inCategory) {
+            return false;
+        }
+        const int64_t theUsec = inUsec < 0 ? int64_t(0) : inUsec;
+        SyncAddAndFetch(mBuckets[inCategory][GetBucket(theUsec)], Counter(1));
+        SyncAddAndFetch(mCount[inCategory],     Counter(1));
+        SyncAddAndFetch(mTotalUsec[inCategory], Counter(theUsec));
+        if (0 < inRetryCount) {
+            SyncAddAndFetch(mRetried[inCategory], Counter(1));
+        }
+        const int theInterval = mTraceSampleInterval;
+        return (0 < theInterval &&
+            SyncAddAndFetch(mTraceSeq, Counter(1)) % theInterval == 0);
+    }
+    template<typename T>
+    void Enumerate(
+        T& inFunctor) const
+    {
+        char theName[64];
+        for (int i = 0; i < kCategoryCount; i++) {
+            const char* const theCat = GetCategoryName(Category(i));
+            snprintf(theName, sizeof(theName), "Latency.%s.Count", theCat);
+            inFunctor(theName, SyncLoadAcquire(mCount[i]));
+            snprintf(theName, sizeof(theName), "Latency.%s.TotalUsec", theCat);
+            inFunctor(theName, SyncLoadAcquire(mTotalUsec[i]));
+            snprintf(theName, sizeof(theName), "Latency.%s.Retried", theCat);
+            inFunctor(theName, SyncLoadAcquire(mRetried[i]));
+            for (int k = 0; k < kBucketCount; k++) {
+                const Counter theCount = SyncLoadAcquire(mBuckets[i][k]);
+                if (theCount <= 0) {
+                    continue;
+                }
+                GetBucketName(Category(i), k, theName, sizeof(theName));
+                inFunctor(theName, theCount);
+            }
+        }
+    }
+    // Replaces the histogram bucket counters in the counters map with the
+    // quantiles "Latency.<category>.P<quantile>Usec". Intended to be applied
+    // to the difference of the cumulative counters, in order to report the
+    // quantiles of the latencies recorded during the reporting interval.
+    // The bucket counters of multiple clients can be summed before the
+    // quantiles are computed.
+    template<typename T>
+    static void BucketsToQuantiles(
+        T& ioCounters)
+    {
+        static const struct
+        {
+            const char* mNamePtr;
+            int         mPerTenThousand;
+        } kQuantiles[] = {
+            { "P50",  5000 },
+            { "P90",  9000 },
+            { "P99",  9900 },
+            { "P999", 9990 }
+        };
+        char theName[64];
+        for (int i = 0; i < kCategoryCount; i++) {
+            Counter theBuckets[kBucketCount];
+            Counter theTotal = 0;
+            bool    theFoundFlag = false;
+            for (int k = 0; k < kBucketCount; k++) {
+                GetBucketName(Category(i), k, theName, sizeof(theName));
+                typename T::iterator const theIt = ioCounters.find(theName);
+                if (theIt == ioCounters.end()) {
+                    theBuckets[k] = 0;
+                    continue;
+                }
+                theFoundFlag  = true;
+                theBuckets[k] = theIt->second < 0 ? Counter(0) :
+                    Counter(theIt->second);
+                theTotal += theBuckets[k];
+                ioCounters.erase(theIt);
+            }
+            if (! theFoundFlag) {
+                continue;
+            }
+            const char* const theCat = GetCategoryName(Category(i));
+            for (size_t q = 0; q < sizeof(kQuantiles) / sizeof(kQuantiles[0]);
+                    q++) {
+                snprintf(theName, sizeof(theName), "Latency.%s.%sUsec",
+                    theCat, kQuantiles[q].mNamePtr);
+                ioCounters[theName] = GetQuantile(
+                    theBuckets, theTotal, kQuantiles[q].mPerTenThousand);
+            }
+        }
+    }
+    // Bucket counter name: "Latency.<category>.LtUsec.<upper bound>", or
+    // "Latency.<category>.LtUsec.Max" for the overflow bucket.
+    static void GetBucketName(
+        Category inCategory,
+        int      inBucket,
+        char*    inNamePtr,
+        size_t   inNameSize)
+    {
+        if (inBucket + 1 < kBucketCount) {
+            snprintf(inNamePtr, inNameSize, "Latency.%s.LtUsec.%lld",
+                GetCategoryName(inCategory),
+                (long long)GetBucketUpperBound(inBucket));
+        } else {
+            snprintf(inNamePtr, inNameSize, "Latency.%s.LtUsec.Max",
+                GetCategoryName(inCategory));
+        }
+    }
+    // Returns the upper bound of the bucket that contains the quantile, or 0
+    // if the histogram is empty. The overflow bucket quantile is reported as
+    // its lower bound.
+    static int64_t GetQuantile(
+        const Counter* inBucketsPtr,
+        Counter        inTotal,
+        int            inPerTenThousand)
+    {
+        if (inTotal <= 0) {
+            return 0;
+        }
+        // Rank of the quantile, rounded up, 1 based.
+        const Counter theRank = (inTotal * inPerTenThousand + 9999) / 10000;
+        Counter       theSum  = 0;
+        for (int k = 0; k + 1 < kBucketCount; k++) {
+            theSum += inBucketsPtr[k];
+            if (theRank <= theSum) {
+                return GetBucketUpperBound(k);
+            }
+        }
+        return (int64_t(1) << kMaxBucketBits);
+    }
+    static const char* GetCategoryName(
+        Category inCategory)
+    {
+        switch (inCategory) {
+            case kCategoryMeta:       return "Meta";
+            case kCategoryChunkRead:  return "ChunkRead";
+            case kCategoryChunkWrite: return "ChunkWrite";
+            case kCategoryChunkOther: return "ChunkOther";
+            default:                  break;
+        }
+        return "Unknown";
+    }
+    static int GetBucket(
+        int64_t inUsec)
+    {
+        if (inUsec < (int64_t(1) << kMinBucketBits)) {
+            return 0;
+        }
+        int theBits = kMinBucketBits;
+        while (theBits < kMaxBucketBits && (int64_t(2) << theBits) <= inUsec) {
+            theBits++;
+        }
+        if (kMaxBucketBits <= theBits) {
+            return kBucketCount - 1;
+        }
+        const int theSub = (int)(inUsec >> (theBits - kSubBucketBits)) &
+            ((1 << kSubBucketBits) - 1);
+        return (1 + ((theBits - kMinBucketBits) << kSubBucketBits) + theSub);
+    }
+    // Exclusive upper bound.
+    static int64_t GetBucketUpperBound(
+        int inBucket)
+    {
+        if (inBucket <= 0) {
+            return (int64_t(1) << kMinBucketBits);
+        }
+        const int theBits = kMinBucketBits + ((inBucket - 1) >> kSubBucketBits);
+        const int theSub  = (inBucket - 1) & ((1 << kSubBucketBits) - 1);
+        return ((int64_t(1) << theBits) +
+            (int64_t(theSub + 1) << (theBits - kSubBucketBits)));
+    }
+private:
+    volatile Counter mCount[kCategoryCount];
+    volatile Counter mTotalUsec[kCategoryCount];
+    volatile Counter mRetried[kCategoryCount];
+    volatile Counter mBuckets[kCategoryCount][kBucketCount];
+    volatile Counter mTraceSeq;
+    volatile int     mTraceSampleInterval;
+private:
+    OpLatencyStats(
+        const OpLatencyStats& inStats);
+    OpLatencyStats& operator=(
+        const OpLatencyStats& inStats);
+};
+
+}}
+
+#endif /* OP_LATENCY_STATS_H */
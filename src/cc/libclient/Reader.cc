@@ -67,6 +67,8 @@ using std::random_shuffle;
 using std::vector;
 using std::pair;
 using std::make_pair;
+using std::lower_bound;
+using std::sort;
 
 // Kfs client read state machine implementation.
 class Reader::Impl : public QCRefCountedObj
@@ -102,7 +104,9 @@ public:
         int         inLeaseWaitTimeout,
         string      inLogPrefix,
         int64_t     inChunkServerInitialSeqNum,
-        ClientPool* inClientPoolPtr)
+        ClientPool* inClientPoolPtr,
+        int         inLayoutPrefetchChunkCount,
+        int         inLayoutCacheTimeoutSec)
         : QCRefCountedObj(),
           mOuter(inOuter),
           mMetaServer(inMetaServer),
@@ -131,7 +135,9 @@ public:
           mNetManager(mMetaServer.GetNetManager()),
           mStriperPtr(0),
           mCompletionDepthCount(0),
-          mReplicaCount(-1)
+          mReplicaCount(-1),
+          mLayoutCache(*this, inLayoutPrefetchChunkCount,
+            inLayoutCacheTimeoutSec)
         { Readers::Init(mReaders); }
     int Open(
         kfsFileId_t inFileId,
@@ -167,6 +173,7 @@ public:
         QCASSERT(Readers::IsEmpty(mReaders));
         delete mStriperPtr;
         mStriperPtr = 0;
+        mLayoutCache.Clear();
         mOpenChunkBlockSize = Offset(CHUNKSIZE);
         mReplicaCount       = inReplicasCount;
         string theErrMsg;
@@ -251,6 +258,7 @@ public:
     void Shutdown()
     {
         Stop();
+        mLayoutCache.Clear();
         delete mStriperPtr;
         mStriperPtr = 0;
         mFileId     = -1;
@@ -305,6 +313,212 @@ public:
 private:
     typedef KfsNetClient ChunkServer;
 
+    // Chunk layout cache. Chunk ids, versions, and locations for a range of
+    // chunks are fetched with a single meta server get layout rpc, in order to
+    // avoid issuing get alloc rpc for every chunk read. The cache is
+    // invalidated after the configured timeout, and individual entries are
+    // invalidated on read errors, in order to re-fetch the chunk location with
+    // get alloc.
+    class LayoutCache : private KfsNetClient::OpOwner
+    {
+    public:
+        LayoutCache(
+            Impl& inOuter,
+            int   inPrefetchChunkCount,
+            int   inTimeoutSec)
+            : KfsNetClient::OpOwner(),
+              mOuter(inOuter),
+              mPrefetchChunkCount(inPrefetchChunkCount),
+              mTimeoutSec(inTimeoutSec),
+              mOp(0, -1),
+              mChunks(),
+              mStartPos(-1),
+              mEndPos(-1),
+              mExpireTime(0),
+              mInFlightFlag(false),
+              mAllCSShortRpcFlag(false)
+            {}
+        ~LayoutCache()
+            { LayoutCache::Clear(); }
+        void Clear()
+        {
+            if (mInFlightFlag) {
+                mInFlightFlag = false;
+                mOuter.mMetaServer.Cancel(&mOp, this);
+            }
+            mChunks.clear();
+            mStartPos = -1;
+            mEndPos   = -1;
+        }
+        bool IsEnabled() const
+            { return (0 < mPrefetchChunkCount); }
+        bool Get(
+            GetAllocOp& inOp)
+        {
+            if (! IsEnabled() || mInFlightFlag || mChunks.empty()) {
+                return false;
+            }
+            if (mExpireTime <= mOuter.mNetManager.Now()) {
+                Clear();
+                return false;
+            }
+            ChunkLayoutInfo theKey;
+            theKey.fileOffset = inOp.fileOffset;
+            Chunks::const_iterator const theIt = lower_bound(
+                mChunks.begin(), mChunks.end(), theKey, &Compare);
+            if (theIt == mChunks.end() ||
+                    theIt->fileOffset != inOp.fileOffset ||
+                    theIt->chunkId < 0 ||
+                    theIt->chunkServers.empty()) {
+                return false;
+            }
+            inOp.status             = 0;
+            inOp.chunkId            = theIt->chunkId;
+            inOp.chunkVersion       = theIt->chunkVersion;
+            inOp.chunkServers       = theIt->chunkServers;
+            inOp.serversOrderedFlag = false;
+            inOp.allCSShortRpcFlag  = mAllCSShortRpcFlag;
+            return true;
+        }
+        // Returns true if the layout of the chunk at the specified position
+        // is being fetched, and the caller must wait for completion.
+        bool Prefetch(
+            Offset inPos)
+        {
+            if (! IsEnabled()) {
+                return false;
+            }
+            const Offset kChunkSize = (Offset)CHUNKSIZE;
+            if (mInFlightFlag) {
+                return (mStartPos <= inPos &&
+                    inPos < mStartPos + mPrefetchChunkCount * kChunkSize);
+            }
+            if (mStartPos <= inPos && inPos < mEndPos &&
+                    mOuter.mNetManager.Now() < mExpireTime) {
+                // Hole, or invalidated entry, use get alloc.
+                return false;
+            }
+            Clear();
+            mOp.seq                      = 0;
+            mOp.status                   = 0;
+            mOp.lastError                = 0;
+            mOp.statusMsg.clear();
+            mOp.contentLength            = 0;
+            mOp.DeallocContentBuf();
+            mOp.fid                      = mOuter.mFileId;
+            mOp.startOffset              = inPos;
+            mOp.maxChunks                = mPrefetchChunkCount;
+            mOp.continueIfNoReplicasFlag = true;
+            mOp.numChunks                = 0;
+            mOp.hasMoreChunksFlag        = false;
+            mOp.allCSShortRpcFlag        = false;
+            mOp.chunks.clear();
+            mStartPos     = inPos;
+            mInFlightFlag = true;
+            mOuter.mStats.mMetaOpsQueuedCount++;
+            mOuter.mStats.mChunkLayoutPrefetchCount++;
+            KFS_LOG_STREAM_DEBUG << mOuter.mLogPrefix <<
+                "+> meta " << mOp.Show() <<
+                " pos: "   << inPos <<
+                " max: "   << mPrefetchChunkCount <<
+            KFS_LOG_EOM;
+            if (! mOuter.mMetaServer.Enqueue(&mOp, this)) {
+                mOuter.InternalError("meta op enqueue failure");
+                mInFlightFlag = false;
+                return false;
+            }
+            return true;
+        }
+        void Invalidate(
+            Offset inPos)
+        {
+            ChunkLayoutInfo theKey;
+            theKey.fileOffset = inPos;
+            Chunks::iterator const theIt = lower_bound(
+                mChunks.begin(), mChunks.end(), theKey, &Compare);
+            if (theIt != mChunks.end() && theIt->fileOffset == inPos &&
+                    0 <= theIt->chunkId) {
+                theIt->chunkId = -1;
+                mOuter.mStats.mChunkLayoutInvalidateCount++;
+            }
+        }
+    private:
+        typedef vector<ChunkLayoutInfo> Chunks;
+
+        Impl&       mOuter;
+        const int   mPrefetchChunkCount;
+        const int   mTimeoutSec;
+        GetLayoutOp mOp;
+        Chunks      mChunks;
+        Offset      mStartPos;
+        Offset      mEndPos;
+        time_t      mExpireTime;
+        bool        mInFlightFlag;
+        bool        mAllCSShortRpcFlag;
+
+        static bool Compare(
+            const ChunkLayoutInfo& inLhs,
+            const ChunkLayoutInfo& inRhs)
+            { return (inLhs.fileOffset < inRhs.fileOffset); }
+        virtual void OpDone(
+            KfsOp*    inOpPtr,
+            bool      inCanceledFlag,
+            IOBuffer* inBufferPtr)
+        {
+            QCASSERT(inOpPtr == &mOp && ! inBufferPtr);
+            if (inCanceledFlag) {
+                mOuter.mStats.mMetaOpsCancelledCount++;
+                return;
+            }
+            if (! mInFlightFlag) {
+                return;
+            }
+            mInFlightFlag = false;
+            KFS_LOG_STREAM_DEBUG << mOuter.mLogPrefix <<
+                "<- meta " << mOp.Show() <<
+                " status: "  << mOp.status <<
+                " msg: "     << mOp.statusMsg <<
+                " chunks: "  << mOp.numChunks <<
+                " more: "    << mOp.hasMoreChunksFlag <<
+            KFS_LOG_EOM;
+            const Offset kChunkSize = (Offset)CHUNKSIZE;
+            mExpireTime = mOuter.mNetManager.Now() + mTimeoutSec;
+            mEndPos     = mStartPos + mPrefetchChunkCount * kChunkSize;
+            if (mOp.status == 0 && mOp.ParseLayoutInfo() != 0) {
+                mOp.status    = kErrorParameters;
+                mOp.statusMsg = "failed to parse layout info";
+            }
+            mOp.DeallocContentBuf();
+            if (mOp.status == 0) {
+                mChunks.swap(mOp.chunks);
+                sort(mChunks.begin(), mChunks.end(), &Compare);
+                mAllCSShortRpcFlag = mOp.allCSShortRpcFlag;
+                if (! mOp.hasMoreChunksFlag) {
+                    mEndPos = std::numeric_limits<Offset>::max();
+                } else if (! mChunks.empty()) {
+                    mEndPos = mChunks.back().fileOffset + kChunkSize;
+                }
+            } else {
+                // Use get alloc for the fetched range until the cache
+                // expires.
+                KFS_LOG_STREAM_ERROR << mOuter.mLogPrefix <<
+                    "get layout failure:"
+                    " pos: "    << mStartPos <<
+                    " status: " << mOp.status <<
+                    " msg: "    << mOp.statusMsg <<
+                KFS_LOG_EOM;
+                mChunks.clear();
+            }
+            mOp.chunks.clear();
+            mOuter.LayoutDone();
+        }
+    private:
+        LayoutCache(
+            const LayoutCache& inCache);
+        LayoutCache& operator=(
+            const LayoutCache& inCache);
+    };
+
     class ChunkReader : private ITimeout, private KfsNetClient::OpOwner
     {
     public:
@@ -441,6 +655,7 @@ private:
               mStartReadRunningFlag(false),
               mRestartStartReadFlag(false),
               mSizeOpInFlightFlag(false),
+              mLayoutWaitFlag(false),
               mLeaseToRelinquish(-1),
               mLogPrefix(inLogPrefix),
               mOpsNoRetryCount(0),
@@ -453,6 +668,8 @@ private:
             Readers::Init(*this);
             Readers::PushFront(mOuter.mReaders, *this);
             mChunkServer.SetRetryConnectOnly(true);
+            mChunkServer.SetOpLatencyStats(
+                mOuter.mMetaServer.GetOpLatencyStats(), false);
             mGetAllocOp.fileOffset  = -1;
             mGetAllocOp.chunkId     = -1;
             mLeaseAcquireOp.chunkId = -1;
@@ -697,6 +914,13 @@ private:
             return (mGetAllocOp.chunkId >= 0 ?
                 mGetAllocOp.chunkVersion : int64_t(-1));
         }
+        bool IsWaitingForLayout() const
+            { return mLayoutWaitFlag; }
+        void LayoutDone()
+        {
+            mLayoutWaitFlag = false;
+            StartRead();
+        }
     private:
         class StRunningCompletion
         {
@@ -796,6 +1020,7 @@ private:
         bool                 mStartReadRunningFlag;
         bool                 mRestartStartReadFlag;
         bool                 mSizeOpInFlightFlag;
+        bool                 mLayoutWaitFlag;
         int64_t              mLeaseToRelinquish;
         string const         mLogPrefix;
         int                  mOpsNoRetryCount;
@@ -922,6 +1147,8 @@ private:
                 if (mOuter.mClientPoolPtr) {
                     mChunkServerPtr = &mOuter.mClientPoolPtr->Get(
                         theLocation, mGetAllocOp.allCSShortRpcFlag);
+                    mChunkServerPtr->SetOpLatencyStats(
+                        mOuter.mMetaServer.GetOpLatencyStats(), false);
                 } else {
                     mChunkServerPtr = &mChunkServer;
                     mChunkServer.SetRpcFormat(mGetAllocOp.allCSShortRpcFlag ?
@@ -1017,6 +1244,18 @@ private:
             mGetAllocOp.chunkServers.clear();
             mGetAllocOp.serversOrderedFlag = false;
             mGetAllocOp.allCSShortRpcFlag  = false;
+            if (! mGetAllocOp.objectStoreFlag &&
+                    mOuter.mLayoutCache.IsEnabled()) {
+                if (mOuter.mLayoutCache.Get(mGetAllocOp)) {
+                    mOuter.mStats.mChunkLayoutCacheHitCount++;
+                    Done(mGetAllocOp, false, 0);
+                    return;
+                }
+                if (mOuter.mLayoutCache.Prefetch(mGetAllocOp.fileOffset)) {
+                    mLayoutWaitFlag = true;
+                    return;
+                }
+            }
             EnqueueMeta(mGetAllocOp);
         }
         void Done(
@@ -1718,7 +1957,8 @@ private:
         void Reset()
         {
             CancelMetaOps();
-            mLastOpPtr = 0;
+            mLastOpPtr      = 0;
+            mLayoutWaitFlag = false;
             StopChunkServer();
             mChunkServerSetFlag = false;
             QCASSERT(Queue::IsEmpty(mInFlightQueue));
@@ -1834,6 +2074,8 @@ private:
                             mRetryCount++;
                             // Restart from get alloc, chunk might have been
                             // moved or re-replicated.
+                            mOuter.mLayoutCache.Invalidate(
+                                mGetAllocOp.fileOffset);
                             mGetAllocOp.status  = 0;
                             mGetAllocOp.chunkId = -1;
                             if (mNoCSAccessFlag ||
@@ -2236,6 +2478,7 @@ private:
     Striper*            mStriperPtr;
     int                 mCompletionDepthCount;
     int                 mReplicaCount;
+    LayoutCache         mLayoutCache;
     ChunkReader*        mReaders[1];
 
     void InternalError(
@@ -2305,6 +2548,25 @@ private:
         }
         return mErrorCode;
     }
+    void LayoutDone()
+    {
+        StRef             theRef(*this);
+        Readers::Iterator theIt(mReaders);
+        ChunkReader*      thePtr;
+        while ((thePtr = theIt.Next())) {
+            if (! thePtr->IsWaitingForLayout()) {
+                continue;
+            }
+            const int thePrevRefCount = GetRefCount();
+            thePtr->LayoutDone();
+            if (thePrevRefCount > GetRefCount()) {
+                return; // Unwind.
+            }
+            // Restart from the beginning, as read completion can remove
+            // readers.
+            theIt.Reset();
+        }
+    }
     int QueueRead(
         IOBuffer& inBuffer,
         int       inLength,
@@ -2705,7 +2967,9 @@ Reader::Reader(
     int                 inLeaseWaitTimeout,
     const char*         inLogPrefixPtr,
     int64_t             inChunkServerInitialSeqNum,
-    ClientPool*         inClientPoolPtr)
+    ClientPool*         inClientPoolPtr,
+    int                 inLayoutPrefetchChunkCount,
+    int                 inLayoutCacheTimeoutSec)
     : mImpl(*new Reader::Impl(
         *this,
         inMetaServer,
@@ -2720,7 +2984,9 @@ Reader::Reader(
         (inLogPrefixPtr && inLogPrefixPtr[0]) ?
             (inLogPrefixPtr + string(" ")) : string(),
         inChunkServerInitialSeqNum,
-        inClientPoolPtr
+        inClientPoolPtr,
+        inLayoutPrefetchChunkCount,
+        inLayoutCacheTimeoutSec
     ))
 {
     mImpl.Ref();
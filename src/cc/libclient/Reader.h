@@ -93,7 +93,10 @@ public:
               mReadByteCount(0),
               mReadErrorsCount(0),
               mReadChecksumErrorsCount(0),
-              mReadRecoveriesCount(0)
+              mReadRecoveriesCount(0),
+              mChunkLayoutPrefetchCount(0),
+              mChunkLayoutCacheHitCount(0),
+              mChunkLayoutInvalidateCount(0)
             {}
         void Clear()
             { *this = Stats(); }
@@ -113,6 +116,9 @@ public:
             mReadErrorsCount         += inStats.mReadErrorsCount;
             mReadChecksumErrorsCount += inStats.mReadChecksumErrorsCount;
             mReadRecoveriesCount     += inStats.mReadRecoveriesCount;
+            mChunkLayoutPrefetchCount   += inStats.mChunkLayoutPrefetchCount;
+            mChunkLayoutCacheHitCount   += inStats.mChunkLayoutCacheHitCount;
+            mChunkLayoutInvalidateCount += inStats.mChunkLayoutInvalidateCount;
             return *this;
         }
         template<typename T>
@@ -131,6 +137,10 @@ public:
             inFunctor("ReadRecoveries",     mReadRecoveriesCount);
             inFunctor("Reads",              mReadCount);
             inFunctor("ReadBytes",          mReadByteCount);
+            inFunctor("ChunkLayoutPrefetches",  mChunkLayoutPrefetchCount);
+            // Get alloc rpcs avoided.
+            inFunctor("ChunkLayoutCacheHits",   mChunkLayoutCacheHitCount);
+            inFunctor("ChunkLayoutInvalidates", mChunkLayoutInvalidateCount);
         }
         Counter mMetaOpsQueuedCount;
         Counter mMetaOpsCancelledCount;
@@ -145,6 +155,9 @@ public:
         Counter mReadErrorsCount;
         Counter mReadChecksumErrorsCount;
         Counter mReadRecoveriesCount;
+        Counter mChunkLayoutPrefetchCount;
+        Counter mChunkLayoutCacheHitCount;
+        Counter mChunkLayoutInvalidateCount;
     };
     class Striper
     {
@@ -237,7 +250,9 @@ public:
         int         inLeaseWaitTimeout,
         const char* inLogPrefixPtr,
         int64_t     inChunkServerInitialSeqNum,
-        ClientPool* inClientPoolPtr);
+        ClientPool* inClientPoolPtr,
+        int         inLayoutPrefetchChunkCount = 0,
+        int         inLayoutCacheTimeoutSec    = 60);
     virtual ~Reader();
     int Open(
         kfsFileId_t inFileId,
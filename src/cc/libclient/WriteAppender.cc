@@ -157,6 +157,7 @@ public:
     {
         Impl::Reset();
         mChunkServer.SetRetryConnectOnly(true);
+        mChunkServer.SetOpLatencyStats(mMetaServer.GetOpLatencyStats(), false);
     }
     ~Impl()
     {
@@ -1052,6 +1053,8 @@ private:
         if (mClientPoolPtr) {
             mChunkServerPtr = &mClientPoolPtr->Get(
                 theMaster, mAllocOp.allCSShortRpcFlag);
+            mChunkServerPtr->SetOpLatencyStats(
+                mMetaServer.GetOpLatencyStats(), false);
         } else {
             mChunkServerPtr = 0;
             const ServerLocation theCurLoc = mChunkServer.GetServerLocation();
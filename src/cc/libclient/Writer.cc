@@ -39,6 +39,7 @@
 #include "kfsio/ClientAuthContext.h"
 #include "common/kfsdecls.h"
 #include "common/MsgLogger.h"
+#include "common/time.h"
 #include "qcdio/QCUtils.h"
 #include "qcdio/qcstutils.h"
 #include "qcdio/qcdebug.h"
@@ -93,7 +94,8 @@ public:
         int           inIdleTimeoutSec,
         int           inMaxWriteSize,
         const string& inLogPrefix,
-        int64_t       inChunkServerInitialSeqNum)
+        int64_t       inChunkServerInitialSeqNum,
+        int           inMaxChunksInFlight)
         : QCRefCountedObj(),
           ITimeout(),
           KfsNetClient::OpOwner(),
@@ -115,6 +117,7 @@ public:
           mMaxWriteSize(min((int)CHUNKSIZE,
             (int)((max(0, inMaxWriteSize) + CHECKSUM_BLOCKSIZE - 1) /
                 CHECKSUM_BLOCKSIZE * CHECKSUM_BLOCKSIZE))),
+          mMaxChunksInFlight(max(1, inMaxChunksInFlight)),
           mMaxPendingThreshold(mMaxWriteSize),
           mReplicaCount(-1),
           mRetryCount(0),
@@ -129,6 +132,7 @@ public:
           mNetManager(mMetaServer.GetNetManager()),
           mTruncateOp(0, 0, -1, 0),
           mOpStartTime(0),
+          mOpenTimeUsec(0),
           mCompletionDepthCount(0),
           mStriperProcessCount(0),
           mStriperPtr(0)
@@ -201,6 +205,7 @@ public:
         mRetryCount            = 0;
         mMaxPendingThreshold   = Offset(mMaxWriteSize) *
             (mStriperPtr ? max(1, inStripeCount) : 1);
+        mOpenTimeUsec          = microseconds();
         return StartWrite();
     }
     int Close()
@@ -322,6 +327,16 @@ public:
     }
     Offset GetPendingSize() const
         { return (GetPendingSizeSelf() + mPendingCount); }
+    Offset GetMaxPendingSize(
+        Offset inWriteBehindSize) const
+    {
+        if (mMaxChunksInFlight <= 1 || inWriteBehindSize <= 0 ||
+                mStriperPtr || mReplicaCount <= 0) {
+            return inWriteBehindSize;
+        }
+        return (inWriteBehindSize +
+            Offset(mMaxChunksInFlight - 1) * Offset(CHUNKSIZE));
+    }
     int SetWriteThreshold(
         int inThreshold)
     {
@@ -533,6 +548,8 @@ private:
             Writers::Init(*this);
             Writers::PushFront(mOuter.mWriters, *this);
             mChunkServer.SetRetryConnectOnly(true);
+            mChunkServer.SetOpLatencyStats(
+                mOuter.mMetaServer.GetOpLatencyStats(), false);
             mAllocOp.fileOffset        = -1;
             mAllocOp.invalidateAllFlag = false;
         }
@@ -1742,6 +1759,7 @@ private:
     const int           mTimeSecBetweenRetries;
     const int           mMaxPartialBuffersCount;
     const int           mMaxWriteSize;
+    const int           mMaxChunksInFlight;
     Offset              mMaxPendingThreshold;
     int                 mReplicaCount;
     int                 mRetryCount;
@@ -1757,6 +1775,7 @@ private:
     NetManager&         mNetManager;
     TruncateOp          mTruncateOp;
     time_t              mOpStartTime;
+    int64_t             mOpenTimeUsec;
     int                 mCompletionDepthCount;
     int                 mStriperProcessCount;
     Striper*            mStriperPtr;
@@ -1996,6 +2015,21 @@ private:
             Writers::PushFront(mWriters, *thePtr);
             thePtr->CancelClose();
         } else {
+            // Count the chunks with writes in flight, the new chunk writer
+            // starts chunk allocation while these are still in progress.
+            Stats::Counter theInFlightCount = 1;
+            theIt.Reset();
+            while ((thePtr = theIt.Next())) {
+                if (! thePtr->IsIdle()) {
+                    theInFlightCount++;
+                }
+            }
+            if (1 < theInFlightCount) {
+                mStats.mParallelChunkWriteCount++;
+            }
+            if (mStats.mChunkWritersMaxCount < theInFlightCount) {
+                mStats.mChunkWritersMaxCount = theInFlightCount;
+            }
             mChunkServerInitialSeqNum += 10000;
             thePtr = new ChunkWriter(
                 *this, mChunkServerInitialSeqNum, mLogPrefix);
@@ -2115,6 +2149,7 @@ private:
                 if (mTruncateOp.fid < 0 && ! mSleepingFlag) {
                     mClosingFlag = false;
                     mFileId = -1;
+                    ReportThroughput();
                     Striper* const theStriperPtr = mStriperPtr;
                     mStriperPtr = 0;
                     delete theStriperPtr;
@@ -2127,6 +2162,26 @@ private:
         }
         return (theRet && thePrevRefCount <= GetRefCount());
     }
+    void ReportThroughput()
+    {
+        const int64_t theTimeUsec = microseconds() - mOpenTimeUsec;
+        KFS_LOG_STREAM(mMaxChunksInFlight <= 1 ?
+                MsgLogger::kLogLevelDEBUG : MsgLogger::kLogLevelINFO) <<
+            mLogPrefix <<
+            "closed:"
+            " status: "           << mErrorCode <<
+            " bytes: "            << mStats.mWriteByteCount <<
+            " time: "             << theTimeUsec * 1e-6 <<
+            " rate: "             << (theTimeUsec <= 0 ? 0. :
+                mStats.mWriteByteCount * 1e6 /
+                    (theTimeUsec * double(1 << 20))) <<
+            " MB/sec"
+            " chunks: "           << mStats.mChunkAllocCount <<
+            " in flight max: "    << mStats.mChunkWritersMaxCount <<
+            " / "                 << mMaxChunksInFlight <<
+            " parallel: "         << mStats.mParallelChunkWriteCount <<
+        KFS_LOG_EOM;
+    }
     bool IsChunkServerClearTextAllowed()
     {
         ClientAuthContext* const theCtxPtr = mMetaServer.GetAuthContext();
@@ -2206,7 +2261,8 @@ Writer::Writer(
     int                 inIdleTimeoutSec,
     int                 inMaxWriteSize,
     const char*         inLogPrefixPtr,
-    int64_t             inChunkServerInitialSeqNum)
+    int64_t             inChunkServerInitialSeqNum,
+    int                 inMaxChunksInFlight)
     : mImpl(*new Writer::Impl(
         *this,
         inMetaServer,
@@ -2220,7 +2276,8 @@ Writer::Writer(
         inMaxWriteSize,
         (inLogPrefixPtr && inLogPrefixPtr[0]) ?
             (inLogPrefixPtr + string(" ")) : string(),
-        inChunkServerInitialSeqNum
+        inChunkServerInitialSeqNum,
+        inMaxChunksInFlight
     ))
 {
     mImpl.Ref();
@@ -2305,6 +2362,13 @@ Writer::GetPendingSize() const
     return mImpl.GetPendingSize();
 }
 
+Writer::Offset
+Writer::GetMaxPendingSize(
+    Writer::Offset inWriteBehindSize) const
+{
+    return mImpl.GetMaxPendingSize(inWriteBehindSize);
+}
+
 int
 Writer::GetErrorCode() const
 {
@@ -85,7 +85,9 @@ public:
               mRetriesCount(0),
               mWriteCount(0),
               mWriteByteCount(0),
-              mBufferCompactionCount(0)
+              mBufferCompactionCount(0),
+              mParallelChunkWriteCount(0),
+              mChunkWritersMaxCount(0)
             {}
         void Clear()
             { *this = Stats(); }
@@ -104,6 +106,10 @@ public:
             mWriteCount            += inStats.mWriteCount;
             mWriteByteCount        += inStats.mWriteByteCount;
             mBufferCompactionCount += inStats.mBufferCompactionCount;
+            mParallelChunkWriteCount += inStats.mParallelChunkWriteCount;
+            if (mChunkWritersMaxCount < inStats.mChunkWritersMaxCount) {
+                mChunkWritersMaxCount = inStats.mChunkWritersMaxCount;
+            }
             return *this;
         }
         template<typename T>
@@ -122,6 +128,8 @@ public:
             inFunctor("Retries",           mRetriesCount);
             inFunctor("Writes" ,           mWriteCount);
             inFunctor("WriteBytes",        mWriteByteCount);
+            inFunctor("ParallelChunkWrites", mParallelChunkWriteCount);
+            inFunctor("ChunkWritersMax",   mChunkWritersMaxCount);
         }
         Counter mMetaOpsQueuedCount;
         Counter mMetaOpsCancelledCount;
@@ -135,6 +143,8 @@ public:
         Counter mWriteCount;
         Counter mWriteByteCount;
         Counter mBufferCompactionCount;
+        Counter mParallelChunkWriteCount;
+        Counter mChunkWritersMaxCount;
     };
     class Striper
     {
@@ -200,7 +210,8 @@ public:
         int         inIdleTimeoutSec,
         int         inMaxWriteSize,
         const char* inLogPrefixPtr,
-        int64_t     inChunkServerInitialSeqNum);
+        int64_t     inChunkServerInitialSeqNum,
+        int         inMaxChunksInFlight = 1);
     virtual ~Writer();
     int Open(
         kfsFileId_t inFileId,
@@ -227,6 +238,13 @@ public:
     bool IsClosing() const;
     bool IsActive()  const;
     Offset GetPendingSize() const;
+    // Returns the max pending size, given the write behind size, for the
+    // currently open file. With non striped replicated files and more than one
+    // chunk in flight allowed, the pending size is extended by a chunk per
+    // each additional chunk in flight, in order to allow the next chunk write
+    // to start while the previous is still in flight.
+    Offset GetMaxPendingSize(
+        Offset inWriteBehindSize) const;
     int GetErrorCode() const;
     void Register(
         Completion* inCompletionPtr);
@@ -52,13 +52,15 @@ public:
     virtual ~ClientManager();
     void SetMaxClientSockets(int count);
     int GetMaxClientCount() const;
-    bool Bind(const ServerLocation& location, bool ipV6OnlyFlag);
+    bool Bind(const ServerLocation& location, bool ipV6OnlyFlag,
+        bool threadAcceptFlag);
     bool StartAcceptor(int threadCount, int startCpuAffinity,
         MetaDataSync& metaDataSync);
     void Shutdown();
     void ChildAtFork();
     QCMutex& GetMutex();
     void SetParameters(const Properties& params);
+    void WriteThreadsCounters(ostream& os);
     static AuthContext& GetAuthContext(ClientThread* inThread);
     static bool Enqueue(ClientThread* thread, MetaRequest& op)
     {
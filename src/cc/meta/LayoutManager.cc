@@ -8952,6 +8952,8 @@ LayoutManager::Handle(MetaPing& inReq, bool wormModeFlag)
     mPingUpdateTime = TimeNow();
     LogWriter::Counters logCtrs;
     MetaRequest::GetLogWriter().GetCounters(logCtrs);
+    NetManager::PollCounters pollCtrs;
+    mNetManager.GetPollCounters(pollCtrs);
     const MetaFattr* const fa = metatree.getFattr(ROOTFID);
     mWOstream <<
         "Build-version: "       << KFS_BUILD_VERSION_STRING << "\r\n"
@@ -9035,6 +9037,9 @@ LayoutManager::Handle(MetaPing& inReq, bool wormModeFlag)
         "Writable drives= "   << pinger.writableDrives << "\t"
         "Append cache size= " << mARAChunkCache.GetSize() << "\t"
         "Max clients= "       << gNetDispatch.GetMaxClientCount() << "\t"
+    ;
+    gNetDispatch.WriteClientThreadsCounters(mWOstream);
+    mWOstream <<
         "Max chunk srvs= "    << ChunkServer::GetMaxChunkServerCount() << "\t"
         "Buffers total= "     <<
             (mBufferPool ? mBufferPool->GetTotalBufferCount() : 0) << "\t"
@@ -9047,6 +9052,12 @@ LayoutManager::Handle(MetaPing& inReq, bool wormModeFlag)
         "Object store first delete time= " <<
             (mObjStoreFilesDeleteQueue.IsEmpty() ? time_t(0) :
                 TimeNow() - mObjStoreFilesDeleteQueue.Front()->mTime) << "\t"
+        "Net poll calls= "        << pollCtrs.mPollCount << "\t"
+        "Net poll events= "       << pollCtrs.mPollEventCount << "\t"
+        "Net poll ctl calls= "    << pollCtrs.mCtlCount << "\t"
+        "Net poll ctl coalesced= " << pollCtrs.mCtlCoalescedCount << "\t"
+        "Net busy polls= "        << pollCtrs.mBusyPollCount << "\t"
+        "Net busy poll hits= "    << pollCtrs.mBusyPollHitCount << "\t"
         "File count= "            << GetNumFiles() << "\t"
         "Dir count= "             << GetNumDirs() << "\t"
         "Logical Size= "          << (fa ? fa->filesize : chunkOff_t(-1)) << "\t"
@@ -518,7 +518,8 @@ NetDispatch::NetDispatch()
       mCanceledTokens(*(new CanceledTokens())),
       mRunningFlag(false),
       mClientThreadCount(0),
-      mClientThreadsStartCpuAffinity(-1)
+      mClientThreadsStartCpuAffinity(-1),
+      mClientThreadAcceptFlag(false)
 {
 }
 
@@ -536,7 +537,8 @@ NetDispatch::Bind(
     bool                  chunkServerListenerIpV6OnlyFlag)
 {
     return (mClientManager.Bind(
-            clientListenerLocation, clientListenerIpV6OnlyFlag) &&
+            clientListenerLocation, clientListenerIpV6OnlyFlag,
+            mClientThreadAcceptFlag && 0 < mClientThreadCount) &&
         mChunkServerFactory.Bind(globalNetManager(),
             chunkServerListenerLocation, chunkServerListenerIpV6OnlyFlag)
     );
@@ -1064,8 +1066,11 @@ int NetDispatch::SetParameters(const Properties& props)
         mClientThreadsStartCpuAffinity = props.getValue(
             "metaServer.clientThreadStartCpuAffinity",
             mClientThreadsStartCpuAffinity);
+        mClientThreadAcceptFlag = props.getValue(
+            "metaServer.clientThreadAccept",
+            mClientThreadAcceptFlag ? 1 : 0) != 0;
     }
-    // Only main thread listens, and accepts.
+    // Only main thread listens, and accepts, unless reuse port is enabled.
     TcpSocket::SetDefaultRecvBufSize(props.getValue(
         "metaServer.tcpSocket.recvBufSize",
         TcpSocket::GetDefaultRecvBufSize()));
@@ -1076,6 +1081,12 @@ int NetDispatch::SetParameters(const Properties& props)
     globalNetManager().SetMaxAcceptsPerRead(props.getValue(
         "metaServer.net.maxAcceptsPerRead",
         globalNetManager().GetMaxAcceptsPerRead()));
+    globalNetManager().SetBusyPoll(props.getValue(
+        "metaServer.net.busyPollUsec",
+        globalNetManager().GetBusyPoll()));
+    TcpSocket::SetDefaultBusyPollUsec(props.getValue(
+        "metaServer.tcpSocket.busyPollUsec",
+        TcpSocket::GetDefaultBusyPollUsec()));
 
     sReqStatsGatherer.SetParameters(props);
     mClientManager.SetParameters(props);
@@ -1357,6 +1368,7 @@ public:
     Impl()
         : IAcceptorOwner(),
           mAcceptor(0),
+          mThreadAcceptFlag(false),
           mClientThreads(0),
           mClientThreadCount(-1),
           mNextThreadIdx(0),
@@ -1371,10 +1383,14 @@ public:
           mPrepareToForkCnt(0)
         {};
     virtual ~Impl();
-    bool Bind(const ServerLocation& location, bool ipV6OnlyFlag);
+    bool Bind(const ServerLocation& location, bool ipV6OnlyFlag,
+        bool threadAcceptFlag);
     bool StartAcceptor(int threadCount, int startCpuAffinity,
         MetaDataSync& metaDataSync);
     virtual KfsCallbackObj* CreateKfsCallbackObj(NetConnectionPtr &conn);
+    KfsCallbackObj* CreateKfsCallbackObj(NetConnectionPtr &conn,
+        ClientManager::ClientThread* thread);
+    void WriteThreadsCounters(ostream& os);
     void Shutdown();
     void ChildAtFork();
     QCMutex& GetMutex()
@@ -1446,6 +1462,7 @@ private:
     class ClientThread;
     // The socket object which is setup to accept connections.
     Acceptor*                    mAcceptor;
+    bool                         mThreadAcceptFlag;
     ClientManager::ClientThread* mClientThreads;
     int                          mClientThreadCount;
     int                          mNextThreadIdx;
@@ -1537,12 +1554,14 @@ MainThreadPrepareToFork::DispatchEnd()
 // connections.
 class ClientManager::ClientThread :
     public QCRunnable,
-    private NetManager::Dispatcher
+    private NetManager::Dispatcher,
+    private IAcceptorOwner
 {
 public:
     ClientThread()
         : QCRunnable(),
           NetManager::Dispatcher(),
+          IAcceptorOwner(),
           mMutex(0),
           mThread(),
           mNetManager(),
@@ -1552,7 +1571,13 @@ public:
           mReqPendingQueue(),
           mFlushQueue(8 << 10),
           mAuthContext(),
-          mAuthCtxUpdateCount(gLayoutManager.GetAuthCtxUpdateCount() - 1)
+          mAuthCtxUpdateCount(gLayoutManager.GetAuthCtxUpdateCount() - 1),
+          mClientManagerImpl(0),
+          mAcceptor(0),
+          mAcceptorLocation(),
+          mAcceptorListener(0),
+          mAcceptCount(0),
+          mConnectionCount(0)
     {
         gLayoutManager.UpdateClientAuthContext(
             mAuthCtxUpdateCount, mAuthContext);
@@ -1566,6 +1591,7 @@ public:
         }
         ClientThread::DispatchStart();
         assert(mCliQueue.IsEmpty());
+        delete mAcceptor;
     }
     bool Start(QCMutex* mutex, int cpuIndex)
     {
@@ -1626,7 +1652,12 @@ public:
         QCStMutexLocker threadQueuesLocker(mMutex);
         reqQueue.PushBack(mReqQueue);
         cliQueue.PushBack(mCliQueue);
+        TcpSocket* const acceptorListener = mAcceptorListener;
+        mAcceptorListener = 0;
         threadQueuesLocker.Unlock();
+        if (acceptorListener) {
+            StartAcceptorSelf(acceptorListener);
+        }
 
         // Send responses. Try to minimize number of system calls by
         // attempting to send multiple responses with single write call.
@@ -1678,9 +1709,29 @@ public:
         CheckIfIoBuffersAvailable();
     }
     virtual void DispatchEnd()
-        {}
+        { mConnectionCount = mNetManager.GetConnectionCount(); }
     virtual void DispatchExit()
         {}
+    // Accept connections on the duplicate of the main acceptor listening
+    // socket in this thread's net manager, in parallel with the main thread
+    // and the other client threads. Takes ownership of the socket.
+    void StartAcceptor(ClientManager::Impl& impl,
+        const ServerLocation& location, TcpSocket* listener)
+    {
+        QCStMutexLocker locker(mMutex);
+        delete mAcceptorListener;
+        mClientManagerImpl = &impl;
+        mAcceptorLocation  = location;
+        mAcceptorListener  = listener;
+        locker.Unlock();
+        mNetManager.Wakeup();
+    }
+    void GetCounters(int64_t& acceptCount, int64_t& connectionCount)
+    {
+        QCStMutexLocker locker(mMutex);
+        acceptCount     = mAcceptCount;
+        connectionCount = mConnectionCount;
+    }
     void Enqueue(MetaRequest& op)
     {
         if (! op.clnt) {
@@ -1755,12 +1806,48 @@ private:
     AuthContext        mAuthContext;
     uint64_t           mAuthCtxUpdateCount;
     bool               mPrimaryFlag;
+    ClientManager::Impl* mClientManagerImpl;
+    Acceptor*          mAcceptor;
+    ServerLocation     mAcceptorLocation;
+    TcpSocket*         mAcceptorListener;
+    int64_t            mAcceptCount;
+    volatile int       mConnectionCount;
     char               mParseBuffer[MAX_RPC_HEADER_LEN];
 
     const NetConnectionPtr& GetConnection(MetaRequest& op)
     {
         return static_cast<ClientSM*>(op.clnt)->GetConnection();
     }
+    virtual KfsCallbackObj* CreateKfsCallbackObj(NetConnectionPtr& conn)
+    {
+        QCStMutexLocker locker(mMutex);
+        mAcceptCount++;
+        locker.Unlock();
+        return mClientManagerImpl->CreateKfsCallbackObj(conn, this);
+    }
+    void StartAcceptorSelf(TcpSocket* listener)
+    {
+        if (! mNetManager.IsRunning() || ! mClientManagerImpl) {
+            delete listener;
+            return;
+        }
+        delete mAcceptor;
+        // The acceptor takes ownership of the listening socket.
+        mAcceptor = new Acceptor(
+            mNetManager, mAcceptorLocation, listener, this);
+        if (mAcceptor->IsAcceptorStarted()) {
+            KFS_LOG_STREAM_INFO <<
+                "client thread acceptor started on: " << mAcceptorLocation <<
+            KFS_LOG_EOM;
+        } else {
+            KFS_LOG_STREAM_ERROR <<
+                "failed to start client thread acceptor on: " <<
+                    mAcceptorLocation <<
+            KFS_LOG_EOM;
+            delete mAcceptor;
+            mAcceptor = 0;
+        }
+    }
 private:
     ClientThread(const ClientThread&);
     ClientThread& operator=(const ClientThread&);
@@ -1772,10 +1859,12 @@ ClientManager::Impl::~Impl()
 }
 
 bool
-ClientManager::Impl::Bind(const ServerLocation& location, bool ipV6OnlyFlag)
+ClientManager::Impl::Bind(const ServerLocation& location, bool ipV6OnlyFlag,
+    bool threadAcceptFlag)
 {
     delete mAcceptor;
     mAcceptor = 0;
+    mThreadAcceptFlag = threadAcceptFlag;
     const bool kBindOnlyFlag = true;
     mAcceptor = new Acceptor(
         globalNetManager(), location, ipV6OnlyFlag, this, kBindOnlyFlag);
@@ -1814,6 +1903,21 @@ ClientManager::Impl::StartAcceptor(int threadCount, int startCpuAffinity,
                 cpuIndex++;
             }
         }
+        if (mThreadAcceptFlag) {
+            // The main thread acceptor continues to listen, and accept
+            // connections. The client threads accept on the duplicates of
+            // the main acceptor socket, as binding the same port more than
+            // once would require SO_REUSEPORT, which also permits another
+            // meta server instance to silently bind the same port.
+            for (int i = 0; i < mClientThreadCount; i++) {
+                TcpSocket* const listener = mAcceptor->DupListener();
+                if (! listener) {
+                    break;
+                }
+                mClientThreads[i].StartAcceptor(
+                    *this, mAcceptor->GetLocation(), listener);
+            }
+        }
     }
     metaDataSync.StartLogSync(
         MetaRequest::GetLogWriter().GetCommittedLogSeq()
@@ -1823,11 +1927,22 @@ ClientManager::Impl::StartAcceptor(int threadCount, int startCpuAffinity,
 
 KfsCallbackObj*
 ClientManager::Impl::CreateKfsCallbackObj(NetConnectionPtr& conn)
+{
+    return CreateKfsCallbackObj(conn, 0);
+}
+
+KfsCallbackObj*
+ClientManager::Impl::CreateKfsCallbackObj(NetConnectionPtr& conn,
+    ClientManager::ClientThread* thread)
 {
     if (mClientThreadCount < 0 || ! conn || ! conn->IsGood()) {
         return 0;
     }
+    // The client state machines are created and destroyed by the client
+    // threads with the client manager mutex held.
+    QCStMutexLocker locker(gNetDispatch.GetClientManagerMutex());
     const int connCount = ClientSM::GetClientCount();
+    locker.Unlock();
     if (GetMaxClientCount() <= connCount) {
         // The value doesn't reflect the active connection count, but rather
         // number of existing client state machines. This should be OK here, as
@@ -1844,6 +1959,10 @@ ClientManager::Impl::CreateKfsCallbackObj(NetConnectionPtr& conn)
     if (mClientThreadCount == 0) {
         return new ClientSM(conn);
     }
+    if (thread) {
+        thread->Add(conn);
+        return 0;
+    }
     int idx = mNextThreadIdx;
     if (idx >= mClientThreadCount || idx < 0) {
         idx = 0;
@@ -1855,6 +1974,31 @@ ClientManager::Impl::CreateKfsCallbackObj(NetConnectionPtr& conn)
     return 0;
 }
 
+void
+ClientManager::Impl::WriteThreadsCounters(ostream& os)
+{
+    if (! mThreadAcceptFlag) {
+        return;
+    }
+    os << "Client threads accepts= " << (mAcceptor ?
+        mAcceptor->GetAcceptCount() : int64_t(0));
+    for (int i = 0; i < mClientThreadCount; i++) {
+        int64_t acceptCount     = 0;
+        int64_t connectionCount = 0;
+        mClientThreads[i].GetCounters(acceptCount, connectionCount);
+        os << "," << acceptCount;
+    }
+    os << "\t" "Client threads connections= " <<
+        globalNetManager().GetConnectionCount();
+    for (int i = 0; i < mClientThreadCount; i++) {
+        int64_t acceptCount     = 0;
+        int64_t connectionCount = 0;
+        mClientThreads[i].GetCounters(acceptCount, connectionCount);
+        os << "," << connectionCount;
+    }
+    os << "\t";
+}
+
 void
 ClientManager::Impl::Shutdown()
 {
@@ -1913,9 +2057,22 @@ ClientManager::~ClientManager()
 bool
 ClientManager::Bind(
     const ServerLocation& location,
-    bool                  ipV6OnlyFlag)
+    bool                  ipV6OnlyFlag,
+    bool                  threadAcceptFlag)
+{
+    return mImpl.Bind(location, ipV6OnlyFlag, threadAcceptFlag);
+}
+
+void
+ClientManager::WriteThreadsCounters(ostream& os)
+{
+    mImpl.WriteThreadsCounters(os);
+}
+
+void
+NetDispatch::WriteClientThreadsCounters(ostream& os)
 {
-    return mImpl.Bind(location, ipV6OnlyFlag);
+    mClientManager.WriteThreadsCounters(os);
 }
 
 
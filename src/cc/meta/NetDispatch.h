@@ -65,6 +65,7 @@ public:
     int SetParameters(const Properties& props);
     void GetStatsCsv(ostream& os);
     void GetStatsCsv(IOBuffer& buf);
+    void WriteClientThreadsCounters(ostream& os);
     int64_t GetUserCpuMicroSec() const;
     int64_t GetSystemCpuMicroSec() const;
     QCMutex* GetMutex() const { return mMutex; }
@@ -127,6 +128,7 @@ private:
     bool               mRunningFlag;
     int                mClientThreadCount;
     int                mClientThreadsStartCpuAffinity;
+    bool               mClientThreadAcceptFlag;
 private:
     NetDispatch(const NetDispatch&);
     NetDispatch& operator=(const NetDispatch&);
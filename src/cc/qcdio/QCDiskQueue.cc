@@ -92,12 +92,14 @@ public:
           mIoStartObserverPtr(0),
           mRequestProcessorsPtr(0),
           mNextThreadIdx(0),
+          mMaxWriteCoalesceBlockCount(0),
+          mWriteCoalesceCounters(),
           mCreateExclusiveFlag(true),
           mRunFlag(false),
           mRequestAffinityFlag(false),
           mSerializeMetaRequestsFlag(true),
           mBarrierFlag(false)
-        {}
+        { mWriteCoalesceCounters.Clear(); }
     virtual ~Queue()
         { Queue::Stop(); }
     inline void Done(
@@ -156,6 +158,18 @@ public:
         outReadBlockCount   = mPendingReadBlockCount;
         outWriteBlockCount  = mPendingWriteBlockCount;
     }
+    void SetMaxWriteCoalesceBlockCount(
+        int inBlockCount)
+    {
+        QCStMutexLocker theLocker(mMutex);
+        mMaxWriteCoalesceBlockCount = Max(0, inBlockCount);
+    }
+    void GetWriteCoalesceCounters(
+        WriteCoalesceCounters& outCounters)
+    {
+        QCStMutexLocker theLocker(mMutex);
+        outCounters = mWriteCoalesceCounters;
+    }
     OpenFileStatus OpenFile(
         const char* inFileNamePtr,
         int64_t     inMaxFileSize,
@@ -237,6 +251,7 @@ public:
     }
 private:
     typedef unsigned int RequestIdx;
+    enum { kMaxCoalescedRequestCount = 64 };
     enum
     {
            kBlockBitCount       = 48,
@@ -471,6 +486,8 @@ private:
     IoStartObserver*   mIoStartObserverPtr;
     RequestProcessor** mRequestProcessorsPtr;
     int                mNextThreadIdx;
+    int                mMaxWriteCoalesceBlockCount;
+    WriteCoalesceCounters mWriteCoalesceCounters;
     bool               mCreateExclusiveFlag;
     bool               mRunFlag;
     bool               mRequestAffinityFlag;
@@ -722,6 +739,25 @@ private:
         int*          inFdPtr,
         struct iovec* inIoVecPtr,
         int           inThreadIdx);
+    int CoalesceWrites(
+        Request&  inReq,
+        int       inThreadIdx,
+        Request** outReqsPtr);
+    void WriteCoalesced(
+        Request&      inReq,
+        Request**     inReqsPtr,
+        int           inReqCount,
+        int           inFd,
+        struct iovec* inIoVecPtr,
+        Error         inError,
+        int           inSysError);
+    bool WriteV(
+        int           inFd,
+        struct iovec* inIoVecPtr,
+        int&          ioIoVecCnt,
+        int64_t&      ioIoByteCnt,
+        Error&        outError,
+        int&          outSysError);
     void ProcessOpenOrCreate(
         Request& inReq,
         int      inThreadIdx);
@@ -1460,6 +1496,9 @@ QCDiskQueue::Queue::Process(
     if (mRequestProcessorsPtr && 0 < theAllocSize) {
         mFileInfoPtr[inReq.mFileIdx].mSpaceAllocPendingFlag = false;
     }
+    Request*  theCoalescedReqsPtr[kMaxCoalescedRequestCount];
+    const int theCoalescedCount = mRequestProcessorsPtr ? 0 :
+        CoalesceWrites(inReq, inThreadIdx, theCoalescedReqsPtr);
     const RequestId theReqId = GetRequestId(inReq);
     QCStMutexUnlocker theUnlock(mMutex);
 
@@ -1536,6 +1575,11 @@ QCDiskQueue::Queue::Process(
             theError = kErrorOutOfBuffers;
         }
     }
+    if (0 < theCoalescedCount) {
+        WriteCoalesced(inReq, theCoalescedReqsPtr, theCoalescedCount,
+            theFd, inIoVecPtr, theError, theSysError);
+        return;
+    }
     if (theError == kErrorNone &&
             lseek(theFd, theOffset, SEEK_SET) != theOffset) {
         theError    = kErrorSeek;
@@ -1601,6 +1645,167 @@ QCDiskQueue::Queue::Process(
     RequestComplete(inReq, theError, theSysError, theIoByteCnt, theGetBufFlag);
 }
 
+    int
+QCDiskQueue::Queue::CoalesceWrites(
+    Request&  inReq,
+    int       inThreadIdx,
+    Request** outReqsPtr)
+{
+    QCASSERT(mMutex.IsOwned());
+    if (! IsWriteReqType(inReq.mReqType)) {
+        return 0;
+    }
+    mWriteCoalesceCounters.mWriteCount++;
+    mWriteCoalesceCounters.mWriteBlockCount += inReq.mBufferCount;
+    mWriteCoalesceCounters.mIssuedWriteCount++;
+    // Sync must be the last request in the sequence.
+    if (inReq.mReqType != kReqTypeWrite ||
+            mMaxWriteCoalesceBlockCount <= inReq.mBufferCount) {
+        return 0;
+    }
+    const FileInfo& theInfo = mFileInfoPtr[inReq.mFileIdx];
+    if (theInfo.mOpenPendingFlag || theInfo.mOpenError != kOpenErrorNone) {
+        return 0;
+    }
+    // Only consider the requests at the head of the queue, in order to
+    // preserve the order of requests issued by the same or other threads.
+    const int theQueueIdx  = kIoQueueIdx +
+        (mRequestAffinityFlag ? inThreadIdx : 0);
+    int       theBlockCnt  = inReq.mBufferCount;
+    uint64_t  theNextIdx   = inReq.mBlockIdx + inReq.mBufferCount;
+    int       theCount     = 0;
+    Request*  theReqPtr;
+    while (theCount < kMaxCoalescedRequestCount &&
+            (theReqPtr = Front(theQueueIdx)) &&
+            IsWriteReqType(theReqPtr->mReqType) &&
+            theReqPtr->mFileIdx == inReq.mFileIdx &&
+            theReqPtr->mBlockIdx == theNextIdx &&
+            0 < theReqPtr->mBufferCount &&
+            theNextIdx + theReqPtr->mBufferCount <=
+                uint64_t(theInfo.mLastBlockIdx) &&
+            theBlockCnt + theReqPtr->mBufferCount <=
+                mMaxWriteCoalesceBlockCount &&
+            GetBuffersPtr(*theReqPtr)[0]) {
+        RemoveWithSubRequests(*theReqPtr);
+        theReqPtr->mInFlightFlag = true;
+        outReqsPtr[theCount++] = theReqPtr;
+        theBlockCnt += theReqPtr->mBufferCount;
+        theNextIdx  += theReqPtr->mBufferCount;
+        mWriteCoalesceCounters.mWriteCount++;
+        mWriteCoalesceCounters.mWriteBlockCount     += theReqPtr->mBufferCount;
+        mWriteCoalesceCounters.mCoalescedCount++;
+        mWriteCoalesceCounters.mCoalescedBlockCount += theReqPtr->mBufferCount;
+        if (theReqPtr->mReqType == kReqTypeWriteSync) {
+            break;
+        }
+    }
+    return theCount;
+}
+
+    bool
+QCDiskQueue::Queue::WriteV(
+    int           inFd,
+    struct iovec* inIoVecPtr,
+    int&          ioIoVecCnt,
+    int64_t&      ioIoByteCnt,
+    Error&        outError,
+    int&          outSysError)
+{
+    if (ioIoVecCnt <= 0) {
+        return true;
+    }
+    const ssize_t theIoBytes = (ssize_t)ioIoVecCnt * mBlockSize;
+    const ssize_t theNWr     = writev(inFd, inIoVecPtr, ioIoVecCnt);
+    ioIoVecCnt = 0;
+    if (theNWr > 0) {
+        ioIoByteCnt += theNWr;
+    }
+    if (theNWr != theIoBytes) {
+        outError    = kErrorWrite;
+        outSysError = errno;
+        return false;
+    }
+    return true;
+}
+
+    void
+QCDiskQueue::Queue::WriteCoalesced(
+    Request&      inReq,
+    Request**     inReqsPtr,
+    int           inReqCount,
+    int           inFd,
+    struct iovec* inIoVecPtr,
+    Error         inError,
+    int           inSysError)
+{
+    QCASSERT(! mMutex.IsOwned() && 0 < inReqCount);
+    for (int i = 0; i < inReqCount; i++) {
+        Request& theReq = *inReqsPtr[i];
+        Trace("process: coalesced", theReq);
+        if (mIoStartObserverPtr) {
+            mIoStartObserverPtr->Notify(
+                theReq.mReqType,
+                GetRequestId(theReq),
+                theReq.mFileIdx,
+                theReq.mBlockIdx,
+                theReq.mBufferCount
+            );
+        }
+    }
+    Error         theError     = inError;
+    int           theSysError  = inSysError;
+    const off_t   theOffset    = (off_t)inReq.mBlockIdx * mBlockSize;
+    if (theError == kErrorNone &&
+            lseek(inFd, theOffset, SEEK_SET) != theOffset) {
+        theError    = kErrorSeek;
+        theSysError = errno;
+    }
+    int64_t theIoByteCnt = 0;
+    int     theIoVecCnt  = 0;
+    for (int i = -1; i < inReqCount && theError == kErrorNone; i++) {
+        Request&        theReq = i < 0 ? inReq : *inReqsPtr[i];
+        BuffersIterator theItr(*this, theReq, theReq.mBufferCount);
+        char*           thePtr;
+        while ((thePtr = theItr.Get())) {
+            inIoVecPtr[theIoVecCnt  ].iov_base = thePtr;
+            inIoVecPtr[theIoVecCnt++].iov_len  = mBlockSize;
+            if (mIoVecPerThreadCount <= theIoVecCnt && ! WriteV(
+                    inFd, inIoVecPtr, theIoVecCnt, theIoByteCnt,
+                    theError, theSysError)) {
+                break;
+            }
+        }
+    }
+    if (theError == kErrorNone) {
+        WriteV(inFd, inIoVecPtr, theIoVecCnt, theIoByteCnt,
+            theError, theSysError);
+    }
+    if (theError == kErrorNone &&
+            inReqsPtr[inReqCount - 1]->mReqType == kReqTypeWriteSync &&
+            fsync(inFd)) {
+        theError    = kErrorWrite;
+        theSysError = errno;
+    }
+    QCStMutexLocker theLocker(mMutex);
+    // Complete requests in the queue order. The requests that were written
+    // completely prior to the failure are considered successful.
+    int64_t theRem = theIoByteCnt;
+    for (int i = -1; i < inReqCount; i++) {
+        Request&      theReq   = i < 0 ? inReq : *inReqsPtr[i];
+        const int64_t theBytes = (int64_t)theReq.mBufferCount * mBlockSize;
+        const int64_t theDone  = Min(theBytes, theRem);
+        theRem -= theDone;
+        const bool theOkFlag = theDone == theBytes &&
+            (theError == kErrorNone || i + 1 < inReqCount);
+        RequestComplete(
+            theReq,
+            theOkFlag ? kErrorNone  : theError,
+            theOkFlag ? 0           : theSysError,
+            theDone
+        );
+    }
+}
+
     void
 QCDiskQueue::Queue::ProcessOpenOrCreate(
     Request& inReq,
@@ -2558,6 +2763,26 @@ QCDiskQueue::CancelOrSetCompletionIfInFlight(
         inRequestId, inCompletionIfInFlightPtr) : 0);
 }
 
+    void
+QCDiskQueue::SetMaxWriteCoalesceBlockCount(
+    int inBlockCount)
+{
+    if (mQueuePtr) {
+        mQueuePtr->SetMaxWriteCoalesceBlockCount(inBlockCount);
+    }
+}
+
+    void
+QCDiskQueue::GetWriteCoalesceCounters(
+    QCDiskQueue::WriteCoalesceCounters& outCounters)
+{
+    if (mQueuePtr) {
+        mQueuePtr->GetWriteCoalesceCounters(outCounters);
+    } else {
+        outCounters.Clear();
+    }
+}
+
     void
 QCDiskQueue::GetPendingCount(
     int&     outFreeRequestCount,
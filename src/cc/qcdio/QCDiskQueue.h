@@ -428,6 +428,33 @@ public:
         int64_t& outReadBlockCount,
         int64_t& outWriteBlockCount);
 
+    // Write coalescing: contiguous write requests to the same file at the
+    // head of the io queue are issued with a single lseek / writev sequence,
+    // up to the max block count. The requests complete individually, in the
+    // order they were queued. 0 turns coalescing off.
+    void SetMaxWriteCoalesceBlockCount(
+        int inBlockCount);
+
+    struct WriteCoalesceCounters
+    {
+        int64_t mWriteCount;          // Write requests processed.
+        int64_t mWriteBlockCount;     // Blocks written by all requests.
+        int64_t mIssuedWriteCount;    // Write io "sequences" issued.
+        int64_t mCoalescedCount;      // Requests merged into preceding one.
+        int64_t mCoalescedBlockCount; // Blocks in merged requests.
+
+        void Clear()
+        {
+            mWriteCount          = 0;
+            mWriteBlockCount     = 0;
+            mIssuedWriteCount    = 0;
+            mCoalescedCount      = 0;
+            mCoalescedBlockCount = 0;
+        }
+    };
+    void GetWriteCoalesceCounters(
+        WriteCoalesceCounters& outCounters);
+
     OpenFileStatus OpenFile(
         const char* inFileNamePtr,
         int64_t     inMaxFileSize           = -1,
@@ -38,6 +38,7 @@
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 
 #ifndef QC_OS_NAME_LINUX
 #   include <map>
@@ -48,18 +49,36 @@
 
 using std::min;
 
+static inline long long
+MonotonicMicroSec()
+{
+    struct timespec theTs;
+    if (clock_gettime(CLOCK_MONOTONIC, &theTs)) {
+        QCUtils::FatalError("clock_gettime", errno);
+    }
+    return ((long long)theTs.tv_sec * 1000 * 1000 + theTs.tv_nsec / 1000);
+}
+
 class QCFdPollImplBase
 {
 public:
     class Waker;
+    typedef QCFdPoll::Counters Counters;
+
     QCFdPollImplBase(
         Waker* inWakerPtr)
-        : mWakerPtr(inWakerPtr)
-        {}
+        : mCounters(),
+          mBusyPollUsec(0),
+          mLastPollEventsFlag(false),
+          mWakerPtr(inWakerPtr)
+        { mCounters.Clear(); }
     ~QCFdPollImplBase()
         {}
     Waker* GetWakerPtr() const
         { return mWakerPtr; }
+    Counters mCounters;
+    int      mBusyPollUsec;
+    bool     mLastPollEventsFlag;
 private:
     Waker* const mWakerPtr;
 };
@@ -252,6 +271,7 @@ private:
             entry[n].revents = 0;
             nWr += sizeof(entry[0]);
         }
+        mCounters.mCtlCount++;
         return (
             write(mDevpollFd, entry, nWr) == nWr ? 0 :
             (errno != 0 ? errno : -1)
@@ -304,6 +324,7 @@ private:
 
 #include <stdlib.h>
 #include <sys/epoll.h>
+#include <vector>
 
 class QCFdPoll::Impl : public QCFdPollImplBase
 {
@@ -317,7 +338,11 @@ public:
           mEpollEventCount(0),
           mMaxEventCount(0),
           mNextEventIdx(0),
-          mEventsPtr(0)
+          mEventsPtr(0),
+          mFdStates(),
+          mPendingCtl(),
+          mCtlErrors(),
+          mNextCtlErrorIdx(0)
     {
         if (mEpollFd < 0 && errno != 0 && (mEpollFd = -errno) > 0) {
             mEpollFd = -mEpollFd;
@@ -344,21 +369,70 @@ public:
         mNextEventIdx    = 0;
         delete [] mEventsPtr;
         mEventsPtr = 0;
+        FdStates().swap(mFdStates);
+        FdList().swap(mPendingCtl);
+        FdList().swap(mCtlErrors);
+        mNextCtlErrorIdx = 0;
         return theRet;
     }
     int Add(
         Fd    inFd,
         int   inOpType,
         void* inUserDataPtr)
-        { return Ctl(EPOLL_CTL_ADD, inFd, inOpType, inUserDataPtr); }
+    {
+        const int theRet = Ctl(EPOLL_CTL_ADD, inFd, inOpType, inUserDataPtr);
+        if (theRet == 0) {
+            if (mFdStates.size() <= (size_t)inFd) {
+                mFdStates.resize((size_t)inFd + 1);
+            }
+            FdState& theState = mFdStates[inFd];
+            theState.mUserDataPtr       = inUserDataPtr;
+            theState.mKernelUserDataPtr = inUserDataPtr;
+            theState.mOpType            = inOpType;
+            theState.mKernelOpType      = inOpType;
+            theState.mAddedFlag         = true;
+            theState.mPendingFlag       = false;
+        }
+        return theRet;
+    }
     int Set(
         Fd    inFd,
         int   inOpType,
         void* inUserDataPtr)
-        { return Ctl(EPOLL_CTL_MOD, inFd, inOpType, inUserDataPtr); }
+    {
+        if (inFd < 0) {
+            return EBADF;
+        }
+        if (mEpollFd < 0) {
+            return EFAULT;
+        }
+        if (mFdStates.size() <= (size_t)inFd || ! mFdStates[inFd].mAddedFlag) {
+            return ENOENT;
+        }
+        FdState& theState = mFdStates[inFd];
+        theState.mOpType      = inOpType;
+        theState.mUserDataPtr = inUserDataPtr;
+        if (theState.mPendingFlag) {
+            // Supersedes the prior change.
+            mCounters.mCtlCoalescedCount++;
+        } else if (theState.IsChanged()) {
+            theState.mPendingFlag = true;
+            mPendingCtl.push_back(inFd);
+        } else {
+            mCounters.mCtlCoalescedCount++;
+        }
+        return 0;
+    }
     int Remove(
         Fd inFd)
-        { return Ctl(EPOLL_CTL_DEL, inFd, 0, 0); }
+    {
+        if (0 <= inFd && (size_t)inFd < mFdStates.size()) {
+            FdState& theState = mFdStates[inFd];
+            theState.mAddedFlag   = false;
+            theState.mPendingFlag = false;
+        }
+        return Ctl(EPOLL_CTL_DEL, inFd, 0, 0);
+    }
     int Poll(
         int inMaxEventCountHint,
         int inWaitMilliSec)
@@ -367,6 +441,7 @@ public:
         if (mEpollFd < 0) {
             return mEpollFd;
         }
+        ApplyPendingCtl();
         const int theEventCount =
             inMaxEventCountHint > 1 ? inMaxEventCountHint : 1;
         if (! mEventsPtr || theEventCount > mMaxEventCount) {
@@ -375,33 +450,107 @@ public:
             mEventsPtr = new struct epoll_event[theAllocCount];
             mMaxEventCount = theAllocCount;
         }
-        mEpollEventCount = epoll_wait(
-            mEpollFd, mEventsPtr, theEventCount, inWaitMilliSec);
+        const int theErrCount = (int)mCtlErrors.size();
+        mEpollEventCount = epoll_wait(mEpollFd, mEventsPtr, theEventCount,
+            theErrCount <= 0 ? inWaitMilliSec : 0);
         mNextEventIdx = 0;
         QCASSERT(mEpollEventCount <= theEventCount);
-        return (mEpollEventCount >= 0 ? mEpollEventCount :
-            (errno > 0 ? -errno : (errno == 0 ? mEpollEventCount : errno)));
+        if (mEpollEventCount < 0) {
+            const int theErr = errno;
+            mEpollEventCount = 0;
+            if (theErrCount <= 0) {
+                return (theErr > 0 ? -theErr : (theErr == 0 ? -1 : theErr));
+            }
+        }
+        return (mEpollEventCount + theErrCount);
     }
     bool Next(
         int&   outOpType,
         void*& outUserDataPtr)
     {
-        if (mNextEventIdx >= mEpollEventCount) {
-            return false;
+        if (mNextEventIdx < mEpollEventCount) {
+            QCASSERT(mEventsPtr);
+            outOpType      = FdPollMask(mEventsPtr[mNextEventIdx].events);
+            outUserDataPtr = mEventsPtr[mNextEventIdx].data.ptr;
+            mNextEventIdx++;
+            return true;
+        }
+        // Report deferred interest change failures.
+        while (mNextCtlErrorIdx < mCtlErrors.size()) {
+            const Fd theFd = mCtlErrors[mNextCtlErrorIdx++];
+            if ((size_t)theFd < mFdStates.size() &&
+                    mFdStates[theFd].mAddedFlag) {
+                outOpType      = kOpTypeError;
+                outUserDataPtr = mFdStates[theFd].mUserDataPtr;
+                return true;
+            }
         }
-        QCASSERT(mEventsPtr);
-        outOpType      = FdPollMask(mEventsPtr[mNextEventIdx].events);
-        outUserDataPtr = mEventsPtr[mNextEventIdx].data.ptr;
-        mNextEventIdx++;
-        return true;
+        mCtlErrors.clear();
+        mNextCtlErrorIdx = 0;
+        return false;
     }
 
 private:
+    class FdState
+    {
+    public:
+        FdState()
+            : mUserDataPtr(0),
+              mKernelUserDataPtr(0),
+              mOpType(0),
+              mKernelOpType(0),
+              mAddedFlag(false),
+              mPendingFlag(false)
+            {}
+        bool IsChanged() const
+        {
+            return (mOpType != mKernelOpType ||
+                mUserDataPtr != mKernelUserDataPtr);
+        }
+        void* mUserDataPtr;
+        void* mKernelUserDataPtr;
+        int   mOpType;
+        int   mKernelOpType;
+        bool  mAddedFlag;
+        bool  mPendingFlag;
+    };
+    typedef std::vector<FdState> FdStates;
+    typedef std::vector<Fd>      FdList;
+
     int                 mEpollFd;
     int                 mEpollEventCount;
     int                 mMaxEventCount;
     int                 mNextEventIdx;
     struct epoll_event* mEventsPtr;
+    FdStates            mFdStates;
+    FdList              mPendingCtl;
+    FdList              mCtlErrors;
+    size_t              mNextCtlErrorIdx;
+
+    void ApplyPendingCtl()
+    {
+        for (FdList::const_iterator theIt = mPendingCtl.begin();
+                theIt != mPendingCtl.end();
+                ++theIt) {
+            FdState& theState = mFdStates[*theIt];
+            if (! theState.mPendingFlag) {
+                continue; // Removed.
+            }
+            theState.mPendingFlag = false;
+            if (! theState.IsChanged()) {
+                mCounters.mCtlCoalescedCount++;
+                continue;
+            }
+            if (Ctl(EPOLL_CTL_MOD, *theIt, theState.mOpType,
+                    theState.mUserDataPtr) == 0) {
+                theState.mKernelOpType      = theState.mOpType;
+                theState.mKernelUserDataPtr = theState.mUserDataPtr;
+            } else {
+                mCtlErrors.push_back(*theIt);
+            }
+        }
+        mPendingCtl.clear();
+    }
 
     int EPollEventMask(
         int inOpType)
@@ -455,6 +604,7 @@ private:
         struct epoll_event theEpollEvent = {0};
         theEpollEvent.data.ptr = inUserDataPtr;
         theEpollEvent.events   = EPollEventMask(inOpType);
+        mCounters.mCtlCount++;
         if (! epoll_ctl(mEpollFd, inEpollOp, inFd, &theEpollEvent)) {
             return 0;
         }
@@ -908,10 +1058,33 @@ QCFdPoll::Poll(
     int inWaitMilliSec)
 {
     Impl::Waker* const theWakerPtr = mImpl.GetWakerPtr();
-    const int theRet = mImpl.Poll(
+    const int theMaxEventCountHint =
         (theWakerPtr && 0 <= inMaxEventCountHint) ?
-            inMaxEventCountHint + 1 : inMaxEventCountHint,
-        (! theWakerPtr || theWakerPtr->Sleep()) ? inWaitMilliSec : 0);
+        inMaxEventCountHint + 1 : inMaxEventCountHint;
+    const int theWaitMilliSec =
+        (! theWakerPtr || theWakerPtr->Sleep()) ? inWaitMilliSec : 0;
+    int theRet = 0;
+    if (theWaitMilliSec != 0 && 0 < mImpl.mBusyPollUsec &&
+            mImpl.mLastPollEventsFlag) {
+        // Spin only while there is activity, then fall back to blocking poll.
+        const long long theEnd = MonotonicMicroSec() + mImpl.mBusyPollUsec;
+        do {
+            mImpl.mCounters.mPollCount++;
+            mImpl.mCounters.mBusyPollCount++;
+            theRet = mImpl.Poll(theMaxEventCountHint, 0);
+        } while (theRet == 0 && MonotonicMicroSec() < theEnd);
+        if (theRet != 0) {
+            mImpl.mCounters.mBusyPollHitCount++;
+        }
+    }
+    if (theRet == 0) {
+        mImpl.mCounters.mPollCount++;
+        theRet = mImpl.Poll(theMaxEventCountHint, theWaitMilliSec);
+    }
+    mImpl.mLastPollEventsFlag = 0 < theRet;
+    if (0 < theRet) {
+        mImpl.mCounters.mPollEventCount += theRet;
+    }
     if (theWakerPtr) {
         theWakerPtr->Wake();
     }
@@ -948,6 +1121,26 @@ QCFdPoll::Wakeup()
     return true;
 }
 
+    void
+QCFdPoll::SetBusyPoll(
+    int inSpinMicroSec)
+{
+    mImpl.mBusyPollUsec = inSpinMicroSec < 0 ? 0 : inSpinMicroSec;
+}
+
+    int
+QCFdPoll::GetBusyPoll() const
+{
+    return mImpl.mBusyPollUsec;
+}
+
+    void
+QCFdPoll::GetCounters(
+    QCFdPoll::Counters& outCounters) const
+{
+    outCounters = mImpl.mCounters;
+}
+
     int
 QCFdPoll::Close()
 {
@@ -44,6 +44,27 @@ public:
         kOpTypeHup   = 0x10
     };
     typedef int Fd;
+    struct Counters
+    {
+        typedef long long Counter;
+
+        Counter mPollCount;
+        Counter mPollEventCount;
+        Counter mCtlCount;
+        Counter mCtlCoalescedCount;
+        Counter mBusyPollCount;
+        Counter mBusyPollHitCount;
+
+        void Clear()
+        {
+            mPollCount         = 0;
+            mPollEventCount    = 0;
+            mCtlCount          = 0;
+            mCtlCoalescedCount = 0;
+            mBusyPollCount     = 0;
+            mBusyPollHitCount  = 0;
+        }
+    };
     QCFdPoll(
         bool inWakeableFlag);
     ~QCFdPoll();
@@ -51,6 +72,9 @@ public:
         Fd    inFd,
         int   inOpType,
         void* inUserDataPtr = 0);
+    // With epoll the interest changes are batched: Set() only records the
+    // change, and the next Poll() applies the net change, if any. The error,
+    // if any, is reported by Next() as kOpTypeError event.
     int Set(
         Fd    inFd,
         int   inOpType,
@@ -77,6 +101,14 @@ public:
         void*& outUserDataPtr);
     int Close();
     bool Wakeup();
+    // Busy poll: if the previous poll returned events, poll with no wait for
+    // up to the specified number of microseconds before blocking. Reduces
+    // wake up latency at the cost of cpu, 0 or negative value turns it off.
+    void SetBusyPoll(
+        int inSpinMicroSec);
+    int GetBusyPoll() const;
+    void GetCounters(
+        Counters& outCounters) const;
 private:
     class Impl;
     Impl& mImpl;
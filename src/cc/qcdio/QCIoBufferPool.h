@@ -131,6 +131,9 @@ public:
     int GetBufferSize() const
         { return mBufferSize; }
     int GetFreeBufferCount();
+    // Lockless, possibly stale, free count. Intended for heuristics only.
+    int GetFreeBufferCountNoLock() const
+        { return mFreeCnt; }
     int GetTotalBufferCount();
     int GetUsedBufferCount();
     bool IsValid(
@@ -148,12 +151,12 @@ public:
         bool           inFlag);
 private:
     class Partition;
-    QCMutex    mMutex;
-    Client*    mClientListPtr[1];
-    Partition* mPartitionListPtr[1];
-    int        mBufferSize;
-    int        mFreeCnt;
-    int        mTotalCnt;
+    QCMutex      mMutex;
+    Client*      mClientListPtr[1];
+    Partition*   mPartitionListPtr[1];
+    int          mBufferSize;
+    volatile int mFreeCnt;
+    int          mTotalCnt;
 
     bool TryToRefill(
         RefillReqId inReqId,
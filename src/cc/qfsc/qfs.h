@@ -276,6 +276,81 @@ extern "C" {
   // file position.
   ssize_t qfs_pwrite(struct QFS* qfs, int fd, const void *buf, size_t len, off_t offset);
 
+  // qfs_read_range describes single range of qfs_preadv.
+  struct qfs_read_range {
+    void*   buf;
+    size_t  len;
+    off_t   offset;
+    ssize_t status; // Output: bytes read, or negative error code.
+  };
+
+  // qfs_preadv reads all ranges concurrently, and returns when all reads
+  // complete. Ranges within the same chunk that are close to each other are
+  // coalesced into a single chunk server read. Returns 0 on success, or the
+  // first range error code.
+  int qfs_preadv(struct QFS* qfs, int fd, struct qfs_read_range* ranges,
+    int nranges);
+
+  // Asynchronous I/O
+  //
+  // qfs_aio_queue is the opaque completion queue handle. The requests are
+  // submitted in batches with qfs_aio_submit, and the completions are
+  // retrieved with qfs_aio_wait. Read requests are executed concurrently in
+  // the background, the buffer must not be accessed until the corresponding
+  // completion is retrieved. Closing fd cancels the reads in flight, which
+  // then complete with an error status.
+  // Asynchronous write is not supported, QFS_AIO_WRITE requests are rejected
+  // with -EINVAL. qfs_pwrite with the write behind already returns once the
+  // data is copied into the write behind buffer.
+  // With qfs_set_skipholes a read request does not cross chunk boundary: the
+  // read completes with fewer bytes than requested at the chunk end, and the
+  // remainder has to be submitted as a new request.
+  struct qfs_aio_queue;
+
+  enum qfs_aio_op {
+    QFS_AIO_READ  = 1,
+    QFS_AIO_WRITE = 2  // Not supported, reserved.
+  };
+
+  struct qfs_aio_req {
+    enum qfs_aio_op op;
+    int             fd;
+    void*           buf;
+    size_t          len;
+    off_t           offset;
+    void*           user_data;
+  };
+
+  struct qfs_aio_completion {
+    int     fd;
+    ssize_t status;    // Bytes transferred, or negative error code.
+    void*   user_data; // qfs_aio_req::user_data
+  };
+
+  // qfs_aio_queue_create creates asynchronous I/O completion queue. Returns
+  // NULL on failure.
+  struct qfs_aio_queue* qfs_aio_queue_create(struct QFS* qfs);
+
+  // qfs_aio_queue_release waits for all requests in flight to complete, and
+  // releases the queue. The queue must be released before qfs_release.
+  void qfs_aio_queue_release(struct QFS* qfs, struct qfs_aio_queue* queue);
+
+  // qfs_aio_submit submits up to nreqs requests, and returns the number of
+  // requests submitted. Submission stops at the first request that fails
+  // parameter validation; if the first request fails its negative error code
+  // is returned. No completion is queued for the requests not submitted.
+  int qfs_aio_submit(struct QFS* qfs, struct qfs_aio_queue* queue,
+    const struct qfs_aio_req* reqs, int nreqs);
+
+  // qfs_aio_wait waits for at least min_nr, but no more than the number of
+  // requests in flight, completions for up to timeout_ms milliseconds,
+  // negative timeout_ms means wait indefinitely. Returns the number of
+  // completions, up to max_nr, stored into completions, or negative error
+  // code.
+  int qfs_aio_wait(struct QFS* qfs, struct qfs_aio_queue* queue,
+    struct qfs_aio_completion* completions, int min_nr, int max_nr,
+    int timeout_ms);
+
   // qfs_set_skipholes instructs the client to skip holes when reading fd.
   void qfs_set_skipholes(struct QFS* qfs, int fd);
 
@@ -24,6 +24,7 @@
 
 #include "libclient/KfsClient.h"
 #include "qfs.h"
+#include "common/kfsatomic.h"
 
 #include <vector>
 #include <algorithm>
@@ -42,6 +43,14 @@ struct QFS {
   KFS::KfsClient client;
 };
 
+// The completion buffer is reused by qfs_aio_wait, unless another thread is
+// already waiting on the same queue.
+struct qfs_aio_queue {
+  KfsClient::AsyncIoQueue*             queue;
+  vector<KfsClient::AsyncIoCompletion> completions;
+  volatile int                         waiters;
+};
+
 static void qfs_attr_from_KfsFileAttr(struct qfs_attr* dst, KfsFileAttr& src);
 static int qfs_get_data_locations_inner_impl(struct QFS* qfs,
   void* path_or_fd, off_t offset, size_t len,
@@ -381,6 +390,98 @@ ssize_t qfs_pwrite(struct QFS* qfs, int fd, const void* buf, size_t len, off_t o
   return qfs->client.PWrite(fd, offset, (char*) buf, len);
 }
 
+int qfs_preadv(struct QFS* qfs, int fd, struct qfs_read_range* ranges,
+    int nranges) {
+  if(nranges <= 0) {
+    return 0;
+  }
+  if(!ranges) {
+    return -EINVAL;
+  }
+  vector<KfsClient::ReadRange> kfs_ranges(nranges);
+  for(int i = 0; i < nranges; i++) {
+    kfs_ranges[i].offset = ranges[i].offset;
+    kfs_ranges[i].size   = ranges[i].len;
+    kfs_ranges[i].buf    = (char*) ranges[i].buf;
+    kfs_ranges[i].status = 0;
+    kfs_ranges[i].completionUsec = 0;
+  }
+  const int res = qfs->client.PReadV(fd, &kfs_ranges[0], nranges);
+  for(int i = 0; i < nranges; i++) {
+    ranges[i].status = kfs_ranges[i].status;
+  }
+  return res;
+}
+
+struct qfs_aio_queue* qfs_aio_queue_create(struct QFS* qfs) {
+  KfsClient::AsyncIoQueue* const q = qfs->client.CreateAsyncIoQueue();
+  if(!q) {
+    return NULL;
+  }
+  struct qfs_aio_queue* const queue = new qfs_aio_queue;
+  queue->queue   = q;
+  queue->waiters = 0;
+  return queue;
+}
+
+void qfs_aio_queue_release(struct QFS* qfs, struct qfs_aio_queue* queue) {
+  if(!queue) {
+    return;
+  }
+  qfs->client.DisposeAsyncIoQueue(queue->queue);
+  delete queue;
+}
+
+int qfs_aio_submit(struct QFS* qfs, struct qfs_aio_queue* queue,
+    const struct qfs_aio_req* reqs, int nreqs) {
+  if(!queue || !reqs || nreqs < 0) {
+    return -EINVAL;
+  }
+  KfsClient::AsyncIoQueue* const q = queue->queue;
+  int i;
+  for(i = 0; i < nreqs; i++) {
+    const struct qfs_aio_req& req = reqs[i];
+    int res;
+    switch(req.op) {
+      case QFS_AIO_READ:
+        res = qfs->client.AsyncPRead(q, req.fd, req.offset,
+          (char*) req.buf, req.len, req.user_data);
+        break;
+      default:
+        res = -EINVAL;
+        break;
+    }
+    if(res < 0) {
+      return (i == 0 ? res : i);
+    }
+  }
+  return i;
+}
+
+int qfs_aio_wait(struct QFS* qfs, struct qfs_aio_queue* queue,
+    struct qfs_aio_completion* completions, int min_nr, int max_nr,
+    int timeout_ms) {
+  if(!queue || !completions || max_nr <= 0) {
+    return -EINVAL;
+  }
+  vector<KfsClient::AsyncIoCompletion>  tmp;
+  const bool                            own =
+    SyncAddAndFetch(queue->waiters, 1) == 1;
+  vector<KfsClient::AsyncIoCompletion>& res = own ? queue->completions : tmp;
+  if(res.size() < (size_t)max_nr) {
+    res.resize(max_nr);
+  }
+  const int n = qfs->client.GetAsyncIoCompletions(
+    queue->queue, &res[0], max_nr, min_nr, timeout_ms);
+  for(int i = 0; i < n; i++) {
+    completions[i].fd        = res[i].fd;
+    completions[i].status    = res[i].status;
+    completions[i].user_data = res[i].userData;
+  }
+  SyncAddAndFetch(queue->waiters, -1);
+  return n;
+}
+
 void qfs_set_skipholes(struct QFS* qfs, int fd) {
   qfs->client.SkipHolesInFile(fd);
 }
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <fcntl.h>
+#include <errno.h>
 
 #include "qfs.h"
 
@@ -325,6 +326,130 @@ static char* test_qfs_pread() {
   return 0;
 }
 
+static double elapsed_sec(const struct timeval* start) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return (now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) * 1e-6;
+}
+
+// Read the two chunks written by test_large_write with qfs_pread and with
+// the asynchronous I/O queue, verify the data, and report the throughput.
+static char* test_qfs_aio() {
+  const ssize_t chunksize = qfs_get_chunksize(qfs, "/unit-test/file");
+  const size_t  blksize   = 1 << 20;
+  const int     nreqs     = (int)(2 * chunksize / blksize);
+  char*         data      = malloc(2 * chunksize);
+  ssize_t       i;
+  int           n;
+  int           k;
+  off_t         res;
+  struct timeval start;
+  double        t;
+
+  check(data, "allocation should succeed");
+  check(0 < nreqs, "invalid chunk size: %jd", (intmax_t)chunksize);
+
+  gettimeofday(&start, NULL);
+  for(n = 0; n < nreqs; n++) {
+    check_qfs_call(res = qfs_pread(qfs, fd, data + n * blksize, blksize,
+      n * blksize));
+    check(res == blksize, "short read: %jd", (intmax_t)res);
+  }
+  t = elapsed_sec(&start);
+  printf("pread: %d x %zu bytes %.3f sec %.2f MB/sec\n",
+    nreqs, blksize, t, t > 0 ? 2. * chunksize / t / (1 << 20) : 0.);
+
+  struct qfs_aio_queue* queue = qfs_aio_queue_create(qfs);
+  check(queue, "aio queue should be non null");
+  struct qfs_aio_req* reqs = malloc(nreqs * sizeof(*reqs));
+  struct qfs_aio_completion* completions =
+    malloc(nreqs * sizeof(*completions));
+  check(reqs && completions, "allocation should succeed");
+
+  reqs[0].op        = QFS_AIO_WRITE;
+  reqs[0].fd        = fd;
+  reqs[0].buf       = data;
+  reqs[0].len       = blksize;
+  reqs[0].offset    = 0;
+  reqs[0].user_data = reqs;
+  check(qfs_aio_submit(qfs, queue, reqs, 1) == -EINVAL,
+    "aio write should be rejected");
+
+  memset(data, 0, 2 * chunksize);
+  for(n = 0; n < nreqs; n++) {
+    reqs[n].op        = QFS_AIO_READ;
+    reqs[n].fd        = fd;
+    reqs[n].buf       = data + n * blksize;
+    reqs[n].len       = blksize;
+    reqs[n].offset    = n * blksize;
+    reqs[n].user_data = reqs + n;
+  }
+  gettimeofday(&start, NULL);
+  check_qfs_call(k = qfs_aio_submit(qfs, queue, reqs, nreqs));
+  check(k == nreqs, "all requests should be submitted: %d != %d", k, nreqs);
+  for(k = 0; k < nreqs; ) {
+    check_qfs_call(n = qfs_aio_wait(qfs, queue, completions + k, 1,
+      nreqs - k, -1));
+    for(; 0 < n; n--, k++) {
+      check(completions[k].status == (ssize_t)blksize,
+        "completion status: %jd", (intmax_t)completions[k].status);
+      check(completions[k].fd == fd, "completion fd: %d", completions[k].fd);
+      check(reqs <= (struct qfs_aio_req*)completions[k].user_data &&
+        (struct qfs_aio_req*)completions[k].user_data < reqs + nreqs,
+        "invalid completion user data");
+    }
+  }
+  t = elapsed_sec(&start);
+  printf("aio:   %d x %zu bytes %.3f sec %.2f MB/sec\n",
+    nreqs, blksize, t, t > 0 ? 2. * chunksize / t / (1 << 20) : 0.);
+  check(qfs_aio_wait(qfs, queue, completions, 1, nreqs, 0) == 0,
+    "no completions should remain");
+  qfs_aio_queue_release(qfs, queue);
+
+  // See test_large_write for the expected content.
+  for(i = 0; i < 2 * chunksize; i++) {
+    const char v = (char)i ^ (char)(i < chunksize ? 0 : 0xA);
+    check(data[i] == v, "data mismatch at: %jd", (intmax_t)i);
+  }
+  free(completions);
+  free(reqs);
+  free(data);
+
+  return 0;
+}
+
+// Read scattered small ranges, some close enough to be coalesced, and some
+// spanning the chunk boundary.
+static char* test_qfs_preadv() {
+  const ssize_t chunksize = qfs_get_chunksize(qfs, "/unit-test/file");
+  struct qfs_read_range ranges[64];
+  char   buf[64][512];
+  const int n = sizeof(ranges) / sizeof(ranges[0]);
+  int    i;
+  int    k;
+
+  for(i = 0; i < n; i++) {
+    // Reverse order, to make sure that the ranges are sorted.
+    const int j = n - 1 - i;
+    ranges[i].buf    = buf[i];
+    ranges[i].len    = sizeof(buf[i]);
+    ranges[i].offset = (j % 2 == 0 ? j * 1000 : chunksize - 3000 + j * 100);
+    ranges[i].status = -1;
+  }
+  check_qfs_call(qfs_preadv(qfs, fd, ranges, n));
+  for(i = 0; i < n; i++) {
+    check(ranges[i].status == (ssize_t)sizeof(buf[i]),
+      "range %d status: %jd", i, (intmax_t)ranges[i].status);
+    for(k = 0; k < (int)sizeof(buf[i]); k++) {
+      const off_t pos = ranges[i].offset + k;
+      const char  v   = (char)pos ^ (char)(pos < chunksize ? 0 : 0xA);
+      check(buf[i][k] == v, "data mismatch at: %jd", (intmax_t)pos);
+    }
+  }
+
+  return 0;
+}
+
 static char* test_qfs_get_data_locations() {
   check_qfs_call(qfs_close(qfs, fd)); // shut it down
   struct qfs_iter* iter = NULL;
@@ -390,6 +515,8 @@ static char * all_tests() {
   run(test_qfs_close);
   run(test_qfs_open);
   run(test_qfs_pread);
+  run(test_qfs_aio);
+  run(test_qfs_preadv);
   run(test_qfs_get_data_locations);
   run(test_qfs_cleanup);
   run(test_qfs_release);
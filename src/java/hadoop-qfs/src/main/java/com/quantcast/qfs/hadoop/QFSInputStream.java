@@ -90,6 +90,20 @@ class QFSInputStream extends FSInputStream {
     return res;
   }
 
+  // Positional read that does not move the stream position, and bypasses
+  // the channel's read buffer. The default FSInputStream implementation
+  // seeks back and forth, discarding the read buffer each time. Hadoop's
+  // default vectored read implementation also uses this method.
+  public int read(long position, byte[] buffer, int offset, int length)
+    throws IOException {
+    final int res = kfsChannel.read(
+      ByteBuffer.wrap(buffer, offset, length), position);
+    if (res > 0 && statistics != null) {
+      statistics.incrementBytesRead(res);
+    }
+    return res;
+  }
+
   public synchronized void close() throws IOException {
     kfsChannel.close();
   }
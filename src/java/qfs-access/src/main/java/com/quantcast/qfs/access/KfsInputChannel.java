@@ -42,10 +42,18 @@ final public class KfsInputChannel implements ReadableByteChannel, Positionable
     private int kfsFd = -1;
     private KfsAccess kfsAccess;
     private boolean isReadAheadOff = false;
+    private long lastReadLatencyUsec = 0;
 
     private final static native
     int read(long cPtr, int fd, ByteBuffer buf, int begin, int end);
 
+    private final static native
+    int pread(long cPtr, int fd, ByteBuffer buf, int begin, int end, long pos);
+
+    private final static native
+    int readVectored(long cPtr, int fd, ByteBuffer[] bufs, int[] begins,
+        int[] ends, long[] positions, int[] results, long[] latencies);
+
     KfsInputChannel(KfsAccess ka, int fd) 
     {
         readBuffer = BufferPool.getInstance().getBuffer();
@@ -133,6 +141,111 @@ final public class KfsInputChannel implements ReadableByteChannel, Positionable
         buf.position(pos + sz);
     }
 
+    // Positional read: reads up to dst.remaining() bytes at the specified file
+    // offset, and does not change the channel position. Direct buffers are
+    // filled in place by the client library, without intermediate copy.
+    // Returns the number of bytes read, or -1 at the end of file.
+    // The read is synchronous: the calling thread is blocked until the read
+    // completes. There is no asynchronous, completion based, Java read API;
+    // concurrency within a single call is available with readVectored().
+    public synchronized int read(ByteBuffer dst, long position)
+        throws IOException
+    {
+        if (kfsFd < 0) {
+            throw new IOException("File closed");
+        }
+        if (position < 0) {
+            throw new IllegalArgumentException(
+                "read(" + kfsFd + "," + position + ")");
+        }
+        final int r0 = dst.remaining();
+        if (r0 <= 0) {
+            return 0;
+        }
+        final long start = System.nanoTime();
+        if (dst.isDirect()) {
+            final int pos = dst.position();
+            final int sz  = pread(kfsAccess.getCPtr(), kfsFd, dst,
+                pos, dst.limit(), position);
+            kfsAccess.kfs_retToIOException(sz);
+            dst.position(pos + sz);
+        } else {
+            final ByteBuffer buf = BufferPool.getInstance().getBuffer();
+            try {
+                long off = position;
+                while (dst.hasRemaining()) {
+                    buf.clear();
+                    final int sz = pread(kfsAccess.getCPtr(), kfsFd, buf, 0,
+                        Math.min(buf.capacity(), dst.remaining()), off);
+                    kfsAccess.kfs_retToIOException(sz);
+                    if (sz <= 0) {
+                        break;
+                    }
+                    buf.limit(sz);
+                    dst.put(buf);
+                    off += sz;
+                }
+            } finally {
+                BufferPool.getInstance().releaseBuffer(buf);
+            }
+        }
+        lastReadLatencyUsec = (System.nanoTime() - start) / 1000;
+        final int r1 = dst.remaining();
+        return r1 < r0 ? r0 - r1 : -1;
+    }
+
+    // Vectored read: reads all ranges concurrently, each dsts[i] is filled up
+    // to its remaining() bytes with the data at positions[i]. Nearby ranges
+    // within the same chunk are coalesced into a single chunk server read.
+    // The call is synchronous: it returns when all reads complete, i.e. the
+    // calling thread is blocked for the duration of the slowest read.
+    // The buffers must be direct, and are filled in place. The buffer
+    // positions are advanced by the number of bytes read, which is also
+    // returned in the corresponding element of the result array, 0 means end
+    // of file. If latencyUsec is not null, the time from the call start to
+    // each range read completion in microseconds is stored into the
+    // corresponding element. The coalesced ranges have the same completion
+    // time.
+    public synchronized int[] readVectored(long[] positions, ByteBuffer[] dsts,
+        long[] latencyUsec) throws IOException
+    {
+        if (kfsFd < 0) {
+            throw new IOException("File closed");
+        }
+        final int cnt = dsts.length;
+        if (positions.length != cnt ||
+                (latencyUsec != null && latencyUsec.length != cnt)) {
+            throw new IllegalArgumentException("readVectored: " +
+                "array length mismatch");
+        }
+        final int[] begins  = new int[cnt];
+        final int[] ends    = new int[cnt];
+        final int[] results = new int[cnt];
+        for (int i = 0; i < cnt; i++) {
+            if (!dsts[i].isDirect()) {
+                throw new IllegalArgumentException("need direct buffer");
+            }
+            begins[i] = dsts[i].position();
+            ends[i]   = dsts[i].limit();
+        }
+        final long start = System.nanoTime();
+        kfsAccess.kfs_retToIOException(readVectored(kfsAccess.getCPtr(),
+            kfsFd, dsts, begins, ends, positions, results, latencyUsec));
+        lastReadLatencyUsec = (System.nanoTime() - start) / 1000;
+        for (int i = 0; i < cnt; i++) {
+            kfsAccess.kfs_retToIOException(results[i]);
+            dsts[i].position(begins[i] + results[i]);
+        }
+        return results;
+    }
+
+    // Returns duration in microseconds of the last positional or vectored
+    // read call.
+    public synchronized long getLastReadLatencyUsec()
+    {
+        return lastReadLatencyUsec;
+    }
+
     // is modeled after the seek of Java's RandomAccessFile; offset is
     // the offset from the beginning of the file.
     public synchronized long seek(long offset) throws IOException